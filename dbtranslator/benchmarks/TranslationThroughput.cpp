@@ -0,0 +1,203 @@
+// Measures how many guest instructions per second the LLVM tier translates.
+// A synthetic RV32I stream is split into blocks like the dispatcher splits
+// guest code, and every block goes through the same steps as a real
+// translation; decode, IR build, optimization and code generation are timed
+// separately.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include <argparse/argparse.hpp>
+
+#include "CPU.h"
+#include "Instruction.h"
+#include "Memory.h"
+#include "Translator.h"
+
+using namespace llvm;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t CodeBase = 0x10000;
+
+uint32_t rType(uint32_t Funct7, uint32_t Rs2, uint32_t Rs1, uint32_t Funct3, uint32_t Rd) {
+  return Funct7 << 25 | Rs2 << 20 | Rs1 << 15 | Funct3 << 12 | Rd << 7 | 0x33;
+}
+
+uint32_t iType(uint32_t Opcode, uint32_t Imm, uint32_t Rs1, uint32_t Funct3, uint32_t Rd) {
+  return (Imm & 0xFFF) << 20 | Rs1 << 15 | Funct3 << 12 | Rd << 7 | Opcode;
+}
+
+uint32_t sType(uint32_t Imm, uint32_t Rs2, uint32_t Rs1, uint32_t Funct3) {
+  return ((Imm >> 5) & 0x7F) << 25 | Rs2 << 20 | Rs1 << 15 | Funct3 << 12 | (Imm & 0x1F) << 7 | 0x23;
+}
+
+uint32_t bType(uint32_t Offset, uint32_t Rs2, uint32_t Rs1, uint32_t Funct3) {
+  return ((Offset >> 12) & 1) << 31 | ((Offset >> 5) & 0x3F) << 25 | Rs2 << 20 | Rs1 << 15 | Funct3 << 12 |
+         ((Offset >> 1) & 0xF) << 8 | ((Offset >> 11) & 1) << 7 | 0x63;
+}
+
+// Roughly the mix of compiled integer code: mostly ALU, a quarter memory
+// accesses and a branch every BranchEvery instructions on average.
+std::vector<uint32_t> generateStream(size_t NumInstrs, unsigned BranchEvery, unsigned Seed) {
+  std::mt19937 Rng(Seed);
+  auto Reg = [&] { return Rng() % 32; };
+  static constexpr uint32_t RFuncts[][2] = {{0x00, 0}, {0x20, 0}, {0x00, 1}, {0x00, 2}, {0x00, 3},
+                                            {0x00, 4}, {0x00, 5}, {0x20, 5}, {0x00, 6}, {0x00, 7}};
+  static constexpr uint32_t IFuncts[] = {0, 2, 3, 4, 6, 7};
+  static constexpr uint32_t LoadFuncts[] = {0, 1, 2, 4, 5};
+  static constexpr uint32_t BranchFuncts[] = {0, 1, 4, 5, 6, 7};
+
+  std::vector<uint32_t> Stream;
+  Stream.reserve(NumInstrs);
+  for (size_t I = 0; I < NumInstrs; ++I) {
+    if (Rng() % BranchEvery == 0) {
+      Stream.push_back(bType(8 + 4 * (Rng() % 32), Reg(), Reg(), BranchFuncts[Rng() % 6]));
+      continue;
+    }
+    switch (Rng() % 8) {
+      case 0:
+      case 1:
+      case 2: {
+        auto const* F = RFuncts[Rng() % 10];
+        Stream.push_back(rType(F[0], Reg(), Reg(), F[1], Reg()));
+        break;
+      }
+      case 3:
+      case 4:
+        Stream.push_back(iType(0x13, Rng(), Reg(), IFuncts[Rng() % 6], Reg()));
+        break;
+      case 5:
+        Stream.push_back(iType(0x03, Rng(), Reg(), LoadFuncts[Rng() % 5], Reg()));
+        break;
+      case 6:
+        Stream.push_back(sType(Rng(), Reg(), Reg(), Rng() % 3));
+        break;
+      default:
+        Stream.push_back((Rng() & 0xFFFFF000) | Reg() << 7 | (Rng() % 2 ? 0x37 : 0x17));
+        break;
+    }
+  }
+  return Stream;
+}
+
+struct Phase {
+  char const* Name;
+  Clock::duration Time{};
+};
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  argparse::ArgumentParser program("translation-throughput");
+  program.add_argument("--instructions").default_value(1 << 18).help("number of synthetic guest instructions").metavar("value").scan<'i', int>();
+  program.add_argument("--threshold").default_value(64).help("maximum instructions per block").metavar("value").scan<'i', int>();
+  program.add_argument("--branch-every").default_value(8).help("average distance between branches").metavar("value").scan<'i', int>();
+  program.add_argument("--seed").default_value(1).help("random seed of the instruction stream").metavar("value").scan<'i', int>();
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return EXIT_FAILURE;
+  }
+
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+
+  auto JTMB = orc::JITTargetMachineBuilder::detectHost();
+  if (!JTMB) {
+    logAllUnhandledErrors(JTMB.takeError(), errs());
+    return EXIT_FAILURE;
+  }
+  auto TM = JTMB->createTargetMachine();
+  if (!TM) {
+    logAllUnhandledErrors(TM.takeError(), errs());
+    return EXIT_FAILURE;
+  }
+
+  size_t NumInstrs = program.get<int>("--instructions");
+  std::vector<uint32_t> Stream = generateStream(NumInstrs, std::max(program.get<int>("--branch-every"), 1), program.get<int>("--seed"));
+  riscv::SegmentManager Segment{reinterpret_cast<uint8_t*>(Stream.data()), static_cast<uint32_t>(Stream.size() * 4), CodeBase};
+  riscv::MemoryManager Manager{&Segment, 1};
+  size_t Threshold = program.get<int>("--threshold");
+
+  Phase Decode{"decode"}, Build{"IR build"}, Optimize{"optimize"}, Codegen{"codegen"};
+
+  auto Start = Clock::now();
+  uint32_t Checksum = 0;
+  for (uint32_t Word : Stream)
+    Checksum += static_cast<uint32_t>(riscv::decode(Word));
+  Decode.Time = Clock::now() - Start;
+
+  size_t NumBlocks = 0;
+  uint64_t ObjectBytes = 0;
+  uint32_t End = CodeBase + Stream.size() * 4;
+  for (uint32_t PC = CodeBase; PC < End; ++NumBlocks) {
+    LLVMContext Ctx;
+    Module M("Module " + std::to_string(PC), Ctx);
+    M.setDataLayout((*TM)->createDataLayout());
+    M.setTargetTriple((*TM)->getTargetTriple().str());
+
+    Start = Clock::now();
+    auto *FnTy = FunctionType::get(Type::getVoidTy(Ctx), {riscv::getCPUStatePointerType(Ctx)}, false);
+    auto *F = Function::Create(FnTy, Function::ExternalLinkage, "block_" + std::to_string(PC), &M);
+    IRBuilder<> B{Ctx};
+    B.SetInsertPoint(BasicBlock::Create(Ctx, "entry", F));
+    riscv::IRData IRData_{M, B, F};
+    riscv::addMemoryInterface(IRData_);
+    size_t BlockSize = riscv::emitBlock(IRData_, &Manager, PC, std::min<size_t>(Threshold, (End - PC) / 4));
+    B.CreateRetVoid();
+    Build.Time += Clock::now() - Start;
+
+    Start = Clock::now();
+    riscv::optimizeModule(M);
+    Optimize.Time += Clock::now() - Start;
+
+    Start = Clock::now();
+    SmallVector<char, 0> Object;
+    raw_svector_ostream OS(Object);
+    legacy::PassManager PM;
+    if ((*TM)->addPassesToEmitFile(PM, OS, nullptr, CodeGenFileType::ObjectFile)) {
+      errs() << "target cannot emit object files\n";
+      return EXIT_FAILURE;
+    }
+    PM.run(M);
+    Codegen.Time += Clock::now() - Start;
+    ObjectBytes += Object.size();
+
+    PC += BlockSize * 4;
+  }
+
+  outs() << NumInstrs << " guest instructions in " << NumBlocks << " blocks, " << ObjectBytes
+         << " bytes of host code (decode checksum " << Checksum << ")\n";
+  auto Report = [&](char const* Name, Clock::duration Time) {
+    double Seconds = std::chrono::duration<double>(Time).count();
+    outs() << format("  %-10s %10.3f ms %14.0f instr/s\n", Name, Seconds * 1e3, NumInstrs / Seconds);
+  };
+  Clock::duration Total{};
+  for (Phase const* P : {&Decode, &Build, &Optimize, &Codegen}) {
+    Report(P->Name, P->Time);
+    Total += P->Time;
+  }
+  Report("total", Total);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,7 @@
+# Usage: cmake -DINPUT=<file> -DOUTPUT=<file.inc> -P EmbedFile.cmake
+# Writes the bytes of INPUT as a comma-separated list for an array
+# initializer.
+file(READ ${INPUT} CONTENTS HEX)
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," CONTENTS "${CONTENTS}")
+string(REGEX REPLACE "(0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,0x..,)" "\\1\n" CONTENTS "${CONTENTS}")
+file(WRITE ${OUTPUT} "${CONTENTS}\n")
@@ -0,0 +1,44 @@
+#ifndef DBTRANSLATOR_AOT_H
+#define DBTRANSLATOR_AOT_H
+
+#include "CPU.h"
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+
+namespace riscv {
+
+// Symbols defined by objects from dbtranslator-aot. The runtime adds such an
+// object to its JIT, checks the ELF hash and the code generation options,
+// and seeds the dispatcher with the block table; guest code missing from the
+// table is translated on demand.
+inline constexpr char const* AotBlocksSymbol = "dbt_aot_blocks";
+inline constexpr char const* AotNumBlocksSymbol = "dbt_aot_num_blocks";
+inline constexpr char const* AotElfHashSymbol = "dbt_aot_elf_hash";
+// Null-terminated kind prefix (see Engine) of the options the object was
+// compiled with.
+inline constexpr char const* AotKindPrefixSymbol = "dbt_aot_kind_prefix";
+
+// Layout of one dbt_aot_blocks element.
+struct AotBlock {
+  uint32_t PC;
+  uint32_t NumInstrs;
+  BlockFunc Code;
+};
+
+using FileHash = std::array<uint8_t, 20>;
+
+// SHA-1 of the file at Path, identifying the guest binary.
+llvm::Expected<FileHash> hashFile(llvm::StringRef Path);
+
+// Start of the kind prefix for the options that change the code generated
+// for the same guest bytes, apart from the host C library routines.
+llvm::Expected<std::string> optionsPrefix(bool Coverage, bool InlineMemory,
+                                          std::optional<std::string> const& MemoryImpl);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_AOT_H
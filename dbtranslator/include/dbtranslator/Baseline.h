@@ -0,0 +1,39 @@
+#ifndef DBTRANSLATOR_BASELINE_H
+#define DBTRANSLATOR_BASELINE_H
+
+#include "CPU.h"
+#include "Memory.h"
+#include <cstddef>
+#include <cstdint>
+#include <llvm/Support/Memory.h>
+
+namespace riscv {
+
+// First translation tier. Instead of building LLVM IR, a block is produced
+// by copying the precompiled stencil of each instruction into executable
+// memory and patching its holes (register indices, immediate, guest PC,
+// memory helpers and the address of the next stencil).
+class BaselineCompiler {
+public:
+  explicit BaselineCompiler(size_t CodeSize = 64 << 20);
+  ~BaselineCompiler();
+
+  BaselineCompiler(BaselineCompiler const&) = delete;
+  BaselineCompiler& operator=(BaselineCompiler const&) = delete;
+
+  // Translates the block starting at PC, split with the same rules as the
+  // LLVM tier. Returns nullptr once the code buffer is exhausted and for
+  // blocks with instructions that have no stencils (see needsLLVM). The number
+  // of guest instructions covered is stored to NumInstrsOut if given.
+  BlockFunc compile(uint32_t PC, MemoryManager* Manager, size_t Threshold, size_t* NumInstrsOut = nullptr);
+
+  size_t codeSize() const { return Used; }
+
+private:
+  llvm::sys::MemoryBlock Block;
+  size_t Used = 0;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_BASELINE_H
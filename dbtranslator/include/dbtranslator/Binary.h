@@ -2,11 +2,42 @@
 #define DBTRANSLATOR_BINARY_H
 
 #include "Memory.h"
+#include <string>
+#include <vector>
 
 namespace riscv {
 
+struct CodeRegion {
+  uint32_t Begin;
+  uint32_t End;
+};
+
+struct FunctionSymbol {
+  std::string Name;
+  uint32_t Address;
+  uint32_t Size;
+};
+
+// Static view of the guest code: where execution starts, which loaded
+// segments are executable or read-only and which addresses the symbol table
+// marks as functions. Used to find translation roots without running the
+// guest.
+struct ElfCodeInfo {
+  uint32_t EntryPoint;
+  std::vector<CodeRegion> ExecutableRegions;
+  // Loaded segments without write permission, whose contents stay as
+  // loaded.
+  std::vector<CodeRegion> ReadOnlyRegions;
+  std::vector<uint32_t> FunctionSymbols;
+  // The same functions with their names and sizes.
+  std::vector<FunctionSymbol> NamedFunctions;
+};
 
 std::pair<MemoryManager*, uint32_t> parseElf(char const* FileName, bool Debug);
+// Frees the memory returned by parseElf.
+void freeElf(MemoryManager* Manager);
+
+ElfCodeInfo parseElfCode(char const* FileName);
 
 } // end namespace riscv
 
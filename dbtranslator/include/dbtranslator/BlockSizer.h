@@ -0,0 +1,62 @@
+#ifndef DBTRANSLATOR_BLOCKSIZER_H
+#define DBTRANSLATOR_BLOCKSIZER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace riscv {
+
+enum class Tier {
+  Baseline = 0,
+  Optimized,
+};
+
+// Chooses how many guest instructions a translation may cover. Cold code
+// gets short blocks that are cheap to translate; a block that was cut by the
+// limit is allowed to grow as it gets hotter, as long as the measured
+// compile cost per instruction stays within a per-execution budget.
+class BlockSizer {
+public:
+  struct Options {
+    size_t MinInstrs = 8;
+    size_t MaxInstrs = 512;
+    // Nanoseconds of compile time we are willing to spend per observed
+    // execution of the block being resized.
+    uint64_t BudgetPerExecNs = 200;
+  };
+
+  explicit BlockSizer(Options Opts);
+
+  // Guest addresses in [Begin, End) always use Limit, regardless of hotness.
+  void addOverride(uint32_t Begin, uint32_t End, size_t Limit);
+
+  size_t limitFor(uint32_t PC, uint64_t ExecCount, Tier T) const;
+  void recordCompile(uint32_t PC, size_t NumInstrs, std::chrono::nanoseconds Cost, Tier T);
+
+  void printReport(llvm::raw_ostream& OS) const;
+
+private:
+  struct Override {
+    uint32_t End;
+    size_t Limit;
+  };
+  struct TierCost {
+    uint64_t Nanoseconds = 0;
+    uint64_t Instrs = 0;
+  };
+
+  Options Opts;
+  std::map<uint32_t, Override> Overrides;
+  TierCost Costs[2];
+  // Latest size chosen for each block start, for the report.
+  std::map<uint32_t, size_t> ChosenSizes;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_BLOCKSIZER_H
@@ -11,12 +11,44 @@ namespace riscv {
 llvm::Type* getCPUStateType(llvm::LLVMContext& Ctx);
 llvm::Type* getCPUStatePointerType(llvm::LLVMContext& Ctx);
 
+// VLEN / 8 of the vector unit: one AVX2 register, two SSE ones.
+inline constexpr uint32_t VectorBytes = 32;
+
+// vtype with only vill set, for a configuration the vector unit does not
+// support.
+inline constexpr uint32_t VTypeIllegal = 0x80000000;
+
 struct CPUState {
   uint32_t Registers[32];
   uint32_t PC;
   MemoryManager* Manager;
+  // V extension state. VType is what vsetvli stored: a supported
+  // configuration (SEW of 8, 16 or 32, LMUL of 1) or VTypeIllegal with VL 0.
+  uint32_t VL;
+  uint32_t VType;
+  uint8_t VectorRegisters[32][VectorBytes];
+  // F and D registers. Single-precision values are NaN-boxed: the upper 32
+  // bits are all ones. FCSR holds frm and the fflags accrued up to the last
+  // synchronization with the host (see FloatEnv.h).
+  uint64_t FloatRegisters[32];
+  uint32_t FCSR;
+  // mhartid: 0 for the only or first hart of a guest.
+  uint32_t HartId;
+  // LR.W reservation: the word and the value it loaded. SC.W succeeds if
+  // the word still holds that value (see Atomic.cpp).
+  uint32_t ReservationValid;
+  uint32_t ReservationAddress;
+  uint32_t ReservationValue;
+  // Region code adds the instructions of every block it runs to
+  // RegionInstrs, which the dispatcher zeroes before each call, and leaves
+  // at the next back-edge once RegionBudget is reached.
+  uint32_t RegionInstrs;
+  uint32_t RegionBudget;
 };
 
+// Entry point of translated guest code, in every tier.
+using BlockFunc = void (*)(CPUState*);
+
 void dump(CPUState* State);
 
 } // end namespace riscv
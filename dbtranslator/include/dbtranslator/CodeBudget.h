@@ -0,0 +1,73 @@
+#ifndef DBTRANSLATOR_CODEBUDGET_H
+#define DBTRANSLATOR_CODEBUDGET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ExecutionEngine/Orc/Core.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace riscv {
+
+// A resident translation the dispatcher is willing to give up.
+struct EvictionCandidate {
+  uint32_t PC;
+  uint64_t ExecCount;
+  // Dispatch count at the translation's last execution.
+  uint64_t LastUse;
+  size_t Bytes;
+};
+
+// Keeps the host memory of JIT translations under a budget. Every evictable
+// translation is added under its own ResourceTracker; a JITLink plugin
+// records how many bytes each tracker's code and data take, and evict()
+// removes a tracker's code and symbols from the JIT.
+class CodeBudget {
+public:
+  // Fails if the JIT does not link with JITLink, which the size accounting
+  // relies on. The linker keeps a reference to the budget, so it is shared.
+  static llvm::Expected<std::shared_ptr<CodeBudget>> create(llvm::orc::LLJIT& JIT, size_t MaxBytes);
+
+  size_t residentBytes() const { return Resident; }
+  bool overBudget() const { return Resident > MaxBytes; }
+  size_t bytesOf(llvm::orc::ResourceTracker const& Tracker) const;
+
+  // Picks victims, coldest first, until the resident size would drop to
+  // three quarters of the budget, so evictions come in batches rather than
+  // on every translation. A translation is colder the fewer times it ran
+  // and the longer ago it last ran.
+  std::vector<uint32_t> selectVictims(llvm::ArrayRef<EvictionCandidate> Candidates, uint64_t Now) const;
+
+  // Removes the tracker's code and symbols from the JIT. The caller must
+  // make sure nothing runs or jumps to that code any more.
+  llvm::Error evict(llvm::orc::ResourceTracker& Tracker);
+
+  void printStats(llvm::raw_ostream& OS) const;
+
+private:
+  class SizePlugin;
+
+  explicit CodeBudget(size_t MaxBytes) : MaxBytes(MaxBytes) {}
+  void add(llvm::orc::ResourceKey Key, size_t Bytes);
+  void remove(llvm::orc::ResourceKey Key);
+  void transfer(llvm::orc::ResourceKey Dst, llvm::orc::ResourceKey Src);
+
+  size_t MaxBytes;
+  mutable std::mutex SizesMutex;
+  llvm::DenseMap<llvm::orc::ResourceKey, size_t> Sizes;
+  std::atomic<size_t> Resident = 0;
+  std::atomic<size_t> PeakResident = 0;
+  uint64_t Evictions = 0;
+  uint64_t EvictedBytes = 0;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_CODEBUDGET_H
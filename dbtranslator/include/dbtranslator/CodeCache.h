@@ -0,0 +1,87 @@
+#ifndef DBTRANSLATOR_CODECACHE_H
+#define DBTRANSLATOR_CODECACHE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/ExecutionEngine/Orc/Core.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace riscv {
+
+struct MemoryManager;
+
+// Bumped whenever the generated code for the same guest bytes changes, so
+// stale objects from older translators are never loaded.
+inline constexpr uint32_t TranslatorVersion = 3;
+
+struct CodeRange {
+  uint32_t Begin;
+  uint32_t End;
+};
+
+// Persistent cache of compiled translations, one object file per entry in a
+// directory shared between runs. An entry is keyed by the hash of the guest
+// ELF, the translator version, the kind of translation, and the guest ranges
+// it covers together with their bytes, so code the guest rewrote never
+// reuses the object of the original.
+//
+// Translations that may be cached are built into modules named by
+// moduleName(Key) with a single function named symbolName(Key). Installed as
+// the JIT compiler's ObjectCache, the cache writes out every such module's
+// object once it is compiled.
+class CodeCache : public llvm::ObjectCache {
+public:
+  static llvm::Expected<std::unique_ptr<CodeCache>> create(llvm::StringRef Directory, llvm::StringRef ElfPath);
+
+  std::string key(llvm::StringRef Kind, llvm::ArrayRef<CodeRange> Ranges, MemoryManager* Source) const;
+  static std::string moduleName(llvm::StringRef Key);
+  static std::string symbolName(llvm::StringRef Key);
+
+  // Shares the code for Key between its users in this process. The first
+  // claim creates Tracker in JD and returns true: the caller must then load
+  // or compile the code under it. Later claims get the same tracker and only
+  // look up the symbol.
+  bool claim(llvm::StringRef Key, llvm::orc::JITDylib& JD, llvm::orc::ResourceTrackerSP& Tracker);
+  // Drops one user of Key's code. Returns true for the last one, which must
+  // then remove the tracker from the JIT; the next claim loads it again.
+  bool release(llvm::StringRef Key);
+
+  // The stored object for Key, or nullptr on a miss.
+  std::unique_ptr<llvm::MemoryBuffer> find(llvm::StringRef Key);
+
+  void notifyObjectCompiled(llvm::Module const* M, llvm::MemoryBufferRef Obj) override;
+  std::unique_ptr<llvm::MemoryBuffer> getObject(llvm::Module const* M) override;
+
+  void printStats(llvm::raw_ostream& OS) const;
+
+private:
+  CodeCache(std::string Directory, std::array<uint8_t, 20> ElfHash);
+  std::string path(llvm::StringRef Key) const;
+
+  std::string Directory;
+  std::array<uint8_t, 20> ElfHash;
+  struct Claim {
+    llvm::orc::ResourceTrackerSP Tracker;
+    size_t Users = 0;
+  };
+
+  std::mutex ClaimedMutex;
+  llvm::StringMap<Claim> Claimed;
+  std::atomic<uint64_t> Hits = 0;
+  std::atomic<uint64_t> Misses = 0;
+  std::atomic<uint64_t> Stores = 0;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_CODECACHE_H
@@ -0,0 +1,35 @@
+#ifndef DBTRANSLATOR_CODEPAGES_H
+#define DBTRANSLATOR_CODEPAGES_H
+
+#include "CodeCache.h"
+#include "Memory.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <llvm/ADT/ArrayRef.h>
+
+namespace riscv {
+
+// Which translated blocks were built from which guest pages. Keeps the
+// memory manager's CodePages bitmap in sync so that the store path can tell
+// when guest code is overwritten.
+class CodePageMap {
+public:
+  explicit CodePageMap(MemoryManager* Manager) : Manager(Manager) {}
+
+  // Records that the translation entered at EntryPC was built from Ranges.
+  void add(uint32_t EntryPC, llvm::ArrayRef<CodeRange> Ranges);
+
+  // Returns the entry PCs of the translations built from pages written
+  // since the last call and forgets those pages, whose next translation
+  // adds them again. Call when Manager->CodeWritten is set.
+  std::vector<uint32_t> takeInvalidated();
+
+private:
+  MemoryManager* Manager;
+  std::unordered_map<uint32_t, std::vector<uint32_t>> PageEntries;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_CODEPAGES_H
@@ -0,0 +1,22 @@
+#ifndef DBTRANSLATOR_COMPRESSED_H
+#define DBTRANSLATOR_COMPRESSED_H
+
+#include "Memory.h"
+#include <cstdint>
+
+namespace riscv {
+
+// Encoded size in bytes of the instruction whose first half-word is Low.
+inline uint32_t instructionLength(uint16_t Low) { return (Low & 0x3) == 0x3 ? 4 : 2; }
+
+// The 32-bit instruction a 16-bit RV32C instruction stands for, or 0 (which
+// decodes as UNKNOWN) for reserved encodings.
+uint32_t expandCompressed(uint16_t Half);
+
+// Reads the instruction at PC, expanded to its 32-bit form if it is
+// compressed. Length receives its encoded size, 2 or 4 bytes.
+uint32_t fetchInstruction(MemoryManager* Manager, uint32_t PC, uint32_t& Length);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_COMPRESSED_H
@@ -0,0 +1,37 @@
+#ifndef DBTRANSLATOR_COVERAGE_H
+#define DBTRANSLATOR_COVERAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Error.h>
+
+namespace riscv {
+
+// AFL-style edge coverage of translated code. On entry every instrumented
+// block does Map[Prev ^ Cur]++ and Prev = Cur >> 1, where Cur is
+// coverageId() of the block's guest PC.
+inline constexpr size_t CoverageMapSize = size_t(1) << 16;
+inline constexpr char const* CoverageMapSymbol = "dbt_cov_map";
+inline constexpr char const* CoveragePrevSymbol = "dbt_cov_prev";
+
+inline uint32_t coverageId(uint32_t PC) {
+  return (PC * 2654435761U) >> 16 & (CoverageMapSize - 1);
+}
+
+// Defines the coverage symbols in the JIT's main JITDylib. When running
+// under AFL (__AFL_SHM_ID is set), the map is AFL's shared memory segment.
+llvm::Error addCoverageRuntime(llvm::orc::LLJIT& JIT);
+
+uint8_t* coverageMap();
+
+// Forgets the previous block, so the first edge of a run does not depend on
+// where the last run ended.
+void resetCoveragePath();
+
+// Number of map entries hit so far.
+size_t countCoveredEdges();
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_COVERAGE_H
@@ -0,0 +1,28 @@
+#ifndef DBTRANSLATOR_DISCOVERY_H
+#define DBTRANSLATOR_DISCOVERY_H
+
+#include "Binary.h"
+#include "Memory.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace riscv {
+
+struct DiscoveredBlock {
+  uint32_t PC;
+  uint32_t NumInstrs;
+};
+
+// Recursive-descent scan starting from the entry point and every function
+// symbol. Blocks are split exactly like the dispatcher splits them (at the
+// first control transfer or after Threshold instructions), so every start
+// address returned here is a PC the dispatcher will later look up.
+// Besides direct jumps and branches, the scan follows far calls and jumps
+// whose JALR a LUI or AUIPC sets up, and every target of a jump table in a
+// read-only segment (see JumpTable.h).
+std::vector<DiscoveredBlock> discoverBlocks(MemoryManager* Manager, ElfCodeInfo const& Info, size_t Threshold);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_DISCOVERY_H
@@ -0,0 +1,330 @@
+#ifndef DBTRANSLATOR_ENGINE_H
+#define DBTRANSLATOR_ENGINE_H
+
+#include "Baseline.h"
+#include "BlockSizer.h"
+#include "CPU.h"
+#include "CodeBudget.h"
+#include "CodeCache.h"
+#include "CodePages.h"
+#include "Discovery.h"
+#include "GuestImage.h"
+#include "Harts.h"
+#include "Instruction.h"
+#include "Libc.h"
+#include "Memory.h"
+#include "Region.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace riscv {
+
+class Snapshot;
+
+// Runs RV32I guests of one ELF: owns the JIT and the translations of the
+// guest's blocks in every tier. A host embeds the translator by creating an
+// Engine, loading a guest and calling run() or step(); the registers and
+// memory can be read and written in between.
+//
+// Any number of guests can be spawned from the same engine. Each has its own
+// registers and copy-on-write memory but all share the translations, which
+// are built from the unmodified ELF image. A guest that writes to its code
+// diverges and translates its blocks privately from then on. An engine and
+// its guests are used from one thread at a time, except that run() runs the
+// harts of a guest with several on threads of their own and runAll() runs
+// many guests on a pool of threads.
+class Engine {
+public:
+  class Guest;
+
+  struct BlockSizeOverride {
+    uint32_t Begin;
+    uint32_t End;
+    size_t Limit;
+  };
+
+  struct Options {
+    // Maximum number of guest instructions per LLVM block.
+    size_t Threshold = 64;
+    bool DebugMode = false;
+    // LLVM IR file with the memory helpers; the built-in runtime otherwise.
+    // It needs readVector and writeVector only for guests using the V
+    // extension, and atomicAddress and atomicStored only for ones using the
+    // A extension.
+    std::optional<std::string> MemoryImpl;
+    // Link the memory runtime into every translation so it can be inlined.
+    bool InlineMemory = false;
+    // Translate blocks with the copy-and-patch tier first and move them to
+    // LLVM after TierUpThreshold executions. Ignored with MemoryImpl, as
+    // baseline code always calls the built-in memory helpers.
+    bool Baseline = false;
+    uint64_t TierUpThreshold = 1000;
+    // Translate every statically reachable block before the guest runs.
+    bool WarmUp = false;
+    unsigned WarmUpThreads = std::max(1U, std::thread::hardware_concurrency());
+    bool AdaptiveBlockSize = false;
+    std::vector<BlockSizeOverride> BlockSizeOverrides;
+    bool BlockSizeReport = false;
+    // Executions of a block before its hot region is recompiled (0 disables).
+    uint64_t RegionThreshold = 10000;
+    size_t RegionMaxBlocks = 64;
+    // Directory of the persistent code cache shared between runs.
+    std::optional<std::string> CodeCacheDir;
+    // Bytes of JIT code and data kept resident (0 is unlimited).
+    size_t CodeBudget = 0;
+    // AFL-style edge coverage in LLVM translations; disables the baseline
+    // tier, which has no instrumentation.
+    bool Coverage = false;
+    // Harts of every spawned guest. They share its memory and all start at
+    // the entry point, with their index in mhartid and stacks 1 MiB apart.
+    // Snapshots hold hart 0 only.
+    unsigned Harts = 1;
+    // Run the guest's memcpy, memmove, memset, memcmp and strlen, found by
+    // symbol name, as host code (see Libc.h). With LibcHashes, only the ones
+    // whose code hash is listed; DebugMode prints the hashes.
+    bool Libc = false;
+    std::vector<uint64_t> LibcHashes;
+  };
+
+  enum class StopReason {
+    // The guest returned to address 0 or called exit.
+    Exited,
+    // The guest reached a `j .` halt loop.
+    Halted,
+    // The guest reached the address given to stopAt().
+    Breakpoint,
+    // run() executed its instruction budget.
+    InstructionLimit,
+  };
+
+  // The code cache, when configured, is keyed by ElfPath, so the guest the
+  // engine will run has to be known up front.
+  static llvm::Expected<std::unique_ptr<Engine>> create(Options Opts, llvm::StringRef ElfPath);
+  ~Engine();
+
+  // Starts a new guest at the ELF's entry point. With Args, argc and argv
+  // are placed on the stack as on Linux and also passed in a0 and a1. The
+  // guest must not outlive the engine.
+  llvm::Expected<std::unique_ptr<Guest>> spawn(llvm::ArrayRef<std::string> Args = {});
+  // Starts a guest from a snapshot written by checkpoint().
+  llvm::Expected<std::unique_ptr<Guest>> resume(llvm::StringRef SnapshotPath);
+  // Saves G with the manifest of the LLVM translations it can use.
+  llvm::Error checkpoint(Guest const& G, llvm::StringRef Path) const;
+
+  // Runs blocks of G until it stops or about MaxInstructions guest
+  // instructions ran. The budget is checked between blocks and at the
+  // back-edges of regions, and a block counts as its full length even when
+  // it leaves early. The harts of a guest with several run in parallel,
+  // each with this budget, until hart 0 stops; the others stop with it and
+  // the result is hart 0's. Breakpoints apply to hart 0.
+  llvm::Expected<StopReason> run(Guest& G, uint64_t MaxInstructions = std::numeric_limits<uint64_t>::max());
+  // Runs a single translated block (or region) of G.
+  llvm::Expected<StopReason> step(Guest& G);
+  // Runs Guests to completion on Workers threads, the calling one included.
+  // Every hart is a task that runs for Quantum guest instructions, or until
+  // it executes PAUSE, and then goes back to its worker's run queue; idle
+  // workers steal from the others. Returns each guest's stop reason, hart
+  // 0's as in run().
+  llvm::Expected<std::vector<StopReason>> runAll(llvm::ArrayRef<Guest*> Guests, unsigned Workers, uint64_t Quantum);
+
+  // Adds an object written by dbtranslator-aot for the ELF.
+  llvm::Error loadAotObject(llvm::StringRef Path);
+
+  // The methods below work on the engine's default guest, for hosts that
+  // run one guest at a time. load() and restore() replace it.
+  llvm::Error load(llvm::ArrayRef<std::string> Args = {});
+  llvm::Error restore(llvm::StringRef SnapshotPath);
+  llvm::Error checkpoint(llvm::StringRef Path) const;
+  llvm::Expected<StopReason> run(uint64_t MaxInstructions = std::numeric_limits<uint64_t>::max());
+  llvm::Expected<StopReason> step();
+  void stopAt(uint32_t PC);
+  CPUState& state();
+  std::span<uint32_t, 32> registers();
+  uint32_t pc() const;
+  void setPC(uint32_t PC);
+  std::span<uint8_t> memory(uint32_t Addr, uint32_t Size);
+  void setOutput(llvm::raw_ostream* Stdout, llvm::raw_ostream* Stderr);
+
+  llvm::orc::LLJIT& jit() { return *JIT; }
+  void printStats(llvm::raw_ostream& OS) const;
+
+private:
+  // Host code of one LLVM translation, owned by Tracker so that it can be
+  // removed from the JIT again. Under a code cache, translations of the same
+  // key share Tracker and the code goes with the last of them.
+  struct Translation {
+    BlockFunc Code = nullptr;
+    llvm::orc::ResourceTrackerSP Tracker;
+    std::string CacheKey;
+  };
+
+  struct TranslatedBlock {
+    // Null once the code was evicted; the profile below is kept.
+    BlockFunc Code = nullptr;
+    // Set for LLVM translations, which can be removed from the JIT.
+    llvm::orc::ResourceTrackerSP Tracker;
+    std::string CacheKey;
+    uint64_t ExecCount = 0;
+    // Dispatch count at the last execution.
+    uint64_t LastUse = 0;
+    size_t NumInstrs = 0;
+    // Size limit the block was translated with; a block that reached it was
+    // cut and may grow when retranslated.
+    size_t Limit = 0;
+    bool Optimized = false;
+    bool Halts = false;
+    EdgeProfile Edges;
+    // Code is a region compiled from the profile, entered at this block.
+    bool IsRegion = false;
+    bool RegionRequested = false;
+  };
+
+  struct PendingRegion {
+    uint32_t Head;
+    std::future<llvm::Expected<Translation>> Code;
+  };
+
+  using BlockMap = std::unordered_map<uint32_t, TranslatedBlock>;
+
+  Engine(Options Opts, std::string ElfPath);
+
+  llvm::Error buildFunction(llvm::orc::ResourceTrackerSP Tracker, llvm::StringRef ModuleName, llvm::StringRef FuncName,
+                            llvm::function_ref<void(IRData&)> Emit);
+  llvm::Expected<Translation> lookupOrBuild(llvm::StringRef Kind, MemoryManager* Source,
+                                            llvm::ArrayRef<CodeRange> Ranges, llvm::function_ref<void(IRData&)> Emit);
+  llvm::Expected<Translation> translateOptimized(MemoryManager* Source, uint32_t PC, size_t Threshold,
+                                                 size_t* NumInstrsOut = nullptr);
+  llvm::Expected<Translation> compileRegion(std::vector<RegionBlock> Blocks, std::vector<CodeRange> Ranges);
+  llvm::Expected<TranslatedBlock> translate(MemoryManager* Source, uint32_t PC, Tier T, uint64_t ExecCount);
+  llvm::Error translateAhead(MemoryManager* Source, llvm::ArrayRef<DiscoveredBlock> Blocks, BlockMap& Map,
+                             CodePageMap* Pages);
+  llvm::Error warmUp();
+
+  llvm::Error removeCode(Translation& Code);
+  llvm::Error freeTranslation(TranslatedBlock& Block);
+  llvm::Error freeRetired();
+  llvm::Error replaceTranslation(TranslatedBlock& Block, TranslatedBlock New);
+  llvm::Error evictColdBlocks(uint32_t Current);
+  llvm::Error invalidateWrittenCode(Guest& G);
+  llvm::Error diverge(Guest& G);
+  llvm::Error installRegions(bool Wait);
+  void requestRegion(uint32_t PC, TranslatedBlock& Block);
+
+  llvm::Expected<StopReason> runHarts(Guest& G, uint64_t MaxInstructions);
+  llvm::Expected<StopReason> runHart(Guest& G, CPUState& State, JumpCache& Cache, uint64_t MaxInstructions,
+                                     std::atomic<bool> const& Stop, bool YieldOnPause = false);
+
+  // Looks up or (re)translates the block of G at PC, which ran Executions
+  // more times.
+  llvm::Expected<TranslatedBlock*> prepareBlock(Guest& G, uint32_t PC, uint64_t Executions = 1);
+  llvm::Error dropTranslations(BlockMap& Map);
+  Guest& defaultGuest() const;
+
+  Options Opts;
+  std::string ElfPath;
+  std::unique_ptr<GuestImage> Image;
+  std::unique_ptr<llvm::orc::LLJIT> JIT;
+  std::unique_ptr<CodeCache> Cache;
+  // Start of every translation kind: the options that change the code
+  // generated for the same guest bytes.
+  std::string KindPrefix;
+  std::shared_ptr<CodeBudget> Budget;
+  std::unique_ptr<BaselineCompiler> Baseline;
+  std::unique_ptr<BlockSizer> Sizer;
+  // Entry points of the C library routines run as host code.
+  std::unordered_map<uint32_t, LibcRoutine> LibcEntries;
+
+  // Translations of blocks in the ELF's executable segments, built from the
+  // image and shared by every guest that did not diverge.
+  BlockMap Translated;
+  std::vector<PendingRegion> PendingRegions;
+  bool WarmedUp = false;
+  std::unique_ptr<Guest> DefaultGuest;
+
+  // While harts run in parallel, in runHarts() or runAll(), they take
+  // HartMutex for everything but their jump cache lookups. Superseded code
+  // is kept in Retired until all of them have stopped, as another hart may
+  // still be running it, and nothing is evicted.
+  std::mutex HartMutex;
+  bool Parallel = false;
+  std::vector<Translation> Retired;
+  // Bumped when translations of written code are dropped; jump caches of
+  // an older generation are emptied.
+  std::atomic<uint64_t> CodeGeneration = 0;
+
+  uint64_t Dispatches = 0;
+  // Quanta run and tasks stolen by runAll().
+  uint64_t Quanta = 0;
+  uint64_t Steals = 0;
+  size_t LateTranslations = 0;
+  size_t Spawned = 0;
+  size_t Diverged = 0;
+};
+
+// One running instance of the engine's ELF.
+class Engine::Guest {
+public:
+  ~Guest();
+
+  // The next run() or step() that reaches PC stops before executing it.
+  // One-shot.
+  void stopAt(uint32_t PC) { Breakpoints.push_back(PC); }
+
+  CPUState& state() { return State; }
+  std::span<uint32_t, 32> registers() { return State.Registers; }
+  uint32_t pc() const { return State.PC; }
+  void setPC(uint32_t PC) { State.PC = PC; }
+  // Host view of guest memory at [Addr, Addr + Size); empty if the range is
+  // not inside one segment. Stores through it bypass code invalidation.
+  std::span<uint8_t> memory(uint32_t Addr, uint32_t Size);
+  // Where the guest's writes to stdout and stderr go during run(); null is
+  // the host's own.
+  void setOutput(llvm::raw_ostream* Stdout, llvm::raw_ostream* Stderr) {
+    GuestStdout = Stdout;
+    GuestStderr = Stderr;
+  }
+  // The guest changed its code and no longer uses the shared translations.
+  bool diverged() const { return Diverged; }
+
+private:
+  friend class Engine;
+  explicit Guest(Engine& Owner);
+
+  Engine& Owner;
+  // The state of hart 0; Harts holds the others.
+  CPUState State = {};
+  std::vector<std::unique_ptr<CPUState>> Harts;
+  // Memory instantiated from the image, or the restored snapshot.
+  std::unique_ptr<GuestMemory> Memory;
+  std::unique_ptr<Snapshot> Restored;
+  std::vector<uint32_t> Breakpoints;
+  llvm::raw_ostream* GuestStdout = nullptr;
+  llvm::raw_ostream* GuestStderr = nullptr;
+  bool Diverged = false;
+  // Translations of blocks outside the image's code, and of every block
+  // once the guest diverged. Built from the guest's own memory, so Pages
+  // tracks them for invalidation.
+  BlockMap Private;
+  std::unique_ptr<CodePageMap> Pages;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_ENGINE_H
@@ -0,0 +1,71 @@
+#ifndef DBTRANSLATOR_FLOATENV_H
+#define DBTRANSLATOR_FLOATENV_H
+
+#include "CPU.h"
+#include <cfenv>
+#include <cstdint>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Error.h>
+
+namespace riscv {
+
+// While a guest runs, the host's floating-point environment is the guest's:
+// its rounding mode is frm and its raised exception flags are the fflags
+// accrued since CPUState::FCSR was last synchronized. Translated code uses
+// native FP instructions without checking or updating either; they are
+// exchanged with FCSR only when the guest accesses fcsr and when the engine
+// leaves guest code.
+
+// Fields of fcsr.
+inline constexpr uint32_t FFlagsMask = 0x1F;
+inline constexpr uint32_t FrmShift = 5;
+inline constexpr uint32_t FrmMask = 0x7 << FrmShift;
+
+// fflags bits.
+inline constexpr uint32_t FlagInexact = 0x01;
+inline constexpr uint32_t FlagUnderflow = 0x02;
+inline constexpr uint32_t FlagOverflow = 0x04;
+inline constexpr uint32_t FlagDivByZero = 0x08;
+inline constexpr uint32_t FlagInvalid = 0x10;
+
+// Names translated code calls the helpers below by.
+inline constexpr char const* SyncFloatFlagsSymbol = "dbt_sync_fflags";
+inline constexpr char const* ApplyRoundingSymbol = "dbt_apply_frm";
+inline constexpr char const* SetRoundingSymbol = "dbt_set_rounding";
+
+// Installs State's rounding mode with no flags raised.
+void enterGuestFloat(CPUState const& State);
+// Accrues the raised flags into State's fflags and restores the host's
+// default environment.
+void leaveGuestFloat(CPUState& State);
+
+// Accrues the raised flags into fflags and clears them, before the guest
+// reads or writes fflags.
+void syncFloatFlags(CPUState* State);
+// Installs frm again, after the guest wrote it or after an instruction with
+// a static rounding mode.
+void applyRoundingMode(CPUState* State);
+// Installs the static rounding mode (a RISC-V rm) of one instruction. RMM
+// has no host equivalent and rounds to nearest, ties to even.
+void setRoundingMode(uint32_t Mode);
+
+// Runs host code, such as a translation, in the default environment while a
+// guest's is installed, and reinstalls the guest's unchanged afterwards.
+class HostFloatScope {
+public:
+  HostFloatScope();
+  ~HostFloatScope();
+
+  HostFloatScope(HostFloatScope const&) = delete;
+  HostFloatScope& operator=(HostFloatScope const&) = delete;
+
+private:
+  std::fenv_t Saved;
+};
+
+// Defines the helper symbols above in the JIT's main JITDylib.
+llvm::Error addHostFloatRuntime(llvm::orc::LLJIT& JIT);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_FLOATENV_H
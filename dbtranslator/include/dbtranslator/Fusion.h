@@ -0,0 +1,45 @@
+#ifndef DBTRANSLATOR_FUSION_H
+#define DBTRANSLATOR_FUSION_H
+
+#include "Instruction.h"
+#include <cstdint>
+#include <optional>
+
+namespace riscv {
+
+// Pairs of adjacent guest instructions that are translated as one. Both
+// instructions are full encodings as returned by fetchInstruction(), and
+// the first never ends a block.
+enum class Fusion {
+  None,
+  // LUI or AUIPC into rd, then ADDI, JALR, or a load or store based on rd:
+  // li, la, call/tail and absolute or PC-relative accesses. rd is a known
+  // constant for the second instruction, which gets a constant result,
+  // jump target or address.
+  UpperImmediate,
+  // SLT, SLTU, SLTI or SLTIU into rd, then BEQZ or BNEZ on rd: the branch
+  // tests the comparison itself.
+  CompareBranch,
+};
+
+Fusion matchFusion(Instr First, uint32_t FirstData, Instr Second, uint32_t SecondData);
+
+// Emits a pair matchFusion() accepted, First at Data.PC with length
+// Data.Length and Second at Data.nextPC() with SecondLength. Data.PC and
+// Data.Length are Second's afterwards.
+void buildFusion(IRData& Data, Fusion Kind, Instr First, uint32_t FirstData, Instr Second, uint32_t SecondData,
+                 uint32_t SecondLength);
+
+// Value a LUI or AUIPC at PC writes.
+uint32_t upperImmediate(Instr First, uint32_t FirstData, uint32_t PC);
+// Whether Second of an UpperImmediate pair overwrites the register First
+// wrote, so that First has no effect of its own.
+bool overwritesUpper(uint32_t FirstData, Instr Second, uint32_t SecondData);
+// Target of a JALR whose base a LUI or AUIPC at PC just set, for callers
+// that only look at the jump.
+std::optional<uint32_t> fusedJumpTarget(Instr First, uint32_t FirstData, uint32_t PC, Instr Second,
+                                        uint32_t SecondData);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_FUSION_H
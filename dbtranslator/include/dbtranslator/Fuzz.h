@@ -0,0 +1,67 @@
+#ifndef DBTRANSLATOR_FUZZ_H
+#define DBTRANSLATOR_FUZZ_H
+
+#include "CPU.h"
+#include "Memory.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace riscv {
+
+// Persistent-mode fuzzing. The guest runs normally until it reaches the
+// harness PC, where its registers and memory are snapshotted in memory.
+// Every input then runs from that snapshot: it is copied to the guest
+// buffer at InputAddr, a0/a1 are set to the buffer and its length, and the
+// run lasts until the guest exits. Between runs only the pages the guest
+// wrote are copied back; the store path lists them (see noteStore()).
+class FuzzSession {
+public:
+  struct Options {
+    uint32_t PC;
+    uint32_t InputAddr;
+    uint32_t MaxInputSize;
+  };
+
+  // Inputs are files or directories of files, all read up front.
+  static llvm::Expected<std::unique_ptr<FuzzSession>> create(Options Opts, llvm::ArrayRef<std::string> InputPaths);
+
+  uint32_t pc() const { return Opts.PC; }
+  bool started() const { return !SavedSegments.empty(); }
+
+  // Snapshots State, turns on dirty tracking and loads the first input.
+  llvm::Error start(CPUState& State);
+
+  // Called when a run ended: restores the snapshot into State and loads the
+  // next input. Returns false once every input has run.
+  bool next(CPUState& State);
+
+  void printStats(llvm::raw_ostream& OS) const;
+
+private:
+  explicit FuzzSession(Options Opts) : Opts(Opts) {}
+  void load(CPUState& State, llvm::MemoryBuffer const& Input);
+
+  Options Opts;
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> Inputs;
+  size_t NextInput = 0;
+
+  CPUState Saved;
+  std::vector<std::vector<uint8_t>> SavedSegments;
+  std::unique_ptr<uint8_t[]> DirtyPages;
+  std::unique_ptr<uint32_t[]> DirtyList;
+
+  uint64_t Runs = 0;
+  uint64_t RestoredPages = 0;
+  std::chrono::steady_clock::time_point Start;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_FUZZ_H
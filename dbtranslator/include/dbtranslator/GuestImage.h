@@ -0,0 +1,70 @@
+#ifndef DBTRANSLATOR_GUESTIMAGE_H
+#define DBTRANSLATOR_GUESTIMAGE_H
+
+#include "Binary.h"
+#include "Memory.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FileSystem.h>
+
+namespace riscv {
+
+class GuestImage;
+
+// Memory of one guest instance: private copy-on-write mappings of the
+// image, so an instance only costs the pages it writes.
+class GuestMemory {
+public:
+  MemoryManager* manager() { return &Manager; }
+
+private:
+  friend class GuestImage;
+  GuestMemory() = default;
+  MemoryManager Manager = {};
+  std::vector<SegmentManager> Segments;
+  std::vector<llvm::sys::fs::mapped_file_region> Mappings;
+  std::unique_ptr<uint8_t[]> WatchedPages;
+  std::unique_ptr<uint8_t[]> CodePages;
+  std::unique_ptr<uint8_t[]> WrittenCodePages;
+};
+
+// The loaded ELF before it runs. Its segments live in an in-memory file
+// that every instance maps privately. The pristine memory is never executed
+// on; translations shared between instances are built from it.
+class GuestImage {
+public:
+  static llvm::Expected<std::unique_ptr<GuestImage>> create(llvm::StringRef ElfPath);
+  ~GuestImage();
+
+  MemoryManager* memory() const { return Pristine; }
+  ElfCodeInfo const& codeInfo() const { return Info; }
+  uint32_t entryPoint() const { return Info.EntryPoint; }
+  // PC is in an executable segment.
+  bool isCode(uint32_t PC) const;
+
+  // A new instance of the image with the pages of executable segments
+  // marked as code, so that writes to them are noticed.
+  llvm::Expected<std::unique_ptr<GuestMemory>> instantiate() const;
+
+  // Marks the pages of the image's code in Manager, memory of an instance
+  // or a snapshot of the ELF, as code that was not written.
+  void markCode(MemoryManager* Manager) const;
+  // Whether Manager still holds the image's code. With OnlyWritten, only
+  // the code pages written since they were marked are compared.
+  bool sameCode(MemoryManager* Manager, bool OnlyWritten) const;
+
+private:
+  GuestImage() = default;
+  MemoryManager* Pristine = nullptr;
+  ElfCodeInfo Info;
+  int FD = -1;
+  // File offset of every segment.
+  std::vector<uint64_t> Offsets;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_GUESTIMAGE_H
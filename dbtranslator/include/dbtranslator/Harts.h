@@ -0,0 +1,55 @@
+#ifndef DBTRANSLATOR_HARTS_H
+#define DBTRANSLATOR_HARTS_H
+
+#include "CPU.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Error.h>
+
+namespace riscv {
+
+// PAUSE calls spinPause, which translated code knows by this name.
+inline constexpr char const* PauseSymbol = "dbt_pause";
+
+// The host's spin-wait hint. It also marks the calling thread as paused,
+// for schedulers that take a spinning guest off its thread.
+void spinPause();
+// Whether translated code on this thread paused since the last call.
+bool takePause();
+
+// Defines PauseSymbol in the JIT's main JITDylib.
+llvm::Error addHostHartRuntime(llvm::orc::LLJIT& JIT);
+
+// Dispatch cache of a thread running guest harts in parallel with others:
+// the code last found for a guest PC, used without taking the engine's
+// lock. A hit also counts the execution here; after ProfileBatch of them
+// the dispatcher takes the locked path again to add them to the shared
+// profile, which also picks up a retranslation of the block. Entries of
+// shared translations serve every guest still on them, so a thread can
+// switch between guests of one engine without emptying the cache.
+struct JumpCache {
+  static constexpr size_t NumEntries = 4096;
+  static constexpr uint32_t ProfileBatch = 256;
+
+  struct Entry {
+    uint32_t PC = 0;
+    uint32_t Hits = 0;
+    BlockFunc Code = nullptr;
+    size_t NumInstrs = 0;
+    // Guest of a private translation; null for shared ones.
+    void const* Owner = nullptr;
+  };
+
+  Entry& entry(uint32_t PC) { return Entries[(PC >> 1) % NumEntries]; }
+  void clear() { Entries.fill({}); }
+
+  std::array<Entry, NumEntries> Entries;
+  // The engine's code generation the entries belong to.
+  uint64_t Generation = 0;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_HARTS_H
@@ -4,6 +4,9 @@
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/IRBuilder.h"
 #include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <utility>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/GlobalVariable.h>
 
@@ -13,6 +16,9 @@ namespace constants {
 static constexpr uint64_t REG_SIZE = 32; // 32 regs in rv32i
 } // end namespace constants 
 
+struct ElfCodeInfo;
+enum class LibcRoutine : uint8_t;
+
 enum class Instr {
   UNKNOWN = 0,
   LUI,
@@ -52,6 +58,164 @@ enum class Instr {
   SRA,
   OR,
   AND,
+  // M extension.
+  MUL,
+  MULH,
+  MULHSU,
+  MULHU,
+  DIV,
+  DIVU,
+  REM,
+  REMU,
+  // Zba, Zbb and Zbs.
+  SH1ADD,
+  SH2ADD,
+  SH3ADD,
+  ANDN,
+  ORN,
+  XNOR,
+  CLZ,
+  CTZ,
+  CPOP,
+  MAX,
+  MAXU,
+  MIN,
+  MINU,
+  SEXTB,
+  SEXTH,
+  ZEXTH,
+  ROL,
+  ROR,
+  RORI,
+  ORCB,
+  REV8,
+  BCLR,
+  BCLRI,
+  BEXT,
+  BEXTI,
+  BINV,
+  BINVI,
+  BSET,
+  BSETI,
+  // V extension subset (see Vector.cpp).
+  VSETVLI,
+  VSETIVLI,
+  VSETVL,
+  VLE8,
+  VLE16,
+  VLE32,
+  VLSE8,
+  VLSE16,
+  VLSE32,
+  VSE8,
+  VSE16,
+  VSE32,
+  VSSE8,
+  VSSE16,
+  VSSE32,
+  VADDVV,
+  VADDVX,
+  VADDVI,
+  VSUBVV,
+  VSUBVX,
+  VRSUBVX,
+  VRSUBVI,
+  VMULVV,
+  VMULVX,
+  VANDVV,
+  VANDVX,
+  VANDVI,
+  VORVV,
+  VORVX,
+  VORVI,
+  VXORVV,
+  VXORVX,
+  VXORVI,
+  VMVVV,
+  VMVVX,
+  VMVVI,
+  VMVXS,
+  VMVSX,
+  VREDSUM,
+  VREDAND,
+  VREDOR,
+  VREDXOR,
+  VREDMINU,
+  VREDMIN,
+  VREDMAXU,
+  VREDMAX,
+  // F and D extensions (see Float.cpp).
+  FLW,
+  FSW,
+  FMADDS,
+  FMSUBS,
+  FNMSUBS,
+  FNMADDS,
+  FADDS,
+  FSUBS,
+  FMULS,
+  FDIVS,
+  FSQRTS,
+  FSGNJS,
+  FSGNJNS,
+  FSGNJXS,
+  FMINS,
+  FMAXS,
+  FCVTWS,
+  FCVTWUS,
+  FMVXW,
+  FEQS,
+  FLTS,
+  FLES,
+  FCLASSS,
+  FCVTSW,
+  FCVTSWU,
+  FMVWX,
+  FLD,
+  FSD,
+  FMADDD,
+  FMSUBD,
+  FNMSUBD,
+  FNMADDD,
+  FADDD,
+  FSUBD,
+  FMULD,
+  FDIVD,
+  FSQRTD,
+  FSGNJD,
+  FSGNJND,
+  FSGNJXD,
+  FMIND,
+  FMAXD,
+  FCVTSD,
+  FCVTDS,
+  FEQD,
+  FLTD,
+  FLED,
+  FCLASSD,
+  FCVTWD,
+  FCVTWUD,
+  FCVTDW,
+  FCVTDWU,
+  // Zicsr.
+  CSRRW,
+  CSRRS,
+  CSRRC,
+  CSRRWI,
+  CSRRSI,
+  CSRRCI,
+  // A extension (see Atomic.cpp).
+  LRW,
+  SCW,
+  AMOSWAPW,
+  AMOADDW,
+  AMOXORW,
+  AMOANDW,
+  AMOORW,
+  AMOMINW,
+  AMOMAXW,
+  AMOMINUW,
+  AMOMAXUW,
   FENCE,
   FENCETSO,
   PAUSE,
@@ -62,11 +226,79 @@ enum class Instr {
 char const* InstrToLiteral(Instr I);
 
 struct IRData {
+  // Must be constructed with the builder positioned in the entry block of
+  // CurrentFunction: the cached pointers below are computed there, so they
+  // dominate every guest instruction emitted afterwards.
+  IRData(llvm::Module& M, llvm::IRBuilder<>& B, llvm::Function* F);
+
   llvm::Module& Module;
   llvm::IRBuilder<>& Builder;
   llvm::Function* CurrentFunction;
-  llvm::FunctionCallee MemoryFunctions[6];
-};    
+  llvm::FunctionCallee MemoryFunctions[10];
+  llvm::FunctionCallee SyscallFunction;
+  // The helpers of FloatEnv.h: sync fflags, apply frm, set a static
+  // rounding mode.
+  llvm::FunctionCallee FloatFunctions[3];
+  llvm::FunctionCallee PauseFunction;
+  llvm::FunctionCallee LibcFunction;
+
+  llvm::StructType* CPUStateTy;
+  llvm::ArrayType* RegsArrTy;
+  llvm::Value* RegsPtr;
+  llvm::Value* PCPtr;
+  llvm::Value* MemoryManagerPtr;
+  llvm::Value* VLPtr;
+  llvm::Value* VTypePtr;
+  llvm::Value* VectorRegsPtr;
+  llvm::Value* FloatRegsPtr;
+  llvm::Value* FCSRPtr;
+  // Set by addCoverage(): every emitted block then records its edge.
+  llvm::GlobalVariable* CoverageMap = nullptr;
+  llvm::GlobalVariable* CoveragePrev = nullptr;
+
+  // Guest address and encoded length of the instruction being emitted.
+  uint32_t PC = 0;
+  uint32_t Length = 4;
+
+  uint32_t nextPC() const { return PC + Length; }
+
+  // vtype stored by a vsetvli or vsetivli earlier in the block being
+  // emitted, so that vector instructions know their element width without
+  // checking CPUState::VType. Reset at every block entry.
+  std::optional<uint32_t> VType;
+
+  // Value the first instruction of a fused pair (see Fusion.h) wrote to a
+  // register, which readReg() returns for it while the second is emitted.
+  std::optional<std::pair<uint32_t, llvm::Value*>> Forwarded;
+
+  // Segments of the guest image, set by the engine so that jump tables in
+  // read-only ones are read while translating (see JumpTable.h).
+  ElfCodeInfo const* CodeInfo = nullptr;
+  // Entry points of guest C library routines that run as host code instead
+  // (see Libc.h), when the engine replaces any.
+  std::unordered_map<uint32_t, LibcRoutine> const* Libc = nullptr;
+
+  // x0 reads as zero and writes to it are dropped.
+  llvm::Value* readReg(uint32_t Reg);
+  void writeReg(uint32_t Reg, llvm::Value* Value);
+  void writePC(llvm::Value* Value);
+
+  // Calls the read/write helper for a 1, 2 or 4 byte access. Loaded values
+  // are i8/i16/i32; stored values are truncated to the access size.
+  llvm::Value* readMemory(unsigned Bytes, llvm::Value* Address);
+  void writeMemory(unsigned Bytes, llvm::Value* Address, llvm::Value* Value);
+
+  // Address of vector register Reg in CPUState.
+  llvm::Value* vectorReg(uint32_t Reg);
+  // Calls readVector/writeVector for the elements of vector register Reg
+  // whose bit is set in the i32 Mask.
+  void readVectorMemory(uint32_t Reg, llvm::Value* Address, llvm::Value* Stride, unsigned Bytes, llvm::Value* Mask);
+  void writeVectorMemory(uint32_t Reg, llvm::Value* Address, llvm::Value* Stride, unsigned Bytes, llvm::Value* Mask);
+  // Calls atomicAddress for the host address of the word at Address, and
+  // atomicStored after an atomic write to it.
+  llvm::Value* atomicAddress(llvm::Value* Address);
+  void atomicStored(llvm::Value* Address);
+};
 
 struct Instruction {
   uint32_t InstructionData;
@@ -299,6 +531,918 @@ struct ANDInstruction : Instruction {
   void build_ir(IRData&) override;
 };
 
+struct MULInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct MULHInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct MULHSUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct MULHUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct DIVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct DIVUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct REMInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct REMUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct SH1ADDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct SH2ADDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct SH3ADDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct ANDNInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct ORNInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct XNORInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CLZInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CTZInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CPOPInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct MAXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct MAXUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct MINInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct MINUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct SEXTBInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct SEXTHInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct ZEXTHInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct ROLInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct RORInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct RORIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct ORCBInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct REV8Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct BCLRInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct BCLRIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct BEXTInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct BEXTIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct BINVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct BINVIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct BSETInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct BSETIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSETVLIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSETIVLIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSETVLInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VLE8Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VLE16Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VLE32Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VLSE8Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VLSE16Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VLSE32Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSE8Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSE16Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSE32Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSSE8Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSSE16Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSSE32Instruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VADDVVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VADDVXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VADDVIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSUBVVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VSUBVXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VRSUBVXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VRSUBVIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VMULVVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VMULVXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VANDVVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VANDVXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VANDVIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VORVVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VORVXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VORVIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VXORVVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VXORVXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VXORVIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VMVVVInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VMVVXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VMVVIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VMVXSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VMVSXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VREDSUMInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VREDANDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VREDORInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VREDXORInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VREDMINUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VREDMINInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VREDMAXUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct VREDMAXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FLWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMADDSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMSUBSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FNMSUBSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FNMADDSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FADDSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSUBSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMULSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FDIVSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSQRTSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSGNJSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSGNJNSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSGNJXSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMINSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMAXSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTWSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTWUSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMVXWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FEQSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FLTSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FLESInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCLASSSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTSWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTSWUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMVWXInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FLDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMADDDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMSUBDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FNMSUBDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FNMADDDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FADDDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSUBDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMULDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FDIVDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSQRTDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSGNJDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSGNJNDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FSGNJXDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMINDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FMAXDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTSDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTDSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FEQDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FLTDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FLEDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCLASSDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTWDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTWUDInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTDWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct FCVTDWUInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CSRRWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CSRRSInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CSRRCInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CSRRWIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CSRRSIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct CSRRCIInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct LRWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct SCWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOSWAPWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOADDWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOXORWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOANDWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOORWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOMINWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOMAXWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOMINUWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
+struct AMOMAXUWInstruction : Instruction {
+  using Instruction::Instruction;
+
+  void build_ir(IRData&) override;
+};
+
 struct FENCEInstruction : Instruction {
   using Instruction::Instruction;
 
@@ -330,6 +1474,22 @@ struct EBREAKInstruction : Instruction {
 };
 
 Instr decode(uint32_t InstructionData);
+// Sign-extended immediate of InstructionData in the encoding format of
+// InstrType (the shift amount or bit index for the shift, rotate and
+// single-bit immediate forms, simm5 for the vector .vi forms, the vtype of
+// vsetvli and vsetivli, the CSR number of the Zicsr instructions, 0 for
+// formats without one).
+uint32_t immediate(Instr InstrType, uint32_t InstructionData);
+// Register fields of InstructionData, as the R, I, S and B formats place them.
+inline uint32_t regDest(uint32_t InstructionData) { return (InstructionData >> 7) & 0x1F; }
+inline uint32_t regSrc1(uint32_t InstructionData) { return (InstructionData >> 15) & 0x1F; }
+inline uint32_t regSrc2(uint32_t InstructionData) { return (InstructionData >> 20) & 0x1F; }
+// Control transfers and ECALL, which may stop the guest, end a translated
+// block.
+bool endsBlock(Instr InstrType);
+// Instructions only the LLVM tier translates: the V, F, D and A
+// extensions, CSR accesses and fences.
+bool needsLLVM(Instr InstrType);
 void generate(Instr InstrType, uint32_t InstructionData, IRData& Data);
 
 } // end namespace riscv
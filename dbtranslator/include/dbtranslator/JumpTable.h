@@ -0,0 +1,46 @@
+#ifndef DBTRANSLATOR_JUMPTABLE_H
+#define DBTRANSLATOR_JUMPTABLE_H
+
+#include "Binary.h"
+#include "Instruction.h"
+#include "Memory.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace riscv {
+
+// A block ending in a jump through a table in a read-only segment, as
+// compilers emit for switch statements: a word is loaded from a constant
+// base plus an index, possibly offset by another constant (PIC tables hold
+// offsets), and jumped to with JALR.
+struct JumpTable {
+  // Position of the table load in the block.
+  size_t LoadIndex;
+  // Guest address of the first entry.
+  uint32_t Base;
+  // The words of the table, as far as they lead into executable code, and
+  // the jump target each one gives.
+  std::vector<uint32_t> Entries;
+  std::vector<uint32_t> Targets;
+};
+
+// Most entries read from one table.
+inline constexpr size_t MaxJumpTableEntries = 1024;
+
+// Finds the jump table of the NumInstrs-instruction block at PC, if it ends
+// in one. The idiom is tracked through LUI, AUIPC, ADDI, ADD and SH2ADD.
+// The bounds check is not needed: an address outside the table takes the
+// ordinary path.
+std::optional<JumpTable> findJumpTable(MemoryManager* Manager, ElfCodeInfo const& Info, uint32_t PC, size_t NumInstrs);
+
+// Emits the table load at Data.PC: a switch over the entry addresses that
+// yields each entry as a constant, and a memory read for any other address.
+// That read is always kept. The guest's bounds check branches in the block
+// before this one, so nothing here tells LLVM the index is in range.
+void buildTableLoad(IRData& Data, JumpTable const& Table, uint32_t InstructionData);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_JUMPTABLE_H
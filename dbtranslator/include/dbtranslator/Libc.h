@@ -0,0 +1,57 @@
+#ifndef DBTRANSLATOR_LIBC_H
+#define DBTRANSLATOR_LIBC_H
+
+#include "Binary.h"
+#include "CPU.h"
+#include "Instruction.h"
+#include "Memory.h"
+#include <cstdint>
+#include <vector>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Error.h>
+
+namespace riscv {
+
+// C library routines of the guest that can run as host code instead: the
+// guest's RV32I loops touch memory an element at a time through the memory
+// helpers, the host's work on the mapped segments directly.
+enum class LibcRoutine : uint8_t {
+  Memcpy,
+  Memmove,
+  Memset,
+  Memcmp,
+  Strlen,
+};
+
+char const* libcName(LibcRoutine Routine);
+
+// Translated code calls callLibc by this name.
+inline constexpr char const* LibcSymbol = "dbt_libc";
+
+// Runs Routine with the guest's arguments in a0-a2 and leaves its result in
+// a0, as the guest's own code would. Ranges within one segment are checked
+// once and handled by the host's routine; a range crossing segments falls
+// back to the memory helpers byte by byte.
+void callLibc(CPUState* State, uint32_t Routine);
+
+struct LibcFunction {
+  LibcRoutine Routine;
+  uint32_t Address;
+  // FNV-1a hash of the function's code, as far as its symbol's size goes.
+  uint64_t Hash;
+};
+
+// Functions of the guest whose symbol names one of the routines. Symbols
+// whose code is not mapped are skipped.
+std::vector<LibcFunction> findLibcFunctions(MemoryManager* Manager, ElfCodeInfo const& Info);
+
+// Emits a call of Routine in place of the guest block at Data.PC, the
+// routine's entry, followed by a return to ra.
+void buildLibcCall(IRData& Data, LibcRoutine Routine);
+
+// Defines LibcSymbol in the JIT's main JITDylib.
+llvm::Error addHostLibc(llvm::orc::LLJIT& JIT);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_LIBC_H
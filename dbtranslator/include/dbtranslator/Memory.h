@@ -1,7 +1,10 @@
 #ifndef DBTRANSLATOR_MEMORY_H
 #define DBTRANSLATOR_MEMORY_H
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/Type.h>
 
@@ -17,11 +20,77 @@ struct SegmentManager {
   uint32_t GuestAddress;
 };
 
+// Translated code is tracked per guest page of this size.
+inline constexpr uint32_t GuestPageShift = 12;
+inline constexpr size_t PageBitmapBytes = (size_t(1) << (32 - GuestPageShift)) / 8;
+
 struct MemoryManager {
   SegmentManager* SegmentData;
   uint32_t NumSegments;
+  // One bit per guest page whose stores take the slow path of noteStore():
+  // pages holding translated code and, while dirty tracking is on, pages
+  // not yet written since the last reset.
+  uint8_t* WatchedPages;
+  // One bit per guest page: the page holds translated code.
+  uint8_t* CodePages;
+  // One bit per code page written since the dispatcher last looked.
+  uint8_t* WrittenCodePages;
+  // Set with any bit of WrittenCodePages. Harts store it and the dispatcher
+  // exchanges it through std::atomic_ref.
+  uint32_t CodeWritten;
+  // Dirty tracking for snapshot resets, null when off. Every page written
+  // since the last reset has its bit set and is listed once in DirtyList.
+  uint8_t* DirtyPages;
+  uint32_t* DirtyList;
+  uint32_t NumDirty;
 };
 
+inline bool testPage(uint8_t const* Bitmap, uint32_t Page) {
+  return Bitmap[Page >> 3] & (1U << (Page & 7));
+}
+
+// Harts set and clear bits of the same byte concurrently, so both are
+// atomic read-modify-writes.
+inline void setPage(uint8_t* Bitmap, uint32_t Page) {
+  std::atomic_ref<uint8_t>(Bitmap[Page >> 3]).fetch_or(1U << (Page & 7), std::memory_order_relaxed);
+}
+
+inline void clearPage(uint8_t* Bitmap, uint32_t Page) {
+  std::atomic_ref<uint8_t>(Bitmap[Page >> 3]).fetch_and(~(1U << (Page & 7)), std::memory_order_relaxed);
+}
+
+// Recomputes the WatchedPages bit of Page after CodePages or DirtyPages
+// changed.
+inline void updateWatch(MemoryManager* Manager, uint32_t Page) {
+  if (testPage(Manager->CodePages, Page) || (Manager->DirtyPages && !testPage(Manager->DirtyPages, Page)))
+    setPage(Manager->WatchedPages, Page);
+  else
+    clearPage(Manager->WatchedPages, Page);
+}
+
+// A store to a watched page: a code page is recorded for the dispatcher,
+// which drops the affected translations before the next block, and a clean
+// page becomes dirty.
+inline void noteWatchedStore(MemoryManager* Manager, uint32_t Page) {
+  if (testPage(Manager->CodePages, Page)) {
+    setPage(Manager->WrittenCodePages, Page);
+    std::atomic_ref<uint32_t>(Manager->CodeWritten).store(1, std::memory_order_release);
+  }
+  if (Manager->DirtyPages && !testPage(Manager->DirtyPages, Page)) {
+    setPage(Manager->DirtyPages, Page);
+    Manager->DirtyList[Manager->NumDirty++] = Page;
+    updateWatch(Manager, Page);
+  }
+}
+
+// Called by every store helper. A store to a page that is not watched only
+// costs the bit test.
+inline void noteStore(MemoryManager* Manager, uint32_t Addr, uint32_t Size) {
+  for (uint32_t Page : {Addr >> GuestPageShift, (Addr + Size - 1) >> GuestPageShift}) {
+    if (testPage(Manager->WatchedPages, Page)) [[unlikely]]
+      noteWatchedStore(Manager, Page);
+  }
+}
 
 uint8_t read8(MemoryManager*, uint32_t Addr);
 uint16_t read16(MemoryManager*, uint32_t Addr);
@@ -29,6 +98,16 @@ uint32_t read32(MemoryManager*, uint32_t Addr);
 void write8(MemoryManager*, uint32_t Addr, uint8_t Data);
 void write16(MemoryManager*, uint32_t Addr, uint16_t Data);
 void write32(MemoryManager*, uint32_t Addr, uint32_t Data);
+// Vector loads and stores: element I of Size bytes is at Addr + I * Stride
+// in guest memory and at Data + I * Size in the vector register. Only the
+// elements whose bit is set in Mask are transferred.
+void readVector(MemoryManager*, uint32_t Addr, uint32_t Stride, uint32_t Size, uint32_t Mask, uint8_t* Data);
+void writeVector(MemoryManager*, uint32_t Addr, uint32_t Stride, uint32_t Size, uint32_t Mask, uint8_t const* Data);
+// Host address of the word at Addr, which LR, SC and AMO instructions access
+// with host atomics. SC and AMO call atomicStored once they wrote it, so the
+// dispatcher never sees a code write before the new bytes are there.
+uint32_t* atomicAddress(MemoryManager*, uint32_t Addr);
+void atomicStored(MemoryManager*, uint32_t Addr);
 
 template<typename T>
 T* mapAddress(MemoryManager* Managers, uint32_t Addr) {
@@ -40,6 +119,29 @@ T* mapAddress(MemoryManager* Managers, uint32_t Addr) {
   return nullptr;
 }
 
+// Shared by both builds of readVector and writeVector. Elements are copied
+// one at a time: consecutive ones may lie in different segments.
+inline void copyElementsIn(MemoryManager* Manager, uint32_t Addr, uint32_t Stride, uint32_t Size, uint32_t Mask,
+                           uint8_t* Data) {
+  for (; Mask; Mask &= Mask - 1) {
+    uint32_t I = __builtin_ctz(Mask);
+    uint8_t const* Element = mapAddress<uint8_t>(Manager, Addr + I * Stride);
+    for (uint32_t B = 0; B < Size; ++B)
+      Data[I * Size + B] = Element[B];
+  }
+}
+
+inline void copyElementsOut(MemoryManager* Manager, uint32_t Addr, uint32_t Stride, uint32_t Size, uint32_t Mask,
+                            uint8_t const* Data) {
+  for (; Mask; Mask &= Mask - 1) {
+    uint32_t I = __builtin_ctz(Mask);
+    uint8_t* Element = mapAddress<uint8_t>(Manager, Addr + I * Stride);
+    for (uint32_t B = 0; B < Size; ++B)
+      Element[B] = Data[I * Size + B];
+    noteStore(Manager, Addr + I * Stride, Size);
+  }
+}
+
 } // end namespace riscv
 
 #endif // DBTRANSLATOR_MEMORY_H
@@ -0,0 +1,30 @@
+#ifndef DBTRANSLATOR_MEMORYRUNTIME_H
+#define DBTRANSLATOR_MEMORYRUNTIME_H
+
+#include <memory>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Error.h>
+
+namespace riscv {
+
+// The read8..write32, readVector/writeVector and atomicAddress/atomicStored
+// helpers translated code calls, built into the library in two forms: the
+// host functions from Memory.cpp and the same helpers as bitcode embedded at
+// build time.
+
+// Defines the helpers in the JIT's main JITDylib as absolute symbols
+// bound to the host functions. Nothing is parsed or compiled.
+llvm::Error addHostMemoryRuntime(llvm::orc::LLJIT& JIT);
+
+// Parses the embedded bitcode into Ctx.
+llvm::Expected<std::unique_ptr<llvm::Module>> loadMemoryRuntime(llvm::LLVMContext& Ctx);
+
+// Links the helpers M calls into M as internal functions and inlines them,
+// so the translated code does not call out for memory accesses.
+llvm::Error linkMemoryRuntime(llvm::Module& M);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_MEMORYRUNTIME_H
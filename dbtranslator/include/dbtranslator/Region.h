@@ -0,0 +1,62 @@
+#ifndef DBTRANSLATOR_REGION_H
+#define DBTRANSLATOR_REGION_H
+
+#include "Instruction.h"
+#include "Memory.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <llvm/ADT/STLFunctionalExtras.h>
+
+namespace riscv {
+
+// Where control went after a block. Blocks end at their only branch, so two
+// targets cover the taken and fall-through sides; anything else (indirect
+// jumps with many targets) is only counted.
+struct EdgeProfile {
+  static constexpr int NumTargets = 2;
+  uint32_t Targets[NumTargets] = {};
+  uint64_t Counts[NumTargets] = {};
+  uint64_t OtherCount = 0;
+
+  void record(uint32_t Target) {
+    for (int I = 0; I < NumTargets; ++I) {
+      if (!Counts[I])
+        Targets[I] = Target;
+      if (Targets[I] == Target) {
+        ++Counts[I];
+        return;
+      }
+    }
+    ++OtherCount;
+  }
+};
+
+struct RegionBlock {
+  uint32_t PC;
+  size_t NumInstrs;
+  uint64_t ExecCount;
+  EdgeProfile Edges;
+};
+
+// Returns false if there is no profiled block at PC or it must not be part of
+// a region.
+using RegionLookup = llvm::function_ref<bool(uint32_t PC, RegionBlock& Block)>;
+
+// Collects the blocks reachable from Head over edges that carry at least
+// 1/MinEdgeShare of their source block's executions, hottest paths first.
+// Calls and returns are ordinary edges, so a hot callee ends up in the
+// region of its caller.
+std::vector<RegionBlock> formRegion(uint32_t Head, RegionLookup Lookup, size_t MaxBlocks, uint64_t MinEdgeShare = 16);
+
+// Emits the region as the body of Data.CurrentFunction, whose entry block is
+// the builder's insertion point. Every guest block gets its own basic block
+// and ends in a switch on the next PC that carries the profiled edge counts
+// as branch weights; PCs outside the region return to the dispatcher. Every
+// block adds its instructions to CPUState::RegionInstrs, and back-edges
+// return to the dispatcher as well once that reaches RegionBudget.
+void buildRegion(IRData& Data, MemoryManager* Manager, std::vector<RegionBlock> const& Blocks);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_REGION_H
@@ -0,0 +1,55 @@
+#ifndef DBTRANSLATOR_SCHEDULER_H
+#define DBTRANSLATOR_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace riscv {
+
+// Where workers of Engine::runAll() that found nothing to run or steal
+// wait. Every push onto a run queue, and the end of the last task, wakes
+// them; a worker passes the count it saw before it looked, so a push while
+// it was looking is not missed.
+class IdleWorkers {
+public:
+  uint64_t changes() const { return Changes.load(); }
+  void notify();
+  void wait(uint64_t Seen);
+
+private:
+  std::mutex Mutex;
+  std::condition_variable Wakeup;
+  std::atomic<uint64_t> Changes = 0;
+  std::atomic<unsigned> Waiting = 0;
+};
+
+// Run queue of one worker of Engine::runAll(). The worker takes tasks from
+// the front and puts the ones whose quantum ran out at the back, so its
+// tasks take turns; idle workers steal from the back, the tasks the victim
+// would get to last. A queue is only touched between quanta, so a lock is
+// cheap enough.
+class RunQueue {
+public:
+  explicit RunQueue(IdleWorkers& Idle) : Idle(Idle) {}
+
+  // Wakes the idle workers, which may steal Task.
+  void push(size_t Task);
+  std::optional<size_t> pop();
+  // Moves half of Victim's tasks, at least one, to this queue and returns
+  // one of them.
+  std::optional<size_t> stealFrom(RunQueue& Victim);
+
+private:
+  IdleWorkers& Idle;
+  std::mutex Mutex;
+  std::deque<size_t> Tasks;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_SCHEDULER_H
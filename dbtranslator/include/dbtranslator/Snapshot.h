@@ -0,0 +1,47 @@
+#ifndef DBTRANSLATOR_SNAPSHOT_H
+#define DBTRANSLATOR_SNAPSHOT_H
+
+#include "CPU.h"
+#include "Discovery.h"
+#include "Memory.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/FileSystem.h>
+
+namespace riscv {
+
+// Complete guest state saved to a file: registers, every memory segment and
+// the manifest of translated blocks. Segment images are stored page-aligned
+// with all-zero pages left as holes, so the file is sparse and restore maps
+// it copy-on-write instead of reading it.
+class Snapshot {
+public:
+  static llvm::Error write(llvm::StringRef Path, llvm::StringRef ElfPath, CPUState const& State,
+                           llvm::ArrayRef<DiscoveredBlock> Blocks);
+
+  // Fails if the snapshot was taken from a different ELF than ElfPath.
+  static llvm::Expected<std::unique_ptr<Snapshot>> restore(llvm::StringRef Path, llvm::StringRef ElfPath);
+
+  // State.Manager points to memory owned by the snapshot.
+  CPUState State;
+  // Blocks translated when the snapshot was taken.
+  std::vector<DiscoveredBlock> Blocks;
+
+private:
+  Snapshot() = default;
+
+  MemoryManager Manager;
+  std::vector<SegmentManager> Segments;
+  std::vector<llvm::sys::fs::mapped_file_region> Mappings;
+  std::unique_ptr<uint8_t[]> WatchedPages;
+  std::unique_ptr<uint8_t[]> CodePages;
+  std::unique_ptr<uint8_t[]> WrittenCodePages;
+};
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_SNAPSHOT_H
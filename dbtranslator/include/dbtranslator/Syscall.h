@@ -0,0 +1,29 @@
+#ifndef DBTRANSLATOR_SYSCALL_H
+#define DBTRANSLATOR_SYSCALL_H
+
+#include "CPU.h"
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace riscv {
+
+// Every ECALL calls handleSyscall, which translated code knows by this name.
+inline constexpr char const* SyscallSymbol = "dbt_syscall";
+
+// The Linux syscalls a guest can make: exit and exit_group (a7 = 93, 94)
+// stop it with the status in a0 by setting PC to 0, and write (64) to fd 1
+// or 2 goes to the guest output of the calling thread. Anything else
+// returns -ENOSYS.
+void handleSyscall(CPUState* State);
+
+// Where guest writes to stdout and stderr go on this thread; null (the
+// default) is the host's own stdout and stderr.
+void setGuestOutput(llvm::raw_ostream* Stdout, llvm::raw_ostream* Stderr);
+
+// Defines SyscallSymbol in the JIT's main JITDylib.
+llvm::Error addHostSyscalls(llvm::orc::LLJIT& JIT);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_SYSCALL_H
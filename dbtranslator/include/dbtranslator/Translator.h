@@ -0,0 +1,43 @@
+#ifndef DBTRANSLATOR_TRANSLATOR_H
+#define DBTRANSLATOR_TRANSLATOR_H
+
+#include "Coverage.h"
+#include "Instruction.h"
+#include "Memory.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace riscv {
+
+// Declares the memory, syscall, floating-point environment and spin-wait
+// helpers in Data.Module and fills Data.MemoryFunctions,
+// Data.SyscallFunction, Data.FloatFunctions and Data.PauseFunction.
+void addMemoryInterface(IRData& Data);
+
+// Declares the edge coverage globals (see Coverage.h) in Data.Module;
+// blocks emitted afterwards are instrumented.
+void addCoverage(IRData& Data);
+
+// Emits the guest block starting at PC at the builder's insertion point. The
+// block ends after the first branch or jump, or after Threshold
+// instructions. Common two-instruction idioms are emitted fused (see
+// Fusion.h), and with Data.CodeInfo set a jump table load becomes a switch
+// (see JumpTable.h). The entry of a C library routine in Data.Libc becomes
+// a call of its host version (see Libc.h). Returns the number of guest
+// instructions emitted.
+size_t emitBlock(IRData& Data, MemoryManager* Manager, uint32_t PC, size_t Threshold);
+
+// Number of instructions emitBlock would emit for the same arguments,
+// found by decoding only.
+size_t blockLength(MemoryManager* Manager, uint32_t PC, size_t Threshold);
+
+// Address just past the first NumInstrs instructions at PC, which may mix
+// 2- and 4-byte encodings.
+uint32_t blockEnd(MemoryManager* Manager, uint32_t PC, size_t NumInstrs);
+
+// The function-level cleanup run on every translated module.
+void optimizeModule(llvm::Module& M);
+
+} // end namespace riscv
+
+#endif // DBTRANSLATOR_TRANSLATOR_H
@@ -0,0 +1,56 @@
+// Memory helpers called by translated code, compiled to bitcode at build
+// time and embedded in the library (see src/MemoryRuntime.cpp), so they can
+// be linked into translated modules and inlined.
+
+#include "Memory.h"
+
+using riscv::MemoryManager;
+using riscv::mapAddress;
+
+extern "C" {
+
+uint8_t read8(MemoryManager* Manager, uint32_t Addr) {
+  return *mapAddress<uint8_t>(Manager, Addr);
+}
+
+uint16_t read16(MemoryManager* Manager, uint32_t Addr) {
+  return *mapAddress<uint16_t>(Manager, Addr);
+}
+
+uint32_t read32(MemoryManager* Manager, uint32_t Addr) {
+  return *mapAddress<uint32_t>(Manager, Addr);
+}
+
+void write8(MemoryManager* Manager, uint32_t Addr, uint8_t Data) {
+  *mapAddress<uint8_t>(Manager, Addr) = Data;
+  riscv::noteStore(Manager, Addr, sizeof(Data));
+}
+
+void write16(MemoryManager* Manager, uint32_t Addr, uint16_t Data) {
+  *mapAddress<uint16_t>(Manager, Addr) = Data;
+  riscv::noteStore(Manager, Addr, sizeof(Data));
+}
+
+void write32(MemoryManager* Manager, uint32_t Addr, uint32_t Data) {
+  *mapAddress<uint32_t>(Manager, Addr) = Data;
+  riscv::noteStore(Manager, Addr, sizeof(Data));
+}
+
+void readVector(MemoryManager* Manager, uint32_t Addr, uint32_t Stride, uint32_t Size, uint32_t Mask, uint8_t* Data) {
+  riscv::copyElementsIn(Manager, Addr, Stride, Size, Mask, Data);
+}
+
+void writeVector(MemoryManager* Manager, uint32_t Addr, uint32_t Stride, uint32_t Size, uint32_t Mask,
+                 uint8_t const* Data) {
+  riscv::copyElementsOut(Manager, Addr, Stride, Size, Mask, Data);
+}
+
+uint32_t* atomicAddress(MemoryManager* Manager, uint32_t Addr) {
+  return mapAddress<uint32_t>(Manager, Addr);
+}
+
+void atomicStored(MemoryManager* Manager, uint32_t Addr) {
+  riscv::noteStore(Manager, Addr, sizeof(uint32_t));
+}
+
+} // extern "C"
@@ -0,0 +1,31 @@
+#include "Aot.h"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA1.h>
+
+namespace riscv {
+
+llvm::Expected<FileHash> hashFile(llvm::StringRef Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return llvm::createFileError(Path, Buffer.getError());
+  return llvm::SHA1::hash(llvm::arrayRefFromStringRef((*Buffer)->getBuffer()));
+}
+
+llvm::Expected<std::string> optionsPrefix(bool Coverage, bool InlineMemory,
+                                          std::optional<std::string> const& MemoryImpl) {
+  std::string Prefix;
+  if (Coverage)
+    Prefix += "cov-";
+  if (InlineMemory)
+    Prefix += "inline-";
+  if (MemoryImpl) {
+    auto ImplHash = hashFile(*MemoryImpl);
+    if (!ImplHash)
+      return ImplHash.takeError();
+    Prefix += "mem" + llvm::toHex(llvm::ArrayRef<uint8_t>(*ImplHash).take_front(8), /*LowerCase=*/true) + "-";
+  }
+  return Prefix;
+}
+
+} // end namespace riscv
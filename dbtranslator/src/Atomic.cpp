@@ -0,0 +1,140 @@
+// Lowering of the A extension and of the fences to host atomics, for guests
+// whose harts run on parallel host threads. The aq and rl bits pick the
+// LLVM ordering; plain loads and stores need nothing more, as every host
+// the translator targets orders them at least as strongly as RVWMO.
+//
+// LR.W records the word and the value it loaded in CPUState, and SC.W is a
+// compare-and-exchange against that value. An SC therefore also succeeds
+// when other harts wrote the word back to the loaded value in between,
+// which the lock-free algorithms LR/SC sequences implement do not observe.
+
+#include "CPU.h"
+#include "Instruction.h"
+#include <cstdint>
+#include <llvm/IR/Instructions.h>
+
+namespace riscv {
+
+namespace {
+
+bool acquires(uint32_t InstructionData) { return (InstructionData >> 26) & 0x1; }
+bool releases(uint32_t InstructionData) { return (InstructionData >> 25) & 0x1; }
+
+// Fields of CPUState after the FP state.
+enum StateField : unsigned { ReservationValid = 9, ReservationAddress = 10, ReservationValue = 11 };
+
+llvm::Value* stateField(IRData& Data, StateField Field) {
+  return Data.Builder.CreateStructGEP(Data.CPUStateTy, Data.CurrentFunction->getArg(0), Field);
+}
+
+// aq.rl makes an access sequentially consistent; LLVM has no release load,
+// so an LR with only rl gets that too.
+llvm::AtomicOrdering ordering(uint32_t InstructionData, bool IsLoad) {
+  bool Acquire = acquires(InstructionData);
+  bool Release = releases(InstructionData);
+  if (Release && (Acquire || IsLoad))
+    return llvm::AtomicOrdering::SequentiallyConsistent;
+  if (Acquire)
+    return llvm::AtomicOrdering::Acquire;
+  if (Release)
+    return llvm::AtomicOrdering::Release;
+  return llvm::AtomicOrdering::Monotonic;
+}
+
+void buildAMO(IRData& Data, uint32_t InstructionData, llvm::AtomicRMWInst::BinOp Op) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *Address = Data.readReg(regSrc1(InstructionData));
+  llvm::Value *Source = Data.readReg(regSrc2(InstructionData));
+  llvm::Value *Old = B.CreateAtomicRMW(Op, Data.atomicAddress(Address), Source, llvm::MaybeAlign(4),
+                                       ordering(InstructionData, false));
+  Data.atomicStored(Address);
+  Data.writeReg(regDest(InstructionData), Old);
+}
+
+// FENCE predecessor and successor bits for memory reads and writes.
+inline constexpr uint32_t FenceRead = 0x2;
+inline constexpr uint32_t FenceWrite = 0x1;
+
+} // end anonymous namespace
+
+void LRWInstruction::build_ir(IRData& Data) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *Address = Data.readReg(regSrc1(InstructionData));
+  llvm::LoadInst *Value = B.CreateAlignedLoad(B.getInt32Ty(), Data.atomicAddress(Address), llvm::Align(4));
+  Value->setAtomic(ordering(InstructionData, true));
+  B.CreateStore(B.getInt32(1), stateField(Data, ReservationValid));
+  B.CreateStore(Address, stateField(Data, ReservationAddress));
+  B.CreateStore(Value, stateField(Data, ReservationValue));
+  Data.writeReg(regDest(InstructionData), Value);
+}
+
+// Fails without touching memory unless the reservation is for this word;
+// either way the reservation is gone afterwards.
+void SCWInstruction::build_ir(IRData& Data) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::LLVMContext& Ctx = B.getContext();
+  llvm::Value *Address = Data.readReg(regSrc1(InstructionData));
+  llvm::Value *Source = Data.readReg(regSrc2(InstructionData));
+  llvm::Value *Valid = B.CreateLoad(B.getInt32Ty(), stateField(Data, ReservationValid));
+  llvm::Value *Reserved = B.CreateLoad(B.getInt32Ty(), stateField(Data, ReservationAddress));
+  llvm::Value *Expected = B.CreateLoad(B.getInt32Ty(), stateField(Data, ReservationValue));
+  llvm::Value *Matches = B.CreateAnd(B.CreateICmpNE(Valid, B.getInt32(0)), B.CreateICmpEQ(Reserved, Address));
+  B.CreateStore(B.getInt32(0), stateField(Data, ReservationValid));
+
+  auto *Before = B.GetInsertBlock();
+  auto *Attempt = llvm::BasicBlock::Create(Ctx, "sc_attempt", Data.CurrentFunction);
+  auto *Done = llvm::BasicBlock::Create(Ctx, "sc_done", Data.CurrentFunction);
+  B.CreateCondBr(Matches, Attempt, Done);
+
+  B.SetInsertPoint(Attempt);
+  llvm::Value *Pair = B.CreateAtomicCmpXchg(Data.atomicAddress(Address), Expected, Source, llvm::MaybeAlign(4),
+                                            ordering(InstructionData, false), llvm::AtomicOrdering::Monotonic);
+  llvm::Value *Failed = B.CreateZExt(B.CreateNot(B.CreateExtractValue(Pair, 1)), B.getInt32Ty());
+  Data.atomicStored(Address);
+  B.CreateBr(Done);
+
+  B.SetInsertPoint(Done);
+  llvm::PHINode *Result = B.CreatePHI(B.getInt32Ty(), 2);
+  Result->addIncoming(B.getInt32(1), Before);
+  Result->addIncoming(Failed, Attempt);
+  Data.writeReg(regDest(InstructionData), Result);
+}
+
+void AMOSWAPWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::Xchg); }
+void AMOADDWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::Add); }
+void AMOXORWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::Xor); }
+void AMOANDWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::And); }
+void AMOORWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::Or); }
+void AMOMINWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::Min); }
+void AMOMAXWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::Max); }
+void AMOMINUWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::UMin); }
+void AMOMAXUWInstruction::build_ir(IRData& Data) { buildAMO(Data, InstructionData, llvm::AtomicRMWInst::UMax); }
+
+// Only ordering earlier writes before later reads needs a full fence; the
+// weaker orderings cost nothing on x86 and a dmb ishld or ishst on AArch64.
+void FENCEInstruction::build_ir(IRData& Data) {
+  uint32_t Pred = (InstructionData >> 24) & 0xF;
+  uint32_t Succ = (InstructionData >> 20) & 0xF;
+  uint32_t Memory = FenceRead | FenceWrite;
+  if (!(Pred & Memory) || !(Succ & Memory))
+    return;
+  llvm::AtomicOrdering Ordering;
+  if ((Pred & FenceWrite) && (Succ & FenceRead))
+    Ordering = llvm::AtomicOrdering::SequentiallyConsistent;
+  else if (!(Pred & FenceWrite))
+    Ordering = llvm::AtomicOrdering::Acquire;
+  else
+    Ordering = llvm::AtomicOrdering::Release;
+  Data.Builder.CreateFence(Ordering);
+}
+
+// Everything but writes before reads, exactly an acquire-release fence.
+void FENCETSOInstruction::build_ir(IRData& Data) {
+  Data.Builder.CreateFence(llvm::AtomicOrdering::AcquireRelease);
+}
+
+void PAUSEInstruction::build_ir(IRData& Data) {
+  Data.Builder.CreateCall(Data.PauseFunction);
+}
+
+} // end namespace riscv
@@ -0,0 +1,204 @@
+#include "Baseline.h"
+#include "Compressed.h"
+#include "Fusion.h"
+#include "Instruction.h"
+#include "Syscall.h"
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+namespace riscv {
+
+namespace {
+
+enum class HoleKind {
+  RD,
+  RS1,
+  RS2,
+  IMM,
+  PC,
+  NEXT_PC,
+  CONTINUE,
+  READ8,
+  READ16,
+  READ32,
+  WRITE8,
+  WRITE16,
+  WRITE32,
+  SYSCALL,
+};
+
+struct StencilHole {
+  uint32_t Offset;
+  HoleKind Kind;
+  int64_t Addend;
+};
+
+struct Stencil {
+  uint8_t const* Code;
+  uint32_t Size;
+  uint32_t FallThroughSize;
+  StencilHole const* Holes;
+  uint32_t NumHoles;
+};
+
+#include "Stencils.inc"
+
+// Instructions whose only effect is writing rd; with rd == x0 they are
+// skipped instead of emitted.
+bool onlyWritesRegDest(Instr I) {
+  switch (I) {
+    case Instr::JAL:
+    case Instr::JALR:
+    case Instr::BEQ:
+    case Instr::BNE:
+    case Instr::BLT:
+    case Instr::BGE:
+    case Instr::BLTU:
+    case Instr::BGEU:
+    case Instr::SB:
+    case Instr::SH:
+    case Instr::SW:
+    case Instr::ECALL:
+      return false;
+    default:
+      return true;
+  }
+}
+
+struct Patch {
+  uint32_t RegDest;
+  uint32_t RegSrc1;
+  uint32_t RegSrc2;
+  uint32_t Immediate;
+  uint32_t PC;
+  uint32_t NextPC;
+};
+
+uint64_t holeValue(HoleKind Kind, Patch const& P, uint8_t* Next) {
+  switch (Kind) {
+    case HoleKind::RD: return P.RegDest;
+    case HoleKind::RS1: return P.RegSrc1;
+    case HoleKind::RS2: return P.RegSrc2;
+    case HoleKind::IMM: return P.Immediate;
+    case HoleKind::PC: return P.PC;
+    case HoleKind::NEXT_PC: return P.NextPC;
+    case HoleKind::CONTINUE: return reinterpret_cast<uint64_t>(Next);
+    case HoleKind::READ8: return reinterpret_cast<uint64_t>(&read8);
+    case HoleKind::READ16: return reinterpret_cast<uint64_t>(&read16);
+    case HoleKind::READ32: return reinterpret_cast<uint64_t>(&read32);
+    case HoleKind::WRITE8: return reinterpret_cast<uint64_t>(&write8);
+    case HoleKind::WRITE16: return reinterpret_cast<uint64_t>(&write16);
+    case HoleKind::WRITE32: return reinterpret_cast<uint64_t>(&write32);
+    case HoleKind::SYSCALL: return reinterpret_cast<uint64_t>(&handleSyscall);
+  }
+  return 0;
+}
+
+// Copies S to Cursor, patches it to continue right after itself and returns
+// the new end of the block.
+uint8_t* emit(Stencil const& S, Patch const& P, uint8_t* Cursor) {
+  uint8_t* Next = Cursor + S.FallThroughSize;
+  std::memcpy(Cursor, S.Code, S.FallThroughSize);
+  for (uint32_t I = 0; I < S.NumHoles; ++I) {
+    uint64_t Value = holeValue(S.Holes[I].Kind, P, Next) + S.Holes[I].Addend;
+    std::memcpy(Cursor + S.Holes[I].Offset, &Value, sizeof(Value));
+  }
+  return Next;
+}
+
+// Upper bound on the bytes one block can take: every instruction plus the
+// SETPC and RETURN epilogue.
+size_t maxBlockSize(size_t Threshold) {
+  size_t Largest = 0;
+  for (int I = 0; I <= static_cast<int>(Instr::EBREAK); ++I) {
+    if (Stencil const* S = getStencil(static_cast<Instr>(I)))
+      Largest = std::max<size_t>(Largest, S->Size);
+  }
+  return Largest * Threshold + glue_SETPC.Size + glue_RETURN.Size;
+}
+
+// Emits First, patched with P, and Second right after it as one when the
+// baseline has a fused form for them: a far call or jump through a LUI or
+// AUIPC becomes a JAL, and a constant built by LUI+ADDI a single LUI.
+// Returns the new end of the block, or null if the pair is not fused.
+uint8_t* emitFused(Instr First, uint32_t FirstData, Patch const& P, Instr Second, uint32_t SecondData,
+                   uint32_t SecondLength, uint8_t* Cursor) {
+  if (matchFusion(First, FirstData, Second, SecondData) != Fusion::UpperImmediate)
+    return nullptr;
+  bool Replaced = overwritesUpper(FirstData, Second, SecondData);
+  Patch Fused{(SecondData >> 7) & 0x1F, 0, 0, 0, P.NextPC, P.NextPC + SecondLength};
+  if (auto Target = fusedJumpTarget(First, FirstData, P.PC, Second, SecondData)) {
+    if (!Replaced)
+      Cursor = emit(*getStencil(First), P, Cursor);
+    Fused.Immediate = *Target - P.NextPC;
+    return emit(*getStencil(Instr::JAL), Fused, Cursor);
+  }
+  if (Replaced && Second == Instr::ADDI) {
+    Fused.Immediate = upperImmediate(First, FirstData, P.PC) + immediate(Instr::ADDI, SecondData);
+    return emit(*getStencil(Instr::LUI), Fused, Cursor);
+  }
+  return nullptr;
+}
+
+} // end anonymous namespace
+
+BaselineCompiler::BaselineCompiler(size_t CodeSize) {
+  std::error_code EC;
+  Block = llvm::sys::Memory::allocateMappedMemory(
+      CodeSize, nullptr, llvm::sys::Memory::MF_READ | llvm::sys::Memory::MF_WRITE | llvm::sys::Memory::MF_EXEC, EC);
+}
+
+BaselineCompiler::~BaselineCompiler() {
+  if (Block.base())
+    llvm::sys::Memory::releaseMappedMemory(Block);
+}
+
+BlockFunc BaselineCompiler::compile(uint32_t PC, MemoryManager* Manager, size_t Threshold, size_t* NumInstrsOut) {
+  if (!Block.base() || Used + maxBlockSize(Threshold) > Block.allocatedSize())
+    return nullptr;
+
+  uint8_t* Begin = static_cast<uint8_t*>(Block.base()) + Used;
+  uint8_t* Cursor = Begin;
+  bool Continue = true;
+  uint32_t TempPC = PC;
+  size_t NumInstrs = 0;
+  while (Continue && NumInstrs < Threshold) {
+    uint32_t Length;
+    uint32_t InstructionData = fetchInstruction(Manager, TempPC, Length);
+    Instr CurrentInstruction = decode(InstructionData);
+    if (needsLLVM(CurrentInstruction))
+      return nullptr;
+    Patch P{regDest(InstructionData), regSrc1(InstructionData), regSrc2(InstructionData),
+            immediate(CurrentInstruction, InstructionData), TempPC, TempPC + Length};
+    if (!endsBlock(CurrentInstruction) && NumInstrs + 2 <= Threshold) {
+      uint32_t NextLength;
+      uint32_t NextData = fetchInstruction(Manager, P.NextPC, NextLength);
+      Instr NextInstruction = decode(NextData);
+      if (uint8_t* End = emitFused(CurrentInstruction, InstructionData, P, NextInstruction, NextData, NextLength, Cursor)) {
+        Cursor = End;
+        TempPC = P.NextPC + NextLength;
+        NumInstrs += 2;
+        Continue = !endsBlock(NextInstruction);
+        continue;
+      }
+    }
+    Stencil const* S = getStencil(CurrentInstruction);
+    if (S && !(P.RegDest == 0 && onlyWritesRegDest(CurrentInstruction)))
+      Cursor = emit(*S, P, Cursor);
+    TempPC += Length;
+    ++NumInstrs;
+    Continue = !endsBlock(CurrentInstruction);
+  }
+  if (Continue)
+    Cursor = emit(glue_SETPC, Patch{0, 0, 0, 0, TempPC, TempPC}, Cursor);
+  Cursor = emit(glue_RETURN, Patch{}, Cursor);
+
+  Used = Cursor - static_cast<uint8_t*>(Block.base());
+  llvm::sys::Memory::InvalidateInstructionCache(Begin, Cursor - Begin);
+  if (NumInstrsOut)
+    *NumInstrsOut = NumInstrs;
+  return reinterpret_cast<BlockFunc>(Begin);
+}
+
+} // end namespace riscv
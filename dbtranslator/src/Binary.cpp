@@ -37,6 +37,55 @@ std::pair<MemoryManager*, uint32_t> parseElf(char const* FileName, bool Debug) {
   Manager->MemorySize = 1 << 24;
   Manager->Memory = static_cast<uint8_t*>(operator new(Manager->MemorySize));
   Manager->GuestAddress = -1 - Manager->MemorySize;
+  Result->WatchedPages = new uint8_t[PageBitmapBytes]();
+  Result->CodePages = new uint8_t[PageBitmapBytes]();
+  Result->WrittenCodePages = new uint8_t[PageBitmapBytes]();
   return {Result, Reader.get_entry()};
 }
+
+void freeElf(MemoryManager* Manager) {
+  for (uint32_t I = 0; I < Manager->NumSegments; ++I)
+    operator delete(Manager->SegmentData[I].Memory);
+  operator delete(Manager->SegmentData);
+  delete[] Manager->WatchedPages;
+  delete[] Manager->CodePages;
+  delete[] Manager->WrittenCodePages;
+  delete Manager;
+}
+
+ElfCodeInfo parseElfCode(char const* FileName) {
+  ELFIO::elfio Reader;
+  Reader.load(FileName);
+  ElfCodeInfo Result;
+  Result.EntryPoint = Reader.get_entry();
+  for (auto const& Segment : Reader.segments) {
+    if (Segment->get_type() != ELFIO::PT_LOAD)
+      continue;
+    uint32_t Begin = Segment->get_virtual_address();
+    CodeRegion Region{Begin, Begin + static_cast<uint32_t>(Segment->get_file_size())};
+    if (Segment->get_flags() & ELFIO::PF_X)
+      Result.ExecutableRegions.push_back(Region);
+    if (!(Segment->get_flags() & ELFIO::PF_W))
+      Result.ReadOnlyRegions.push_back(Region);
+  }
+  for (auto const& Section : Reader.sections) {
+    if (Section->get_type() != ELFIO::SHT_SYMTAB)
+      continue;
+    ELFIO::const_symbol_section_accessor Symbols(Reader, Section.get());
+    for (ELFIO::Elf_Xword I = 0; I < Symbols.get_symbols_num(); ++I) {
+      std::string Name;
+      ELFIO::Elf64_Addr Value;
+      ELFIO::Elf_Xword Size;
+      unsigned char Bind, Type, Other;
+      ELFIO::Elf_Half SectionIndex;
+      Symbols.get_symbol(I, Name, Value, Size, Bind, Type, SectionIndex, Other);
+      if (Type != ELFIO::STT_FUNC || Value == 0)
+        continue;
+      Result.FunctionSymbols.push_back(Value);
+      Result.NamedFunctions.push_back({Name, static_cast<uint32_t>(Value), static_cast<uint32_t>(Size)});
+    }
+  }
+  return Result;
+}
+
 } // end namespace riscv
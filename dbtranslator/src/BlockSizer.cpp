@@ -0,0 +1,67 @@
+#include "BlockSizer.h"
+#include <algorithm>
+#include <bit>
+
+namespace riscv {
+
+namespace {
+
+// Until a tier has compiled anything we assume LLVM-like costs, so early
+// resizing stays conservative.
+constexpr uint64_t DefaultCostPerInstrNs = 20000;
+
+char const* tierName(Tier T) {
+  return T == Tier::Baseline ? "baseline" : "optimized";
+}
+
+} // end anonymous namespace
+
+BlockSizer::BlockSizer(Options Opts) : Opts(Opts) {}
+
+void BlockSizer::addOverride(uint32_t Begin, uint32_t End, size_t Limit) {
+  Overrides[Begin] = {End, std::max<size_t>(Limit, 1)};
+}
+
+size_t BlockSizer::limitFor(uint32_t PC, uint64_t ExecCount, Tier T) const {
+  auto It = Overrides.upper_bound(PC);
+  if (It != Overrides.begin() && PC < std::prev(It)->second.End)
+    return std::prev(It)->second.Limit;
+
+  TierCost const& Cost = Costs[static_cast<int>(T)];
+  uint64_t CostPerInstr = Cost.Instrs ? std::max<uint64_t>(Cost.Nanoseconds / Cost.Instrs, 1) : DefaultCostPerInstrNs;
+  uint64_t Affordable = ExecCount * Opts.BudgetPerExecNs / CostPerInstr;
+  // Round down to a power of two so a block is not recompiled for every
+  // small change of its execution count.
+  size_t Limit = Affordable ? std::bit_floor(Affordable) : 0;
+  return std::clamp(Limit, Opts.MinInstrs, Opts.MaxInstrs);
+}
+
+void BlockSizer::recordCompile(uint32_t PC, size_t NumInstrs, std::chrono::nanoseconds Cost, Tier T) {
+  TierCost& Total = Costs[static_cast<int>(T)];
+  Total.Nanoseconds += Cost.count();
+  Total.Instrs += NumInstrs;
+  ChosenSizes[PC] = NumInstrs;
+}
+
+void BlockSizer::printReport(llvm::raw_ostream& OS) const {
+  OS << "block sizes: min " << Opts.MinInstrs << ", max " << Opts.MaxInstrs << ", budget "
+     << Opts.BudgetPerExecNs << " ns/execution\n";
+  for (int I = 0; I < 2; ++I) {
+    if (!Costs[I].Instrs)
+      continue;
+    OS << "  " << tierName(static_cast<Tier>(I)) << ": " << Costs[I].Instrs << " instructions compiled, "
+       << Costs[I].Nanoseconds / Costs[I].Instrs << " ns/instruction\n";
+  }
+  for (auto const& [Begin, O] : Overrides)
+    OS << "  override [" << llvm::format_hex(Begin, 10) << ", " << llvm::format_hex(O.End, 10) << "): " << O.Limit << "\n";
+
+  std::map<size_t, size_t> Histogram;
+  for (auto const& [PC, Size] : ChosenSizes)
+    ++Histogram[Size];
+  OS << "  instructions per block (size: blocks):";
+  for (auto const& [Size, Count] : Histogram)
+    OS << " " << Size << ":" << Count;
+  OS << "\n";
+}
+
+} // end namespace riscv
@@ -13,7 +13,11 @@ llvm::Type* getCPUStateType(llvm::LLVMContext& Ctx) {
   }
   auto *CPUStructTy = llvm::StructType::create(Ctx, "CPUState");
   auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Ctx), 32);
-  CPUStructTy->setBody({RegsArrTy, llvm::Type::getInt32Ty(Ctx), getMemoryPointerType(Ctx)});
+  auto *VectorRegsTy = llvm::ArrayType::get(llvm::ArrayType::get(llvm::Type::getInt8Ty(Ctx), VectorBytes), 32);
+  auto *FloatRegsTy = llvm::ArrayType::get(llvm::Type::getInt64Ty(Ctx), 32);
+  auto *I32Ty = llvm::Type::getInt32Ty(Ctx);
+  CPUStructTy->setBody({RegsArrTy, I32Ty, getMemoryPointerType(Ctx), I32Ty, I32Ty, VectorRegsTy, FloatRegsTy, I32Ty,
+                        I32Ty, I32Ty, I32Ty, I32Ty, I32Ty, I32Ty});
   return CPUStructTy;
 }
 
@@ -26,6 +30,8 @@ void dump(CPUState* State) {
     std::cout << "R" << I << " " << State->Registers[I] << std::endl;
   }
   std::cout << "PC " << State->PC << std::endl;
+  std::cout << "VL " << State->VL << " VTYPE " << State->VType << std::endl;
+  std::cout << "FCSR " << State->FCSR << std::endl;
 }
 
 } // end namespace riscv
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "CodeBudget.h"
+#include <algorithm>
+#include <llvm/ExecutionEngine/JITLink/JITLink.h>
+#include <llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h>
+
+namespace riscv {
+
+class CodeBudget::SizePlugin : public llvm::orc::ObjectLinkingLayer::Plugin {
+public:
+  explicit SizePlugin(std::shared_ptr<CodeBudget> Budget) : Budget(std::move(Budget)) {}
+
+  void modifyPassConfig(llvm::orc::MaterializationResponsibility& MR, llvm::jitlink::LinkGraph& G,
+                        llvm::jitlink::PassConfiguration& Config) override {
+    Config.PostAllocationPasses.push_back([this, &MR](llvm::jitlink::LinkGraph& Graph) {
+      size_t Bytes = 0;
+      for (auto* Block : Graph.blocks())
+        Bytes += Block->getSize();
+      return MR.withResourceKeyDo([&](llvm::orc::ResourceKey Key) { Budget->add(Key, Bytes); });
+    });
+  }
+
+  llvm::Error notifyFailed(llvm::orc::MaterializationResponsibility& MR) override {
+    return llvm::Error::success();
+  }
+
+  llvm::Error notifyRemovingResources(llvm::orc::JITDylib& JD, llvm::orc::ResourceKey Key) override {
+    Budget->remove(Key);
+    return llvm::Error::success();
+  }
+
+  void notifyTransferringResources(llvm::orc::JITDylib& JD, llvm::orc::ResourceKey Dst,
+                                   llvm::orc::ResourceKey Src) override {
+    Budget->transfer(Dst, Src);
+  }
+
+private:
+  std::shared_ptr<CodeBudget> Budget;
+};
+
+llvm::Expected<std::shared_ptr<CodeBudget>> CodeBudget::create(llvm::orc::LLJIT& JIT, size_t MaxBytes) {
+  auto* Linker = llvm::dyn_cast<llvm::orc::ObjectLinkingLayer>(&JIT.getObjLinkingLayer());
+  if (!Linker)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), "a code budget needs the JITLink object linking layer");
+  std::shared_ptr<CodeBudget> Budget(new CodeBudget(MaxBytes));
+  Linker->addPlugin(std::make_unique<SizePlugin>(Budget));
+  return Budget;
+}
+
+void CodeBudget::add(llvm::orc::ResourceKey Key, size_t Bytes) {
+  std::lock_guard<std::mutex> Lock(SizesMutex);
+  Sizes[Key] += Bytes;
+  size_t Now = Resident += Bytes;
+  if (Now > PeakResident)
+    PeakResident = Now;
+}
+
+void CodeBudget::remove(llvm::orc::ResourceKey Key) {
+  std::lock_guard<std::mutex> Lock(SizesMutex);
+  auto It = Sizes.find(Key);
+  if (It == Sizes.end())
+    return;
+  Resident -= It->second;
+  Sizes.erase(It);
+}
+
+void CodeBudget::transfer(llvm::orc::ResourceKey Dst, llvm::orc::ResourceKey Src) {
+  std::lock_guard<std::mutex> Lock(SizesMutex);
+  auto It = Sizes.find(Src);
+  if (It == Sizes.end())
+    return;
+  size_t Bytes = It->second;
+  Sizes.erase(It);
+  Sizes[Dst] += Bytes;
+}
+
+size_t CodeBudget::bytesOf(llvm::orc::ResourceTracker const& Tracker) const {
+  std::lock_guard<std::mutex> Lock(SizesMutex);
+  return Sizes.lookup(Tracker.getKeyUnsafe());
+}
+
+std::vector<uint32_t> CodeBudget::selectVictims(llvm::ArrayRef<EvictionCandidate> Candidates, uint64_t Now) const {
+  size_t LowWater = MaxBytes - MaxBytes / 4;
+  if (Resident <= LowWater)
+    return {};
+  // A is colder than B if A.ExecCount / (1 + Now - A.LastUse) is smaller,
+  // compared by cross-multiplying: this runs while the guest's FP
+  // environment is installed, so it must not use floating point.
+  auto Colder = [Now](EvictionCandidate const& A, EvictionCandidate const& B) {
+    return static_cast<unsigned __int128>(A.ExecCount) * (1 + Now - B.LastUse) <
+           static_cast<unsigned __int128>(B.ExecCount) * (1 + Now - A.LastUse);
+  };
+  std::vector<EvictionCandidate> Sorted(Candidates.begin(), Candidates.end());
+  std::sort(Sorted.begin(), Sorted.end(), Colder);
+
+  std::vector<uint32_t> Victims;
+  size_t ToFree = Resident - LowWater;
+  for (auto const& C : Sorted) {
+    if (!ToFree)
+      break;
+    if (!C.Bytes)
+      continue;
+    Victims.push_back(C.PC);
+    ToFree -= std::min(ToFree, C.Bytes);
+  }
+  return Victims;
+}
+
+llvm::Error CodeBudget::evict(llvm::orc::ResourceTracker& Tracker) {
+  size_t Bytes = bytesOf(Tracker);
+  if (auto Err = Tracker.remove())
+    return Err;
+  ++Evictions;
+  EvictedBytes += Bytes;
+  return llvm::Error::success();
+}
+
+void CodeBudget::printStats(llvm::raw_ostream& OS) const {
+  OS << "code budget: " << Resident << " of " << MaxBytes << " bytes resident (peak " << PeakResident << "), "
+     << Evictions << " translations evicted (" << EvictedBytes << " bytes)\n";
+}
+
+} // end namespace riscv
@@ -0,0 +1,122 @@
+#include "CodeCache.h"
+#include "Aot.h"
+#include "Memory.h"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/SHA1.h>
+
+namespace riscv {
+
+namespace {
+
+constexpr llvm::StringLiteral ModulePrefix = "dbtcache:";
+
+} // end anonymous namespace
+
+llvm::Expected<std::unique_ptr<CodeCache>> CodeCache::create(llvm::StringRef Directory, llvm::StringRef ElfPath) {
+  if (std::error_code EC = llvm::sys::fs::create_directories(Directory))
+    return llvm::createFileError(Directory, EC);
+  auto ElfHash = hashFile(ElfPath);
+  if (!ElfHash)
+    return ElfHash.takeError();
+  return std::unique_ptr<CodeCache>(new CodeCache(Directory.str(), *ElfHash));
+}
+
+CodeCache::CodeCache(std::string Directory, std::array<uint8_t, 20> ElfHash)
+    : Directory(std::move(Directory)), ElfHash(ElfHash) {}
+
+std::string CodeCache::key(llvm::StringRef Kind, llvm::ArrayRef<CodeRange> Ranges, MemoryManager* Source) const {
+  llvm::SHA1 Hasher;
+  Hasher.update(ElfHash);
+  auto AddWord = [&](uint32_t Value) {
+    uint8_t Bytes[4];
+    llvm::support::endian::write32le(Bytes, Value);
+    Hasher.update(Bytes);
+  };
+  AddWord(TranslatorVersion);
+  Hasher.update(Kind);
+  for (CodeRange const& Range : Ranges) {
+    AddWord(Range.Begin);
+    AddWord(Range.End);
+    for (uint32_t Addr = Range.Begin; Addr < Range.End; ++Addr) {
+      uint8_t Byte = read8(Source, Addr);
+      Hasher.update(Byte);
+    }
+  }
+  return llvm::toHex(Hasher.final(), /*LowerCase=*/true);
+}
+
+std::string CodeCache::moduleName(llvm::StringRef Key) {
+  return (ModulePrefix + Key).str();
+}
+
+std::string CodeCache::symbolName(llvm::StringRef Key) {
+  return ("cached_" + Key).str();
+}
+
+bool CodeCache::claim(llvm::StringRef Key, llvm::orc::JITDylib& JD, llvm::orc::ResourceTrackerSP& Tracker) {
+  std::lock_guard<std::mutex> Lock(ClaimedMutex);
+  Claim& Entry = Claimed[Key];
+  bool First = Entry.Users++ == 0;
+  if (First)
+    Entry.Tracker = JD.createResourceTracker();
+  Tracker = Entry.Tracker;
+  return First;
+}
+
+bool CodeCache::release(llvm::StringRef Key) {
+  std::lock_guard<std::mutex> Lock(ClaimedMutex);
+  auto It = Claimed.find(Key);
+  if (It == Claimed.end() || --It->second.Users > 0)
+    return false;
+  Claimed.erase(It);
+  return true;
+}
+
+std::string CodeCache::path(llvm::StringRef Key) const {
+  llvm::SmallString<128> Path(Directory);
+  llvm::sys::path::append(Path, Key + ".o");
+  return Path.str().str();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CodeCache::find(llvm::StringRef Key) {
+  auto Object = llvm::MemoryBuffer::getFile(path(Key), /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!Object) {
+    ++Misses;
+    return nullptr;
+  }
+  ++Hits;
+  return std::move(*Object);
+}
+
+void CodeCache::notifyObjectCompiled(llvm::Module const* M, llvm::MemoryBufferRef Obj) {
+  llvm::StringRef Name = M->getModuleIdentifier();
+  if (!Name.consume_front(ModulePrefix))
+    return;
+  // Written to a temporary and renamed, so concurrent runs never see a
+  // partial object. A failed write only costs a recompile next time.
+  llvm::Error Err = llvm::writeToOutput(path(Name), [&](llvm::raw_ostream& OS) {
+    OS << Obj.getBuffer();
+    return llvm::Error::success();
+  });
+  if (Err) {
+    llvm::consumeError(std::move(Err));
+    return;
+  }
+  ++Stores;
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CodeCache::getObject(llvm::Module const* M) {
+  // Hits are loaded with addObjectFile before any IR is built; a module that
+  // reaches the compiler was a miss.
+  return nullptr;
+}
+
+void CodeCache::printStats(llvm::raw_ostream& OS) const {
+  OS << "code cache: " << Hits << " hits, " << Misses << " misses, " << Stores << " objects stored\n";
+}
+
+} // end namespace riscv
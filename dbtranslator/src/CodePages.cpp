@@ -0,0 +1,38 @@
+#include "CodePages.h"
+
+namespace riscv {
+
+void CodePageMap::add(uint32_t EntryPC, llvm::ArrayRef<CodeRange> Ranges) {
+  for (CodeRange const& Range : Ranges) {
+    if (Range.Begin == Range.End)
+      continue;
+    uint32_t First = Range.Begin >> GuestPageShift;
+    uint32_t Last = (Range.End - 1) >> GuestPageShift;
+    for (uint32_t Page = First; Page <= Last; ++Page) {
+      std::vector<uint32_t>& Entries = PageEntries[Page];
+      if (Entries.empty() || Entries.back() != EntryPC)
+        Entries.push_back(EntryPC);
+      setPage(Manager->CodePages, Page);
+      setPage(Manager->WatchedPages, Page);
+    }
+  }
+}
+
+std::vector<uint32_t> CodePageMap::takeInvalidated() {
+  std::atomic_ref<uint32_t>(Manager->CodeWritten).exchange(0, std::memory_order_acquire);
+  std::vector<uint32_t> Result;
+  for (auto It = PageEntries.begin(); It != PageEntries.end();) {
+    if (!testPage(Manager->WrittenCodePages, It->first)) {
+      ++It;
+      continue;
+    }
+    clearPage(Manager->CodePages, It->first);
+    clearPage(Manager->WrittenCodePages, It->first);
+    updateWatch(Manager, It->first);
+    Result.insert(Result.end(), It->second.begin(), It->second.end());
+    It = PageEntries.erase(It);
+  }
+  return Result;
+}
+
+} // end namespace riscv
@@ -0,0 +1,205 @@
+#include "Compressed.h"
+
+namespace riscv {
+
+namespace {
+
+uint32_t bits(uint32_t Value, unsigned High, unsigned Low) {
+  return (Value >> Low) & ((1U << (High - Low + 1)) - 1);
+}
+
+uint32_t signExtend(uint32_t Value, unsigned Width) {
+  uint32_t Sign = 1U << (Width - 1);
+  return (Value ^ Sign) - Sign;
+}
+
+// x8..x15, the registers the three-bit fields name.
+uint32_t popularReg(uint32_t Field) { return Field + 8; }
+
+uint32_t encodeR(uint32_t Opcode, uint32_t Rd, uint32_t Funct3, uint32_t Rs1, uint32_t Rs2, uint32_t Funct7) {
+  return Funct7 << 25 | Rs2 << 20 | Rs1 << 15 | Funct3 << 12 | Rd << 7 | Opcode;
+}
+
+uint32_t encodeI(uint32_t Opcode, uint32_t Rd, uint32_t Funct3, uint32_t Rs1, uint32_t Imm) {
+  return (Imm & 0xFFF) << 20 | Rs1 << 15 | Funct3 << 12 | Rd << 7 | Opcode;
+}
+
+uint32_t encodeS(uint32_t Opcode, uint32_t Funct3, uint32_t Rs1, uint32_t Rs2, uint32_t Imm) {
+  return bits(Imm, 11, 5) << 25 | Rs2 << 20 | Rs1 << 15 | Funct3 << 12 | bits(Imm, 4, 0) << 7 | Opcode;
+}
+
+uint32_t encodeB(uint32_t Funct3, uint32_t Rs1, uint32_t Rs2, uint32_t Imm) {
+  return bits(Imm, 12, 12) << 31 | bits(Imm, 10, 5) << 25 | Rs2 << 20 | Rs1 << 15 | Funct3 << 12 |
+         bits(Imm, 4, 1) << 8 | bits(Imm, 11, 11) << 7 | 0x63;
+}
+
+uint32_t encodeJ(uint32_t Rd, uint32_t Imm) {
+  return bits(Imm, 20, 20) << 31 | bits(Imm, 10, 1) << 21 | bits(Imm, 11, 11) << 20 | bits(Imm, 19, 12) << 12 |
+         Rd << 7 | 0x6F;
+}
+
+constexpr uint32_t OpImm = 0x13, Op = 0x33, Load = 0x03, Store = 0x23, Lui = 0x37, Jalr = 0x67;
+constexpr uint32_t LoadFP = 0x07, StoreFP = 0x27;
+
+// CJ-format offset of C.J and C.JAL.
+uint32_t jumpOffset(uint32_t H) {
+  uint32_t Offset = bits(H, 12, 12) << 11 | bits(H, 11, 11) << 4 | bits(H, 10, 9) << 8 | bits(H, 8, 8) << 10 |
+                    bits(H, 7, 7) << 6 | bits(H, 6, 6) << 7 | bits(H, 5, 3) << 1 | bits(H, 2, 2) << 5;
+  return signExtend(Offset, 12);
+}
+
+// CB-format offset of C.BEQZ and C.BNEZ.
+uint32_t branchOffset(uint32_t H) {
+  uint32_t Offset = bits(H, 12, 12) << 8 | bits(H, 11, 10) << 3 | bits(H, 6, 5) << 6 | bits(H, 4, 3) << 1 |
+                    bits(H, 2, 2) << 5;
+  return signExtend(Offset, 9);
+}
+
+// Six-bit immediate split over bit 12 and bits 6:2.
+uint32_t smallImmediate(uint32_t H) {
+  return signExtend(bits(H, 12, 12) << 5 | bits(H, 6, 2), 6);
+}
+
+uint32_t expandQuadrant0(uint32_t H) {
+  uint32_t RdP = popularReg(bits(H, 4, 2));
+  uint32_t Rs1P = popularReg(bits(H, 9, 7));
+  uint32_t WordOffset = bits(H, 12, 10) << 3 | bits(H, 6, 6) << 2 | bits(H, 5, 5) << 6;
+  uint32_t DoubleOffset = bits(H, 12, 10) << 3 | bits(H, 6, 5) << 6;
+  switch (bits(H, 15, 13)) {
+    case 0x0: { // C.ADDI4SPN
+      uint32_t Imm = bits(H, 12, 11) << 4 | bits(H, 10, 7) << 6 | bits(H, 6, 6) << 2 | bits(H, 5, 5) << 3;
+      return Imm ? encodeI(OpImm, RdP, 0x0, 2, Imm) : 0;
+    }
+    case 0x1: // C.FLD
+      return encodeI(LoadFP, RdP, 0x3, Rs1P, DoubleOffset);
+    case 0x2: // C.LW
+      return encodeI(Load, RdP, 0x2, Rs1P, WordOffset);
+    case 0x3: // C.FLW
+      return encodeI(LoadFP, RdP, 0x2, Rs1P, WordOffset);
+    case 0x5: // C.FSD
+      return encodeS(StoreFP, 0x3, Rs1P, RdP, DoubleOffset);
+    case 0x6: // C.SW
+      return encodeS(Store, 0x2, Rs1P, RdP, WordOffset);
+    case 0x7: // C.FSW
+      return encodeS(StoreFP, 0x2, Rs1P, RdP, WordOffset);
+  }
+  return 0;
+}
+
+uint32_t expandQuadrant1(uint32_t H) {
+  uint32_t Rd = bits(H, 11, 7);
+  uint32_t RdP = popularReg(bits(H, 9, 7));
+  uint32_t Rs2P = popularReg(bits(H, 4, 2));
+  switch (bits(H, 15, 13)) {
+    case 0x0: // C.ADDI, C.NOP
+      return encodeI(OpImm, Rd, 0x0, Rd, smallImmediate(H));
+    case 0x1: // C.JAL
+      return encodeJ(1, jumpOffset(H));
+    case 0x2: // C.LI
+      return encodeI(OpImm, Rd, 0x0, 0, smallImmediate(H));
+    case 0x3:
+      if (Rd == 2) { // C.ADDI16SP
+        uint32_t Imm = bits(H, 12, 12) << 9 | bits(H, 6, 6) << 4 | bits(H, 5, 5) << 6 | bits(H, 4, 3) << 7 |
+                       bits(H, 2, 2) << 5;
+        return Imm ? encodeI(OpImm, 2, 0x0, 2, signExtend(Imm, 10)) : 0;
+      }
+      // C.LUI
+      if (!smallImmediate(H))
+        return 0;
+      return smallImmediate(H) << 12 | Rd << 7 | Lui;
+    case 0x4:
+      switch (bits(H, 11, 10)) {
+        case 0x0: // C.SRLI
+          return bits(H, 12, 12) ? 0 : encodeI(OpImm, RdP, 0x5, RdP, bits(H, 6, 2));
+        case 0x1: // C.SRAI
+          return bits(H, 12, 12) ? 0 : encodeI(OpImm, RdP, 0x5, RdP, 0x400 | bits(H, 6, 2));
+        case 0x2: // C.ANDI
+          return encodeI(OpImm, RdP, 0x7, RdP, smallImmediate(H));
+        case 0x3:
+          if (bits(H, 12, 12))
+            return 0;
+          switch (bits(H, 6, 5)) {
+            case 0x0: return encodeR(Op, RdP, 0x0, RdP, Rs2P, 0x20); // C.SUB
+            case 0x1: return encodeR(Op, RdP, 0x4, RdP, Rs2P, 0x00); // C.XOR
+            case 0x2: return encodeR(Op, RdP, 0x6, RdP, Rs2P, 0x00); // C.OR
+            case 0x3: return encodeR(Op, RdP, 0x7, RdP, Rs2P, 0x00); // C.AND
+          }
+      }
+      return 0;
+    case 0x5: // C.J
+      return encodeJ(0, jumpOffset(H));
+    case 0x6: // C.BEQZ
+      return encodeB(0x0, RdP, 0, branchOffset(H));
+    case 0x7: // C.BNEZ
+      return encodeB(0x1, RdP, 0, branchOffset(H));
+  }
+  return 0;
+}
+
+uint32_t expandQuadrant2(uint32_t H) {
+  uint32_t Rd = bits(H, 11, 7);
+  uint32_t Rs2 = bits(H, 6, 2);
+  switch (bits(H, 15, 13)) {
+    case 0x0: // C.SLLI
+      return bits(H, 12, 12) ? 0 : encodeI(OpImm, Rd, 0x1, Rd, Rs2);
+    case 0x1: { // C.FLDSP
+      uint32_t Offset = bits(H, 12, 12) << 5 | bits(H, 6, 5) << 3 | bits(H, 4, 2) << 6;
+      return encodeI(LoadFP, Rd, 0x3, 2, Offset);
+    }
+    case 0x2: { // C.LWSP
+      uint32_t Offset = bits(H, 12, 12) << 5 | bits(H, 6, 4) << 2 | bits(H, 3, 2) << 6;
+      return Rd ? encodeI(Load, Rd, 0x2, 2, Offset) : 0;
+    }
+    case 0x3: { // C.FLWSP
+      uint32_t Offset = bits(H, 12, 12) << 5 | bits(H, 6, 4) << 2 | bits(H, 3, 2) << 6;
+      return encodeI(LoadFP, Rd, 0x2, 2, Offset);
+    }
+    case 0x4:
+      if (!bits(H, 12, 12)) {
+        if (Rs2) // C.MV
+          return encodeR(Op, Rd, 0x0, 0, Rs2, 0x00);
+        return Rd ? encodeI(Jalr, 0, 0x0, Rd, 0) : 0; // C.JR
+      }
+      if (Rs2) // C.ADD
+        return encodeR(Op, Rd, 0x0, Rd, Rs2, 0x00);
+      if (Rd) // C.JALR
+        return encodeI(Jalr, 1, 0x0, Rd, 0);
+      return 0x00100073; // C.EBREAK
+    case 0x5: { // C.FSDSP
+      uint32_t Offset = bits(H, 12, 10) << 3 | bits(H, 9, 7) << 6;
+      return encodeS(StoreFP, 0x3, 2, Rs2, Offset);
+    }
+    case 0x6: { // C.SWSP
+      uint32_t Offset = bits(H, 12, 9) << 2 | bits(H, 8, 7) << 6;
+      return encodeS(Store, 0x2, 2, Rs2, Offset);
+    }
+    case 0x7: { // C.FSWSP
+      uint32_t Offset = bits(H, 12, 9) << 2 | bits(H, 8, 7) << 6;
+      return encodeS(StoreFP, 0x2, 2, Rs2, Offset);
+    }
+  }
+  return 0;
+}
+
+} // end anonymous namespace
+
+uint32_t expandCompressed(uint16_t Half) {
+  switch (Half & 0x3) {
+    case 0x0: return expandQuadrant0(Half);
+    case 0x1: return expandQuadrant1(Half);
+    case 0x2: return expandQuadrant2(Half);
+  }
+  return 0;
+}
+
+// Code is only 2-byte aligned once compressed instructions are mixed in, so
+// a 32-bit instruction is read as two half-words.
+uint32_t fetchInstruction(MemoryManager* Manager, uint32_t PC, uint32_t& Length) {
+  uint16_t Low = read16(Manager, PC);
+  Length = instructionLength(Low);
+  if (Length == 2)
+    return expandCompressed(Low);
+  return Low | uint32_t(read16(Manager, PC + 2)) << 16;
+}
+
+} // end namespace riscv
@@ -0,0 +1,49 @@
+#include "Coverage.h"
+#include <algorithm>
+#include <cstdlib>
+#include <llvm/ExecutionEngine/Orc/AbsoluteSymbols.h>
+#include <sys/shm.h>
+
+namespace riscv {
+
+namespace {
+
+uint8_t LocalMap[CoverageMapSize];
+uint32_t Prev = 0;
+
+uint8_t* attachMap() {
+  if (char const* Id = std::getenv("__AFL_SHM_ID")) {
+    void* Shared = shmat(std::atoi(Id), nullptr, 0);
+    if (Shared != reinterpret_cast<void*>(-1))
+      return static_cast<uint8_t*>(Shared);
+  }
+  return LocalMap;
+}
+
+} // end anonymous namespace
+
+uint8_t* coverageMap() {
+  static uint8_t* Map = attachMap();
+  return Map;
+}
+
+llvm::Error addCoverageRuntime(llvm::orc::LLJIT& JIT) {
+  auto Symbol = [](void* Address) {
+    return llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(Address), llvm::JITSymbolFlags::Exported);
+  };
+  return JIT.getMainJITDylib().define(llvm::orc::absoluteSymbols({
+      {JIT.mangleAndIntern(CoverageMapSymbol), Symbol(coverageMap())},
+      {JIT.mangleAndIntern(CoveragePrevSymbol), Symbol(&Prev)},
+  }));
+}
+
+void resetCoveragePath() {
+  Prev = 0;
+}
+
+size_t countCoveredEdges() {
+  uint8_t const* Map = coverageMap();
+  return CoverageMapSize - std::count(Map, Map + CoverageMapSize, 0);
+}
+
+} // end namespace riscv
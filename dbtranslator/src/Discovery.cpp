@@ -0,0 +1,96 @@
+#include "Discovery.h"
+#include "Compressed.h"
+#include "Fusion.h"
+#include "Instruction.h"
+#include "JumpTable.h"
+#include <algorithm>
+#include <unordered_set>
+
+namespace riscv {
+
+namespace {
+
+bool isExecutable(ElfCodeInfo const& Info, uint32_t PC) {
+  for (auto const& Region : Info.ExecutableRegions) {
+    if (Region.Begin <= PC && PC + 2 <= Region.End)
+      return true;
+  }
+  return false;
+}
+
+} // end anonymous namespace
+
+std::vector<DiscoveredBlock> discoverBlocks(MemoryManager* Manager, ElfCodeInfo const& Info, size_t Threshold) {
+  std::vector<DiscoveredBlock> Result;
+  std::unordered_set<uint32_t> Visited;
+  std::vector<uint32_t> Worklist{Info.EntryPoint};
+  Worklist.insert(Worklist.end(), Info.FunctionSymbols.begin(), Info.FunctionSymbols.end());
+
+  while (!Worklist.empty()) {
+    uint32_t Start = Worklist.back();
+    Worklist.pop_back();
+    if (!isExecutable(Info, Start) || !Visited.insert(Start).second)
+      continue;
+
+    uint32_t PC = Start;
+    uint32_t NumInstrs = 0;
+    bool Continue = true;
+    // The instruction before PC in this block, for far calls and jumps.
+    Instr Previous = Instr::UNKNOWN;
+    uint32_t PreviousData = 0;
+    uint32_t PreviousPC = 0;
+    while (Continue && NumInstrs < Threshold && isExecutable(Info, PC)) {
+      uint32_t Length;
+      uint32_t InstructionData = fetchInstruction(Manager, PC, Length);
+      uint32_t RegDest = regDest(InstructionData);
+      ++NumInstrs;
+      Instr CurrentInstruction = decode(InstructionData);
+      switch (CurrentInstruction) {
+        case Instr::BEQ:
+        case Instr::BNE:
+        case Instr::BLT:
+        case Instr::BGE:
+        case Instr::BLTU:
+        case Instr::BGEU:
+          Worklist.push_back(PC + immediate(CurrentInstruction, InstructionData));
+          Worklist.push_back(PC + Length);
+          Continue = false;
+          break;
+        case Instr::JAL:
+          Worklist.push_back(PC + immediate(CurrentInstruction, InstructionData));
+          if (RegDest != 0)
+            Worklist.push_back(PC + Length);
+          Continue = false;
+          break;
+        case Instr::JALR:
+          if (auto Target = fusedJumpTarget(Previous, PreviousData, PreviousPC, CurrentInstruction, InstructionData))
+            Worklist.push_back(*Target);
+          if (auto Table = findJumpTable(Manager, Info, Start, NumInstrs))
+            Worklist.insert(Worklist.end(), Table->Targets.begin(), Table->Targets.end());
+          if (RegDest != 0)
+            Worklist.push_back(PC + Length);
+          Continue = false;
+          break;
+        case Instr::ECALL:
+          Worklist.push_back(PC + Length);
+          Continue = false;
+          break;
+        default:
+          break;
+      }
+      Previous = CurrentInstruction;
+      PreviousData = InstructionData;
+      PreviousPC = PC;
+      PC += Length;
+    }
+    if (Continue && NumInstrs == Threshold)
+      Worklist.push_back(PC);
+    Result.push_back({Start, NumInstrs});
+  }
+
+  std::sort(Result.begin(), Result.end(),
+            [](DiscoveredBlock const& L, DiscoveredBlock const& R) { return L.PC < R.PC; });
+  return Result;
+}
+
+} // end namespace riscv
@@ -0,0 +1,1050 @@
+#include "Engine.h"
+#include "Aot.h"
+#include "Binary.h"
+#include "Compressed.h"
+#include "Coverage.h"
+#include "FloatEnv.h"
+#include "Harts.h"
+#include "Libc.h"
+#include "MemoryRuntime.h"
+#include "Snapshot.h"
+#include "Syscall.h"
+#include "Translator.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/ScopeExit.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SHA1.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/TargetSelect.h>
+
+using namespace llvm;
+using namespace llvm::orc;
+
+namespace riscv {
+
+// A block can be translated more than once (tier-up, resizing, regions), so
+// every translation gets its own symbol.
+static std::atomic<uint64_t> NextTranslationId = 0;
+
+static CodeRange blockRange(MemoryManager* Manager, uint32_t PC, size_t NumInstrs) {
+  return {PC, blockEnd(Manager, PC, NumInstrs)};
+}
+
+// `j .` (jal x0, 0, or its compressed form): bare-metal guests park here
+// once they are done.
+static bool isHaltLoop(MemoryManager* Manager, uint32_t PC) {
+  uint32_t Length;
+  return fetchInstruction(Manager, PC, Length) == 0x0000006F;
+}
+
+// Stack given to each hart of a guest below the previous one's.
+static constexpr uint32_t HartStackBytes = 1 << 20;
+
+// Instructions a region may run before it leaves at a back-edge, so that the
+// dispatcher still sees instruction limits, code writes and stop requests.
+static constexpr uint32_t RegionInstrBudget = 1 << 16;
+
+// Runs translated code and returns the instructions it executed: NumInstrs
+// for a block, its own count for a region.
+static uint64_t runCode(BlockFunc Code, CPUState& State, size_t NumInstrs, uint64_t Remaining) {
+  State.RegionInstrs = 0;
+  State.RegionBudget = std::min<uint64_t>(Remaining, RegionInstrBudget);
+  Code(&State);
+  return State.RegionInstrs ? State.RegionInstrs : NumInstrs;
+}
+
+Engine::Engine(Options Opts, std::string ElfPath) : Opts(std::move(Opts)), ElfPath(std::move(ElfPath)) {}
+
+Engine::~Engine() {
+  DefaultGuest.reset();
+  consumeError(installRegions(true));
+  consumeError(dropTranslations(Translated));
+  consumeError(freeRetired());
+}
+
+// Without MemoryImpl the memory helpers resolve to the ones built into the
+// library; otherwise to the given LLVM IR implementation.
+Expected<std::unique_ptr<Engine>> Engine::create(Options Opts, StringRef ElfPath) {
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+  InitializeNativeTargetAsmParser();
+
+  std::unique_ptr<Engine> Result(new Engine(std::move(Opts), ElfPath.str()));
+  Engine& E = *Result;
+  auto ImageOrErr = GuestImage::create(ElfPath);
+  if (!ImageOrErr)
+    return ImageOrErr.takeError();
+  E.Image = std::move(*ImageOrErr);
+  if (E.Opts.CodeCacheDir) {
+    auto CacheOrErr = CodeCache::create(*E.Opts.CodeCacheDir, ElfPath);
+    if (!CacheOrErr)
+      return CacheOrErr.takeError();
+    E.Cache = std::move(*CacheOrErr);
+  }
+  // Objects built with different code generation options must not be
+  // loaded for each other from the code cache.
+  auto PrefixOrErr = optionsPrefix(E.Opts.Coverage, E.Opts.InlineMemory, E.Opts.MemoryImpl);
+  if (!PrefixOrErr)
+    return PrefixOrErr.takeError();
+  E.KindPrefix = std::move(*PrefixOrErr);
+
+  LLJITBuilder Builder;
+  Builder.setSupportConcurrentCompilation(true);
+  if (CodeCache* Cache = E.Cache.get()) {
+    Builder.setCompileFunctionCreator([Cache](JITTargetMachineBuilder JTMB) -> Expected<std::unique_ptr<IRCompileLayer::IRCompiler>> {
+      return std::make_unique<ConcurrentIRCompiler>(std::move(JTMB), Cache);
+    });
+  }
+  auto JITOrErr = Builder.create();
+  if (!JITOrErr)
+    return JITOrErr.takeError();
+  E.JIT = std::move(*JITOrErr);
+  if (!E.Opts.MemoryImpl) {
+    if (auto Err = addHostMemoryRuntime(*E.JIT))
+      return std::move(Err);
+  } else {
+    auto CtxPtr = std::make_unique<LLVMContext>();
+    SMDiagnostic Diag;
+    auto M = parseIRFile(*E.Opts.MemoryImpl, Diag, *CtxPtr);
+    if (!M)
+      return createStringError(inconvertibleErrorCode(), "%s: %s", E.Opts.MemoryImpl->c_str(), Diag.getMessage().str().c_str());
+    optimizeModule(*M);
+    if (auto Err = E.JIT->addIRModule(ThreadSafeModule(std::move(M), std::move(CtxPtr))))
+      return std::move(Err);
+  }
+
+  if (auto Err = addHostSyscalls(*E.JIT))
+    return std::move(Err);
+  if (auto Err = addHostFloatRuntime(*E.JIT))
+    return std::move(Err);
+  if (auto Err = addHostHartRuntime(*E.JIT))
+    return std::move(Err);
+
+  if (E.Opts.Libc) {
+    if (auto Err = addHostLibc(*E.JIT))
+      return std::move(Err);
+    for (LibcFunction const& Function : findLibcFunctions(E.Image->memory(), E.Image->codeInfo())) {
+      bool Known = E.Opts.LibcHashes.empty() || is_contained(E.Opts.LibcHashes, Function.Hash);
+      if (E.Opts.DebugMode)
+        errs() << "libc: " << libcName(Function.Routine) << " at " << format_hex(Function.Address, 10) << ", hash "
+               << format_hex(Function.Hash, 18) << (Known ? "" : " (not replaced)") << "\n";
+      if (Known)
+        E.LibcEntries.insert({Function.Address, Function.Routine});
+    }
+  }
+  // Translations of a replaced entry call the host routine, so which entries
+  // are replaced is part of the kind as well.
+  if (!E.LibcEntries.empty()) {
+    std::vector<std::pair<uint32_t, LibcRoutine>> Entries(E.LibcEntries.begin(), E.LibcEntries.end());
+    llvm::sort(Entries);
+    SHA1 Hasher;
+    for (auto [Address, Routine] : Entries) {
+      uint8_t Entry[5] = {uint8_t(Address), uint8_t(Address >> 8), uint8_t(Address >> 16), uint8_t(Address >> 24),
+                          uint8_t(Routine)};
+      Hasher.update(Entry);
+    }
+    E.KindPrefix += "libc" + toHex(ArrayRef<uint8_t>(Hasher.final()).take_front(8), /*LowerCase=*/true) + "-";
+  }
+
+  if (E.Opts.CodeBudget) {
+    auto BudgetOrErr = CodeBudget::create(*E.JIT, E.Opts.CodeBudget);
+    if (!BudgetOrErr)
+      return BudgetOrErr.takeError();
+    E.Budget = std::move(*BudgetOrErr);
+  }
+  if (E.Opts.Coverage) {
+    if (auto Err = addCoverageRuntime(*E.JIT))
+      return std::move(Err);
+  }
+
+  // Baseline code carries no coverage instrumentation, and its stencils call
+  // the built-in memory helpers, not MemoryImpl.
+  if (E.Opts.Baseline && !E.Opts.Coverage && !E.Opts.MemoryImpl)
+    E.Baseline = std::make_unique<BaselineCompiler>();
+  if (E.Opts.AdaptiveBlockSize || !E.Opts.BlockSizeOverrides.empty() || E.Opts.BlockSizeReport) {
+    BlockSizer::Options SizerOpts;
+    // Without adaptive sizing only the overrides apply.
+    if (!E.Opts.AdaptiveBlockSize)
+      SizerOpts.MinInstrs = SizerOpts.MaxInstrs = E.Opts.Threshold;
+    E.Sizer = std::make_unique<BlockSizer>(SizerOpts);
+    for (auto const& Override : E.Opts.BlockSizeOverrides)
+      E.Sizer->addOverride(Override.Begin, Override.End, Override.Limit);
+  }
+  return std::move(Result);
+}
+
+// Builds one function named FuncName whose body Emit writes, and adds it to
+// the JIT under Tracker.
+Error Engine::buildFunction(ResourceTrackerSP Tracker, StringRef ModuleName, StringRef FuncName, function_ref<void(IRData&)> Emit) {
+  auto CtxPtr = std::make_unique<LLVMContext>();
+  auto MPtr = std::make_unique<Module>(ModuleName, *CtxPtr);
+  LLVMContext& Ctx = *CtxPtr;
+
+  auto *FnTy = FunctionType::get(Type::getVoidTy(Ctx), {getCPUStatePointerType(Ctx)}, false);
+  auto *F = Function::Create(FnTy, Function::ExternalLinkage, FuncName, MPtr.get());
+
+  IRBuilder<> B{Ctx};
+  B.SetInsertPoint(BasicBlock::Create(Ctx, "entry", F));
+  IRData IRData_{*MPtr, B, F};
+  addMemoryInterface(IRData_);
+  IRData_.CodeInfo = &Image->codeInfo();
+  if (!LibcEntries.empty())
+    IRData_.Libc = &LibcEntries;
+  if (Opts.Coverage)
+    addCoverage(IRData_);
+  Emit(IRData_);
+  if (Opts.InlineMemory) {
+    if (auto Err = linkMemoryRuntime(*MPtr))
+      return Err;
+  }
+  optimizeModule(*MPtr);
+  if (Opts.DebugMode)
+    MPtr->dump();
+  return JIT->addIRModule(std::move(Tracker), ThreadSafeModule(std::move(MPtr), std::move(CtxPtr)));
+}
+
+// Returns the entry point of a translation covering Ranges of the guest code
+// in Source whose body Emit writes. With a code cache, Emit only runs when
+// the cache has no object for the translation. The kind names, prefixed
+// with KindPrefix, keep objects built with different options apart in the
+// code cache.
+Expected<Engine::Translation> Engine::lookupOrBuild(StringRef Kind, MemoryManager* Source, ArrayRef<CodeRange> Ranges,
+                                                    function_ref<void(IRData&)> Emit) {
+  std::string FullKind = (Twine(KindPrefix) + Kind).str();
+  Translation Result;
+  std::string FuncName;
+  if (!Cache) {
+    std::string Suffix = std::to_string(Ranges.front().Begin) + "_" + std::to_string(NextTranslationId++);
+    FuncName = FullKind + "_" + Suffix;
+    Result.Tracker = JIT->getMainJITDylib().createResourceTracker();
+    if (auto Err = buildFunction(Result.Tracker, "Module " + Suffix, FuncName, Emit))
+      return std::move(Err);
+  } else {
+    Result.CacheKey = Cache->key(FullKind, Ranges, Source);
+    FuncName = CodeCache::symbolName(Result.CacheKey);
+    if (Cache->claim(Result.CacheKey, JIT->getMainJITDylib(), Result.Tracker)) {
+      Error Err = Error::success();
+      if (auto Object = Cache->find(Result.CacheKey))
+        Err = JIT->addObjectFile(Result.Tracker, std::move(Object));
+      else
+        Err = buildFunction(Result.Tracker, CodeCache::moduleName(Result.CacheKey), FuncName, Emit);
+      if (Err) {
+        Cache->release(Result.CacheKey);
+        return std::move(Err);
+      }
+    }
+  }
+  auto Addr = JIT->lookup(FuncName);
+  if (!Addr) {
+    if (auto Err = removeCode(Result))
+      return joinErrors(Addr.takeError(), std::move(Err));
+    return Addr.takeError();
+  }
+  Result.Code = Addr->toPtr<BlockFunc>();
+  return std::move(Result);
+}
+
+// Translates the block at PC from the guest code in Source: the image for
+// shared translations, a guest's own memory for private ones.
+Expected<Engine::Translation> Engine::translateOptimized(MemoryManager* Source, uint32_t PC, size_t Threshold,
+                                                         size_t* NumInstrsOut) {
+  size_t NumInstrs = blockLength(Source, PC, Threshold);
+  if (NumInstrsOut)
+    *NumInstrsOut = NumInstrs;
+  return lookupOrBuild("block", Source, {blockRange(Source, PC, NumInstrs)}, [&](IRData& Data) {
+    emitBlock(Data, Source, PC, NumInstrs);
+    Data.Builder.CreateRetVoid();
+  });
+}
+
+// Recompiles a hot region as one function. Runs on its own thread while the
+// guests keep executing the existing blocks. Regions are only formed from
+// shared translations, whose code in the image never changes.
+Expected<Engine::Translation> Engine::compileRegion(std::vector<RegionBlock> Blocks, std::vector<CodeRange> Ranges) {
+  return lookupOrBuild("region", Image->memory(), Ranges,
+                       [&](IRData& Data) { buildRegion(Data, Image->memory(), Blocks); });
+}
+
+// Translates the block at PC in tier T, sized by the block sizer when there
+// is one and by the fixed threshold otherwise. Falls back to LLVM when there
+// is no baseline compiler or its code buffer is full.
+Expected<Engine::TranslatedBlock> Engine::translate(MemoryManager* Source, uint32_t PC, Tier T, uint64_t ExecCount) {
+  // Only LLVM translations call the host C library routines.
+  if (!Baseline || LibcEntries.count(PC))
+    T = Tier::Optimized;
+  // Translation runs while the guest's FP environment is installed.
+  HostFloatScope FloatScope;
+  TranslatedBlock Result;
+  Result.ExecCount = ExecCount;
+  Result.Halts = isHaltLoop(Source, PC);
+  Result.Limit = Sizer ? Sizer->limitFor(PC, ExecCount, T) : Opts.Threshold;
+
+  auto Start = std::chrono::steady_clock::now();
+  if (T == Tier::Baseline)
+    Result.Code = Baseline->compile(PC, Source, Result.Limit, &Result.NumInstrs);
+  if (!Result.Code) {
+    T = Tier::Optimized;
+    auto Code = translateOptimized(Source, PC, Result.Limit, &Result.NumInstrs);
+    if (!Code)
+      return Code.takeError();
+    Result.Code = Code->Code;
+    Result.Tracker = std::move(Code->Tracker);
+    Result.CacheKey = std::move(Code->CacheKey);
+    Result.Optimized = true;
+  }
+  if (Sizer)
+    Sizer->recordCompile(PC, Result.NumInstrs, std::chrono::steady_clock::now() - Start, T);
+  return Result;
+}
+
+// Translates Blocks from Source with LLVM on the warm-up threads before the
+// guest runs, so the dispatcher finds all of them already compiled. Blocks
+// already in Map are skipped.
+Error Engine::translateAhead(MemoryManager* Source, ArrayRef<DiscoveredBlock> AllBlocks, BlockMap& Map,
+                             CodePageMap* Pages) {
+  std::vector<DiscoveredBlock> Blocks;
+  for (auto const& Block : AllBlocks) {
+    if (!Map.count(Block.PC))
+      Blocks.push_back(Block);
+  }
+  std::vector<Translation> Codes(Blocks.size());
+
+  std::atomic<size_t> NextBlock = 0;
+  std::mutex ErrorMutex;
+  Error FirstError = Error::success();
+  auto RecordError = [&](Error Err) {
+    std::lock_guard<std::mutex> Lock(ErrorMutex);
+    FirstError = joinErrors(std::move(FirstError), std::move(Err));
+  };
+  auto Worker = [&] {
+    for (size_t I = NextBlock++; I < Blocks.size(); I = NextBlock++) {
+      // The lookup inside translateOptimized forces ORC to materialize
+      // (compile and link) the block on this thread instead of on the first
+      // guest visit.
+      auto Code = translateOptimized(Source, Blocks[I].PC, Blocks[I].NumInstrs);
+      if (!Code) {
+        RecordError(Code.takeError());
+        continue;
+      }
+      Codes[I] = std::move(*Code);
+    }
+  };
+  std::vector<std::thread> Threads;
+  for (unsigned I = 0; I < Opts.WarmUpThreads; ++I)
+    Threads.emplace_back(Worker);
+  for (auto& Thread : Threads)
+    Thread.join();
+  if (FirstError)
+    return FirstError;
+
+  for (size_t I = 0; I < Blocks.size(); ++I) {
+    TranslatedBlock Block;
+    Block.Code = Codes[I].Code;
+    Block.Tracker = std::move(Codes[I].Tracker);
+    Block.CacheKey = std::move(Codes[I].CacheKey);
+    Block.NumInstrs = Blocks[I].NumInstrs;
+    Block.Limit = Opts.Threshold;
+    Block.Optimized = true;
+    Block.Halts = isHaltLoop(Source, Blocks[I].PC);
+    Map.insert({Blocks[I].PC, Block});
+    if (Pages)
+      Pages->add(Blocks[I].PC, {blockRange(Source, Blocks[I].PC, Blocks[I].NumInstrs)});
+  }
+  return Error::success();
+}
+
+// Translates every block reachable by a static scan of the image before the
+// first guest starts running.
+Error Engine::warmUp() {
+  WarmedUp = true;
+  auto Start = std::chrono::steady_clock::now();
+  ElfCodeInfo const& Info = Image->codeInfo();
+  std::vector<DiscoveredBlock> Blocks = discoverBlocks(Image->memory(), Info, Opts.Threshold);
+  if (auto Err = translateAhead(Image->memory(), Blocks, Translated, nullptr))
+    return Err;
+
+  uint64_t CoveredInstrs = 0;
+  for (auto const& Block : Blocks)
+    CoveredInstrs += Block.NumInstrs;
+  // A linear sweep: with RVC, instructions are 2 or 4 bytes long.
+  uint64_t TextInstrs = 0;
+  for (auto const& Region : Info.ExecutableRegions) {
+    for (uint32_t PC = Region.Begin; PC + 2 <= Region.End; PC += instructionLength(read16(Image->memory(), PC)))
+      ++TextInstrs;
+  }
+
+  auto Elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Start);
+  errs() << "warm-up: translated " << Blocks.size() << " blocks (" << CoveredInstrs << " of "
+         << TextInstrs << " text instructions) on " << Opts.WarmUpThreads << " threads in "
+         << Elapsed.count() << " ms\n";
+  return Error::success();
+}
+
+// Drops Code's reference to its host code and removes the code from the JIT
+// with the last one: with a code cache, translations of the same key share
+// it.
+Error Engine::removeCode(Translation& Code) {
+  ResourceTrackerSP Tracker = std::move(Code.Tracker);
+  if (!Tracker || (Cache && !Cache->release(Code.CacheKey)))
+    return Error::success();
+  return Tracker->remove();
+}
+
+// Removes Block's code from the JIT. Only the dispatcher calls translated
+// code, and regions inline their blocks, so nothing else refers to it; while
+// harts run, though, another one may be inside it, and it is retired instead.
+Error Engine::freeTranslation(TranslatedBlock& Block) {
+  if (!Block.Tracker)
+    return Error::success();
+  Translation Code{nullptr, std::move(Block.Tracker), std::move(Block.CacheKey)};
+  if (Parallel)
+    Retired.push_back(std::move(Code));
+  else if (auto Err = removeCode(Code))
+    return Err;
+  Block.Tracker = nullptr;
+  Block.Code = nullptr;
+  return Error::success();
+}
+
+// Frees the code retired while harts ran in parallel, once they stopped.
+Error Engine::freeRetired() {
+  Error Result = Error::success();
+  for (Translation& Code : Retired) {
+    if (auto Err = removeCode(Code))
+      Result = joinErrors(std::move(Result), std::move(Err));
+  }
+  Retired.clear();
+  return Result;
+}
+
+// Gives Block new code and frees the code it supersedes. The profile is kept.
+Error Engine::replaceTranslation(TranslatedBlock& Block, TranslatedBlock New) {
+  New.Edges = Block.Edges;
+  New.RegionRequested = Block.RegionRequested;
+  New.LastUse = Block.LastUse;
+  // A code cache hands out the same code when the guest range did not
+  // change, e.g. a resized block still ending at the same branch; New then
+  // holds its own reference and the one of Block is only dropped.
+  if (auto Err = freeTranslation(Block))
+    return Err;
+  Block = std::move(New);
+  return Error::success();
+}
+
+// Evicts the coldest LLVM translations once the budget is exceeded. Evicted
+// blocks stay in Translated with their profile and are translated again on
+// their next visit. Current is about to run and is never evicted.
+Error Engine::evictColdBlocks(uint32_t Current) {
+  std::vector<EvictionCandidate> Candidates;
+  for (auto const& [PC, Block] : Translated) {
+    if (Block.Tracker && Block.Code && PC != Current)
+      Candidates.push_back({PC, Block.ExecCount, Block.LastUse, Budget->bytesOf(*Block.Tracker)});
+  }
+  for (uint32_t PC : Budget->selectVictims(Candidates, Dispatches)) {
+    TranslatedBlock& Block = Translated[PC];
+    // Code shared under a code cache key stays until its last user drops it.
+    if (!Cache || Cache->release(Block.CacheKey)) {
+      if (auto Err = Budget->evict(*Block.Tracker))
+        return Err;
+    }
+    Block.Tracker = nullptr;
+    Block.Code = nullptr;
+    Block.IsRegion = false;
+  }
+  return Error::success();
+}
+
+// Drops the translations built from guest pages written since the last call.
+// Their blocks are translated again from the new bytes on their next visit.
+// A write to the image's code makes the guest diverge from the shared
+// translations.
+Error Engine::invalidateWrittenCode(Guest& G) {
+  if (!G.Diverged && !Image->sameCode(G.State.Manager, /*OnlyWritten=*/true)) {
+    if (auto Err = diverge(G))
+      return Err;
+  }
+  for (uint32_t PC : G.Pages->takeInvalidated()) {
+    auto It = G.Private.find(PC);
+    if (It == G.Private.end())
+      continue;
+    if (auto Err = freeTranslation(It->second))
+      return Err;
+    G.Private.erase(It);
+  }
+  CodeGeneration.fetch_add(1, std::memory_order_release);
+  // Stores that left the code as it was keep the guest on the shared
+  // translations; watch those pages afresh.
+  if (!G.Diverged)
+    Image->markCode(G.State.Manager);
+  return Error::success();
+}
+
+// Moves G off the shared translations. Its private ones are dropped as well,
+// and its code pages are marked again as it translates them from its own
+// memory.
+Error Engine::diverge(Guest& G) {
+  if (auto Err = dropTranslations(G.Private))
+    return Err;
+  MemoryManager* Manager = G.State.Manager;
+  std::memset(Manager->CodePages, 0, PageBitmapBytes);
+  std::memset(Manager->WrittenCodePages, 0, PageBitmapBytes);
+  for (uint32_t Page = 0; Page < PageBitmapBytes * 8; ++Page) {
+    if (testPage(Manager->WatchedPages, Page))
+      updateWatch(Manager, Page);
+  }
+  Manager->CodeWritten = 0;
+  G.Pages = std::make_unique<CodePageMap>(Manager);
+  G.Diverged = true;
+  ++Diverged;
+  return Error::success();
+}
+
+// Installs every region whose compilation has finished. Called between guest
+// blocks, so the swap is atomic from the guests' point of view.
+Error Engine::installRegions(bool Wait) {
+  Error Result = Error::success();
+  for (auto It = PendingRegions.begin(); It != PendingRegions.end();) {
+    if (!Wait && It->Code.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      ++It;
+      continue;
+    }
+    auto Code = It->Code.get();
+    auto HeadIt = Translated.find(It->Head);
+    if (Code && HeadIt == Translated.end()) {
+      TranslatedBlock Stale;
+      Stale.Tracker = std::move(Code->Tracker);
+      Stale.CacheKey = std::move(Code->CacheKey);
+      if (auto Err = freeTranslation(Stale))
+        Result = joinErrors(std::move(Result), std::move(Err));
+    } else if (Code) {
+      TranslatedBlock& Head = HeadIt->second;
+      TranslatedBlock Region = Head;
+      Region.Code = Code->Code;
+      Region.Tracker = std::move(Code->Tracker);
+      Region.CacheKey = std::move(Code->CacheKey);
+      Region.Optimized = true;
+      Region.IsRegion = true;
+      if (auto Err = replaceTranslation(Head, std::move(Region)))
+        Result = joinErrors(std::move(Result), std::move(Err));
+    } else {
+      Result = joinErrors(std::move(Result), Code.takeError());
+    }
+    It = PendingRegions.erase(It);
+  }
+  return Result;
+}
+
+// Forms the hot region headed by the shared block at PC and compiles it in
+// the background; installRegions() picks it up.
+void Engine::requestRegion(uint32_t PC, TranslatedBlock& Block) {
+  Block.RegionRequested = true;
+  auto Lookup = [&](uint32_t BlockPC, RegionBlock& Region) {
+    auto It = Translated.find(BlockPC);
+    if (It == Translated.end() || It->second.Halts)
+      return false;
+    Region = {BlockPC, It->second.NumInstrs, It->second.ExecCount, It->second.Edges};
+    return true;
+  };
+  std::vector<RegionBlock> Blocks = formRegion(PC, Lookup, Opts.RegionMaxBlocks);
+  if (Blocks.size() < 2)
+    return;
+  std::vector<CodeRange> Ranges;
+  for (auto const& RegionBlock : Blocks)
+    Ranges.push_back(blockRange(Image->memory(), RegionBlock.PC, RegionBlock.NumInstrs));
+  PendingRegions.push_back({PC, std::async(std::launch::async, [this, Blocks = std::move(Blocks), Ranges]() mutable {
+                              return compileRegion(std::move(Blocks), std::move(Ranges));
+                            })});
+}
+
+// Blocks in the image's code come from the shared map until G diverges;
+// everything else is translated privately, without regions or eviction.
+Expected<Engine::TranslatedBlock*> Engine::prepareBlock(Guest& G, uint32_t PC, uint64_t Executions) {
+  if (!PendingRegions.empty()) {
+    if (auto Err = installRegions(false))
+      return std::move(Err);
+  }
+  bool Shared = !G.Diverged && Image->isCode(PC);
+  BlockMap& Map = Shared ? Translated : G.Private;
+  MemoryManager* Source = Shared ? Image->memory() : G.State.Manager;
+  auto Track = [&](TranslatedBlock const& Block) {
+    if (!Shared)
+      G.Pages->add(PC, {blockRange(Source, PC, Block.NumInstrs)});
+  };
+
+  auto BlockIt = Map.find(PC);
+  if (BlockIt == Map.end()) {
+    auto NewBlock = translate(Source, PC, Tier::Baseline, 0);
+    if (!NewBlock)
+      return NewBlock.takeError();
+    BlockIt = Map.insert({PC, std::move(*NewBlock)}).first;
+    Track(BlockIt->second);
+    ++LateTranslations;
+  } else if (!BlockIt->second.Code) {
+    // Evicted: it was hot enough for LLVM before, so it goes straight back
+    // to that tier.
+    auto NewBlock = translate(Source, PC, Tier::Optimized, BlockIt->second.ExecCount);
+    if (!NewBlock)
+      return NewBlock.takeError();
+    if (auto Err = replaceTranslation(BlockIt->second, std::move(*NewBlock)))
+      return std::move(Err);
+  }
+  if (Budget && !Parallel && Budget->overBudget()) {
+    if (auto Err = evictColdBlocks(PC))
+      return std::move(Err);
+  }
+
+  TranslatedBlock& Block = BlockIt->second;
+  if (Block.Halts)
+    return &Block;
+  uint64_t Before = Block.ExecCount;
+  Block.ExecCount += Executions;
+  Block.LastUse = Dispatches += Executions;
+  Tier CurrentTier = Block.Optimized ? Tier::Optimized : Tier::Baseline;
+  std::optional<Tier> Retranslate;
+  if (!Block.Optimized && Block.ExecCount >= Opts.TierUpThreshold)
+    Retranslate = Tier::Optimized;
+  // A block that was cut by its size limit is reconsidered each time its
+  // execution count doubles.
+  else if (Sizer && !Block.IsRegion && Block.NumInstrs >= Block.Limit &&
+           std::bit_width(Before) != std::bit_width(Block.ExecCount) &&
+           Sizer->limitFor(PC, Block.ExecCount, CurrentTier) > Block.Limit)
+    Retranslate = CurrentTier;
+  if (Retranslate) {
+    auto NewBlock = translate(Source, PC, *Retranslate, Block.ExecCount);
+    if (!NewBlock)
+      return NewBlock.takeError();
+    if (auto Err = replaceTranslation(Block, std::move(*NewBlock)))
+      return std::move(Err);
+    Track(Block);
+  }
+  if (Shared && Opts.RegionThreshold && !Block.RegionRequested && Block.ExecCount >= Opts.RegionThreshold)
+    requestRegion(PC, Block);
+  return &Block;
+}
+
+Expected<Engine::StopReason> Engine::step(Guest& G) {
+  return run(G, 1);
+}
+
+// The guest starts with ra == 0, so returning from the entry function lands
+// on address 0 and ends the run.
+Expected<Engine::StopReason> Engine::run(Guest& G, uint64_t MaxInstructions) {
+  if (!G.Harts.empty())
+    return runHarts(G, MaxInstructions);
+  CPUState& State = G.State;
+  setGuestOutput(G.GuestStdout, G.GuestStderr);
+  auto ResetOutput = make_scope_exit([] { setGuestOutput(nullptr, nullptr); });
+  enterGuestFloat(State);
+  auto LeaveFloat = make_scope_exit([&State] { leaveGuestFloat(State); });
+  uint64_t Executed = 0;
+  while (State.PC != 0) {
+    if (std::atomic_ref<uint32_t>(State.Manager->CodeWritten).load(std::memory_order_acquire)) {
+      if (auto Err = invalidateWrittenCode(G))
+        return std::move(Err);
+    }
+    if (!G.Breakpoints.empty()) {
+      auto It = std::find(G.Breakpoints.begin(), G.Breakpoints.end(), State.PC);
+      if (It != G.Breakpoints.end()) {
+        G.Breakpoints.erase(It);
+        return StopReason::Breakpoint;
+      }
+    }
+    if (Executed >= MaxInstructions)
+      return StopReason::InstructionLimit;
+    auto BlockOrErr = prepareBlock(G, State.PC);
+    if (!BlockOrErr)
+      return BlockOrErr.takeError();
+    TranslatedBlock& Block = **BlockOrErr;
+    if (Block.Halts)
+      return StopReason::Halted;
+    Executed += runCode(Block.Code, State, Block.NumInstrs, MaxInstructions - Executed);
+    // Region code may leave through any of its blocks, so its exits say
+    // nothing about the head block's branch.
+    if (Opts.RegionThreshold && !Block.IsRegion)
+      Block.Edges.record(State.PC);
+    if (Opts.DebugMode)
+      dump(&State);
+  }
+  if (auto Err = installRegions(true))
+    return std::move(Err);
+  return StopReason::Exited;
+}
+
+// Hart 0 runs on the calling thread. Its stop, or an error on any hart,
+// stops the others at their next block.
+Expected<Engine::StopReason> Engine::runHarts(Guest& G, uint64_t MaxInstructions) {
+  std::atomic<bool> Stop = false;
+  std::mutex ErrorMutex;
+  Error Result = Error::success();
+  auto RunHart = [&](CPUState& State, JumpCache& Cache) -> std::optional<StopReason> {
+    auto ReasonOrErr = runHart(G, State, Cache, MaxInstructions, Stop);
+    if (ReasonOrErr)
+      return *ReasonOrErr;
+    Stop = true;
+    std::lock_guard<std::mutex> Lock(ErrorMutex);
+    Result = joinErrors(std::move(Result), ReasonOrErr.takeError());
+    return std::nullopt;
+  };
+
+  std::vector<std::unique_ptr<JumpCache>> Caches;
+  for (size_t I = 0; I <= G.Harts.size(); ++I) {
+    Caches.push_back(std::make_unique<JumpCache>());
+    Caches.back()->Generation = CodeGeneration;
+  }
+  Parallel = true;
+  std::vector<std::thread> Threads;
+  for (size_t I = 0; I < G.Harts.size(); ++I)
+    Threads.emplace_back([&, I] { RunHart(*G.Harts[I], *Caches[I + 1]); });
+  std::optional<StopReason> Reason = RunHart(G.State, *Caches[0]);
+  Stop = true;
+  for (std::thread& Thread : Threads)
+    Thread.join();
+  Parallel = false;
+
+  if (auto Err = freeRetired())
+    Result = joinErrors(std::move(Result), std::move(Err));
+  if (auto Err = installRegions(true))
+    Result = joinErrors(std::move(Result), std::move(Err));
+  if (Result)
+    return std::move(Result);
+  return *Reason;
+}
+
+// Blocks found in Cache run without the engine's lock; everything else
+// (translation, profiling, invalidation, syscalls aside) takes HartMutex.
+// Branch edges are not profiled. With YieldOnPause, a block that executed
+// PAUSE ends the run as if the budget was spent.
+Expected<Engine::StopReason> Engine::runHart(Guest& G, CPUState& State, JumpCache& Cache, uint64_t MaxInstructions,
+                                             std::atomic<bool> const& Stop, bool YieldOnPause) {
+  bool Primary = &State == &G.State;
+  // Only read under HartMutex; until then, shared entries are not trusted.
+  bool Diverged = true;
+  if (YieldOnPause)
+    takePause();
+  setGuestOutput(G.GuestStdout, G.GuestStderr);
+  auto ResetOutput = make_scope_exit([] { setGuestOutput(nullptr, nullptr); });
+  enterGuestFloat(State);
+  auto LeaveFloat = make_scope_exit([&State] { leaveGuestFloat(State); });
+  uint64_t Executed = 0;
+  while (State.PC != 0) {
+    if (Stop.load(std::memory_order_relaxed))
+      return StopReason::InstructionLimit;
+    if (Primary && !G.Breakpoints.empty()) {
+      auto It = std::find(G.Breakpoints.begin(), G.Breakpoints.end(), State.PC);
+      if (It != G.Breakpoints.end()) {
+        G.Breakpoints.erase(It);
+        return StopReason::Breakpoint;
+      }
+    }
+    if (Executed >= MaxInstructions)
+      return StopReason::InstructionLimit;
+
+    JumpCache::Entry& Entry = Cache.entry(State.PC);
+    bool Written = std::atomic_ref<uint32_t>(State.Manager->CodeWritten).load(std::memory_order_relaxed);
+    bool Current = CodeGeneration.load(std::memory_order_acquire) == Cache.Generation;
+    bool Usable = Entry.PC == State.PC && Entry.Code && (Entry.Owner ? Entry.Owner == &G : !Diverged);
+    if (!Written && Current && Usable && Entry.Hits < JumpCache::ProfileBatch) {
+      ++Entry.Hits;
+    } else {
+      std::lock_guard<std::mutex> Lock(HartMutex);
+      if (std::atomic_ref<uint32_t>(State.Manager->CodeWritten).load(std::memory_order_acquire)) {
+        if (auto Err = invalidateWrittenCode(G))
+          return std::move(Err);
+      }
+      if (CodeGeneration != Cache.Generation) {
+        Cache.clear();
+        Cache.Generation = CodeGeneration;
+        Usable = false;
+      }
+      Diverged = G.Diverged;
+      uint64_t Executions = Usable ? Entry.Hits + 1 : 1;
+      auto BlockOrErr = prepareBlock(G, State.PC, Executions);
+      if (!BlockOrErr)
+        return BlockOrErr.takeError();
+      TranslatedBlock& Block = **BlockOrErr;
+      if (Block.Halts)
+        return StopReason::Halted;
+      bool Shared = !Diverged && Image->isCode(State.PC);
+      Entry = {State.PC, 0, Block.Code, Block.NumInstrs, Shared ? nullptr : &G};
+    }
+    Executed += runCode(Entry.Code, State, Entry.NumInstrs, MaxInstructions - Executed);
+    if (YieldOnPause && takePause())
+      return StopReason::InstructionLimit;
+  }
+  return StopReason::Exited;
+}
+
+std::span<uint8_t> Engine::Guest::memory(uint32_t Addr, uint32_t Size) {
+  if (!State.Manager)
+    return {};
+  for (uint32_t I = 0; I < State.Manager->NumSegments; ++I) {
+    SegmentManager const& Segment = State.Manager->SegmentData[I];
+    uint64_t Offset = uint64_t(Addr) - Segment.GuestAddress;
+    if (Addr >= Segment.GuestAddress && Offset + Size <= Segment.MemorySize)
+      return {Segment.Memory + Offset, Size};
+  }
+  return {};
+}
+
+Engine::Guest::Guest(Engine& Owner) : Owner(Owner) {}
+
+Engine::Guest::~Guest() {
+  consumeError(Owner.dropTranslations(Private));
+}
+
+Error Engine::dropTranslations(BlockMap& Map) {
+  Error Result = Error::success();
+  for (auto& [PC, Block] : Map) {
+    if (auto Err = freeTranslation(Block))
+      Result = joinErrors(std::move(Result), std::move(Err));
+  }
+  Map.clear();
+  return Result;
+}
+
+// Copies Args below the initial stack pointer and puts argc, argv, a null
+// argv terminator and an empty environment at the new stack pointer.
+static void pushArguments(CPUState& State, ArrayRef<std::string> Args) {
+  uint32_t SP = State.Registers[2];
+  std::vector<uint32_t> Pointers;
+  for (std::string const& Arg : Args) {
+    SP -= Arg.size() + 1;
+    for (size_t I = 0; I <= Arg.size(); ++I)
+      write8(State.Manager, SP + I, Arg.c_str()[I]);
+    Pointers.push_back(SP);
+  }
+  uint32_t NumWords = Args.size() + 3;
+  SP = (SP - 4 * NumWords) & ~15U;
+  write32(State.Manager, SP, Args.size());
+  for (size_t I = 0; I < Pointers.size(); ++I)
+    write32(State.Manager, SP + 4 * (I + 1), Pointers[I]);
+  write32(State.Manager, SP + 4 * (Args.size() + 1), 0);
+  write32(State.Manager, SP + 4 * (Args.size() + 2), 0);
+  State.Registers[2] = SP;
+  State.Registers[10] = Args.size();
+  State.Registers[11] = SP + 4;
+}
+
+// The guest's memory is a copy-on-write mapping of the image, so spawning
+// costs a few page mappings; its blocks reuse whatever earlier guests
+// translated.
+Expected<std::unique_ptr<Engine::Guest>> Engine::spawn(ArrayRef<std::string> Args) {
+  auto MemoryOrErr = Image->instantiate();
+  if (!MemoryOrErr)
+    return MemoryOrErr.takeError();
+  std::unique_ptr<Guest> G(new Guest(*this));
+  G->Memory = std::move(*MemoryOrErr);
+  G->State = {{}, Image->entryPoint(), G->Memory->manager()};
+  G->State.Registers[2] = -16;
+  G->Pages = std::make_unique<CodePageMap>(G->State.Manager);
+  if (!Args.empty())
+    pushArguments(G->State, Args);
+  // The stack is the last segment.
+  MemoryManager* Manager = G->State.Manager;
+  if (uint64_t(Opts.Harts) * HartStackBytes > Manager->SegmentData[Manager->NumSegments - 1].MemorySize)
+    return createStringError(inconvertibleErrorCode(), "%u harts do not fit the guest's stack", Opts.Harts);
+  for (unsigned I = 1; I < Opts.Harts; ++I) {
+    auto Hart = std::make_unique<CPUState>(CPUState{{}, Image->entryPoint(), Manager});
+    Hart->Registers[2] = -16 - I * HartStackBytes;
+    Hart->HartId = I;
+    G->Harts.push_back(std::move(Hart));
+  }
+  ++Spawned;
+  if (Opts.WarmUp && !WarmedUp) {
+    if (auto Err = warmUp())
+      return std::move(Err);
+  }
+  return std::move(G);
+}
+
+Expected<std::unique_ptr<Engine::Guest>> Engine::resume(StringRef SnapshotPath) {
+  auto SnapshotOrErr = Snapshot::restore(SnapshotPath, ElfPath);
+  if (!SnapshotOrErr)
+    return SnapshotOrErr.takeError();
+  std::unique_ptr<Guest> G(new Guest(*this));
+  G->Restored = std::move(*SnapshotOrErr);
+  G->State = G->Restored->State;
+  G->Pages = std::make_unique<CodePageMap>(G->State.Manager);
+  ++Spawned;
+  // The snapshot may have been taken after the guest changed its code.
+  if (Image->sameCode(G->State.Manager, /*OnlyWritten=*/false)) {
+    Image->markCode(G->State.Manager);
+  } else if (auto Err = diverge(*G)) {
+    return std::move(Err);
+  }
+
+  auto Start = std::chrono::steady_clock::now();
+  Error Err = Error::success();
+  if (G->Diverged) {
+    Err = translateAhead(G->State.Manager, G->Restored->Blocks, G->Private, G->Pages.get());
+  } else {
+    std::vector<DiscoveredBlock> SharedBlocks;
+    for (auto const& Block : G->Restored->Blocks) {
+      if (Image->isCode(Block.PC))
+        SharedBlocks.push_back(Block);
+    }
+    Err = translateAhead(Image->memory(), SharedBlocks, Translated, nullptr);
+  }
+  if (Err)
+    return std::move(Err);
+  auto Elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Start);
+  errs() << "restore: resumed at " << format_hex(G->State.PC, 10) << " with " << G->Restored->Blocks.size()
+         << " blocks translated in " << Elapsed.count() << " ms\n";
+  return std::move(G);
+}
+
+Error Engine::checkpoint(Guest const& G, StringRef Path) const {
+  // A snapshot holds one hart's state.
+  if (!G.Harts.empty())
+    return createStringError(inconvertibleErrorCode(), "guests with more than one hart cannot be checkpointed");
+  // Only LLVM translations go into the manifest: those are what a restore
+  // can get back cheaply from the code cache.
+  std::vector<DiscoveredBlock> Manifest;
+  auto AddBlocks = [&](BlockMap const& Map) {
+    for (auto const& [PC, Block] : Map) {
+      if (Block.Code && Block.Optimized)
+        Manifest.push_back({PC, static_cast<uint32_t>(Block.NumInstrs)});
+    }
+  };
+  if (!G.Diverged)
+    AddBlocks(Translated);
+  AddBlocks(G.Private);
+  return Snapshot::write(Path, ElfPath, G.State, Manifest);
+}
+
+// Adds an object written by dbtranslator-aot to the JIT and enters its
+// blocks into the shared map. Blocks already translated (by warm-up) keep
+// their code.
+Error Engine::loadAotObject(StringRef Path) {
+  auto Object = MemoryBuffer::getFile(Path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!Object)
+    return createFileError(Path, Object.getError());
+  if (auto Err = JIT->addObjectFile(std::move(*Object)))
+    return Err;
+
+  auto ElfHash = hashFile(ElfPath);
+  if (!ElfHash)
+    return ElfHash.takeError();
+  auto HashAddr = JIT->lookup(AotElfHashSymbol);
+  if (!HashAddr)
+    return HashAddr.takeError();
+  if (std::memcmp(HashAddr->toPtr<uint8_t const*>(), ElfHash->data(), ElfHash->size()) != 0)
+    return createStringError(inconvertibleErrorCode(), "%s was compiled from a different ELF than %s",
+                             Path.str().c_str(), ElfPath.c_str());
+  // The object's code must be what this engine would generate: coverage,
+  // memory runtime and host C library routines all change it.
+  auto PrefixAddr = JIT->lookup(AotKindPrefixSymbol);
+  if (!PrefixAddr)
+    return PrefixAddr.takeError();
+  StringRef ObjectPrefix(PrefixAddr->toPtr<char const*>());
+  if (ObjectPrefix != KindPrefix)
+    return createStringError(inconvertibleErrorCode(), "%s was compiled with options '%s', this run uses '%s'",
+                             Path.str().c_str(), ObjectPrefix.str().c_str(), KindPrefix.c_str());
+
+  auto NumAddr = JIT->lookup(AotNumBlocksSymbol);
+  if (!NumAddr)
+    return NumAddr.takeError();
+  auto BlocksAddr = JIT->lookup(AotBlocksSymbol);
+  if (!BlocksAddr)
+    return BlocksAddr.takeError();
+  auto const* Blocks = BlocksAddr->toPtr<AotBlock const*>();
+  for (uint32_t I = 0, E = *NumAddr->toPtr<uint32_t const*>(); I < E; ++I) {
+    if (!Image->isCode(Blocks[I].PC))
+      continue;
+    TranslatedBlock Block;
+    Block.Code = Blocks[I].Code;
+    Block.NumInstrs = Blocks[I].NumInstrs;
+    Block.Limit = Opts.Threshold;
+    Block.Optimized = true;
+    Block.Halts = isHaltLoop(Image->memory(), Blocks[I].PC);
+    Translated.insert({Blocks[I].PC, Block});
+  }
+  return Error::success();
+}
+
+Engine::Guest& Engine::defaultGuest() const {
+  assert(DefaultGuest && "no guest is loaded");
+  return *DefaultGuest;
+}
+
+Error Engine::load(ArrayRef<std::string> Args) {
+  DefaultGuest.reset();
+  auto GuestOrErr = spawn(Args);
+  if (!GuestOrErr)
+    return GuestOrErr.takeError();
+  DefaultGuest = std::move(*GuestOrErr);
+  return Error::success();
+}
+
+Error Engine::restore(StringRef SnapshotPath) {
+  DefaultGuest.reset();
+  auto GuestOrErr = resume(SnapshotPath);
+  if (!GuestOrErr)
+    return GuestOrErr.takeError();
+  DefaultGuest = std::move(*GuestOrErr);
+  return Error::success();
+}
+
+Error Engine::checkpoint(StringRef Path) const {
+  return checkpoint(defaultGuest(), Path);
+}
+
+Expected<Engine::StopReason> Engine::run(uint64_t MaxInstructions) {
+  if (!DefaultGuest)
+    return createStringError(inconvertibleErrorCode(), "no guest is loaded");
+  return run(*DefaultGuest, MaxInstructions);
+}
+
+Expected<Engine::StopReason> Engine::step() {
+  return run(1);
+}
+
+void Engine::stopAt(uint32_t PC) { defaultGuest().stopAt(PC); }
+CPUState& Engine::state() { return defaultGuest().state(); }
+std::span<uint32_t, 32> Engine::registers() { return defaultGuest().registers(); }
+uint32_t Engine::pc() const { return defaultGuest().pc(); }
+void Engine::setPC(uint32_t PC) { defaultGuest().setPC(PC); }
+
+std::span<uint8_t> Engine::memory(uint32_t Addr, uint32_t Size) {
+  return DefaultGuest ? DefaultGuest->memory(Addr, Size) : std::span<uint8_t>();
+}
+
+void Engine::setOutput(raw_ostream* Stdout, raw_ostream* Stderr) {
+  defaultGuest().setOutput(Stdout, Stderr);
+}
+
+void Engine::printStats(raw_ostream& OS) const {
+  if (Opts.WarmUp)
+    OS << "warm-up: " << LateTranslations << " blocks translated after warm-up\n";
+  if (Spawned > 1)
+    OS << "guests: " << Spawned << " spawned sharing " << Translated.size() << " translations, " << Diverged
+       << " diverged\n";
+  if (Quanta)
+    OS << "scheduler: " << Quanta << " quanta run, " << Steals << " tasks stolen\n";
+  if (!LibcEntries.empty())
+    OS << "libc: " << LibcEntries.size() << " routines run as host code\n";
+  if (Cache)
+    Cache->printStats(OS);
+  if (Budget)
+    Budget->printStats(OS);
+  if (Opts.BlockSizeReport)
+    Sizer->printReport(OS);
+}
+
+} // end namespace riscv
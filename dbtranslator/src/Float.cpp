@@ -0,0 +1,522 @@
+// Lowering of the F and D extensions and of the Zicsr instructions. The FP
+// registers live in CPUState as 64-bit values, singles NaN-boxed in them.
+// Arithmetic uses constrained FP intrinsics with the dynamic rounding mode,
+// so that the host's rounding mode and exception flags stand for frm and
+// fflags as FloatEnv.h describes; an instruction with a static rounding
+// mode installs it around itself. NaN results are replaced by the RISC-V
+// canonical NaN, which differs from the one x86 produces.
+
+#include "CPU.h"
+#include "FloatEnv.h"
+#include "Instruction.h"
+#include <cstdint>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Intrinsics.h>
+
+namespace riscv {
+
+namespace {
+
+uint32_t regSrc3(uint32_t InstructionData) { return (InstructionData >> 27) & 0x1F; }
+uint32_t roundingMode(uint32_t InstructionData) { return (InstructionData >> 12) & 0x7; }
+
+inline constexpr uint32_t DynamicRounding = 7;
+
+// Layout of a single or double in its integer bits.
+struct Format {
+  unsigned Bits;
+  unsigned MantissaBits;
+  uint64_t CanonicalNaN;
+};
+
+inline constexpr Format Single{32, 23, 0x7FC00000};
+inline constexpr Format Double{64, 52, 0x7FF8000000000000};
+
+Format const& format(bool IsDouble) { return IsDouble ? Double : Single; }
+
+llvm::Type* floatType(llvm::IRBuilder<>& B, bool IsDouble) {
+  return IsDouble ? B.getDoubleTy() : B.getFloatTy();
+}
+
+llvm::Value* floatReg(IRData& Data, uint32_t Reg) {
+  return Data.Builder.CreateConstInBoundsGEP2_32(Data.CPUStateTy->getElementType(6), Data.FloatRegsPtr, 0, Reg);
+}
+
+// Integer bits of FP register Reg. A single that is not properly NaN-boxed
+// reads as the canonical NaN.
+llvm::Value* readFloatBits(IRData& Data, uint32_t Reg, bool IsDouble) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *Bits = B.CreateLoad(B.getInt64Ty(), floatReg(Data, Reg));
+  if (IsDouble)
+    return Bits;
+  llvm::Value *Boxed = B.CreateICmpEQ(B.CreateLShr(Bits, 32), B.getInt64(0xFFFFFFFF));
+  return B.CreateSelect(Boxed, B.CreateTrunc(Bits, B.getInt32Ty()), B.getInt32(Single.CanonicalNaN));
+}
+
+llvm::Value* readFloat(IRData& Data, uint32_t Reg, bool IsDouble) {
+  return Data.Builder.CreateBitCast(readFloatBits(Data, Reg, IsDouble), floatType(Data.Builder, IsDouble));
+}
+
+// Writes i32 (NaN-boxed) or i64 bits to FP register Reg.
+void writeFloatBits(IRData& Data, uint32_t Reg, llvm::Value* Bits) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  if (Bits->getType()->getIntegerBitWidth() == 32)
+    Bits = B.CreateOr(B.CreateZExt(Bits, B.getInt64Ty()), B.getInt64(0xFFFFFFFF00000000));
+  B.CreateStore(Bits, floatReg(Data, Reg));
+}
+
+llvm::Value* isNaN(llvm::IRBuilder<>& B, llvm::Value* Bits, Format const& F) {
+  llvm::Value *Magnitude = B.CreateAnd(Bits, B.getIntN(F.Bits, ~0ULL >> (65 - F.Bits)));
+  llvm::Value *Infinity = B.getIntN(F.Bits, ((1ULL << (F.Bits - 1 - F.MantissaBits)) - 1) << F.MantissaBits);
+  return B.CreateICmpUGT(Magnitude, Infinity);
+}
+
+// Writes an FP result, replacing any NaN by the canonical one.
+void writeFloat(IRData& Data, uint32_t Reg, llvm::Value* Value, bool IsDouble) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  Format const& F = format(IsDouble);
+  llvm::Value *Bits = B.CreateBitCast(Value, B.getIntNTy(F.Bits));
+  writeFloatBits(Data, Reg, B.CreateSelect(isNaN(B, Bits, F), B.getIntN(F.Bits, F.CanonicalNaN), Bits));
+}
+
+void raiseFlags(IRData& Data, llvm::Value* Flags) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  B.CreateStore(B.CreateOr(B.CreateLoad(B.getInt32Ty(), Data.FCSRPtr), Flags), Data.FCSRPtr);
+}
+
+llvm::Value* statePtr(IRData& Data) { return Data.CurrentFunction->getArg(0); }
+
+// Puts the builder into constrained FP mode for one instruction, with the
+// dynamic rounding mode and strict exceptions, and marks the block function
+// strictfp as the constrained intrinsics require.
+class StrictFP {
+public:
+  explicit StrictFP(IRData& Data) : Guard(Data.Builder) {
+    Data.Builder.setIsFPConstrained(true);
+    Data.Builder.setDefaultConstrainedExcept(llvm::fp::ebStrict);
+    Data.Builder.setDefaultConstrainedRounding(llvm::RoundingMode::Dynamic);
+    if (!Data.CurrentFunction->hasFnAttribute(llvm::Attribute::StrictFP))
+      Data.CurrentFunction->addFnAttr(llvm::Attribute::StrictFP);
+  }
+
+private:
+  llvm::IRBuilderBase::FastMathFlagGuard Guard;
+};
+
+llvm::Value* constrainedCall(IRData& Data, llvm::Intrinsic::ID ID, llvm::ArrayRef<llvm::Value*> Args) {
+  llvm::Function *Callee = llvm::Intrinsic::getOrInsertDeclaration(&Data.Module, ID, {Args[0]->getType()});
+  return Data.Builder.CreateConstrainedFPCall(Callee, Args);
+}
+
+// Emits Body under the instruction's static rounding mode, if it has one.
+void withRounding(IRData& Data, uint32_t InstructionData, llvm::function_ref<void()> Body) {
+  uint32_t Mode = roundingMode(InstructionData);
+  if (Mode == DynamicRounding) {
+    Body();
+    return;
+  }
+  Data.Builder.CreateCall(Data.FloatFunctions[2], {Data.Builder.getInt32(Mode)});
+  Body();
+  Data.Builder.CreateCall(Data.FloatFunctions[1], {statePtr(Data)});
+}
+
+void buildFloatLoad(IRData& Data, Instr InstrType, uint32_t InstructionData, bool IsDouble) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *Address = B.CreateAdd(Data.readReg(regSrc1(InstructionData)),
+                                     B.getInt32(immediate(InstrType, InstructionData)));
+  if (!IsDouble) {
+    writeFloatBits(Data, regDest(InstructionData), Data.readMemory(4, Address));
+    return;
+  }
+  llvm::Value *Low = B.CreateZExt(Data.readMemory(4, Address), B.getInt64Ty());
+  llvm::Value *High = B.CreateZExt(Data.readMemory(4, B.CreateAdd(Address, B.getInt32(4))), B.getInt64Ty());
+  writeFloatBits(Data, regDest(InstructionData), B.CreateOr(B.CreateShl(High, 32), Low));
+}
+
+// Stores the raw register bits: fsw does not check the NaN-boxing.
+void buildFloatStore(IRData& Data, Instr InstrType, uint32_t InstructionData, bool IsDouble) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *Address = B.CreateAdd(Data.readReg(regSrc1(InstructionData)),
+                                     B.getInt32(immediate(InstrType, InstructionData)));
+  llvm::Value *Bits = B.CreateLoad(B.getInt64Ty(), floatReg(Data, regSrc2(InstructionData)));
+  Data.writeMemory(4, Address, Bits);
+  if (IsDouble)
+    Data.writeMemory(4, B.CreateAdd(Address, B.getInt32(4)), B.CreateLShr(Bits, 32));
+}
+
+void buildFloatBinary(IRData& Data, uint32_t InstructionData, bool IsDouble,
+                      llvm::function_ref<llvm::Value*(llvm::IRBuilder<>&, llvm::Value*, llvm::Value*)> Op) {
+  StrictFP Strict(Data);
+  llvm::Value *L = readFloat(Data, regSrc1(InstructionData), IsDouble);
+  llvm::Value *R = readFloat(Data, regSrc2(InstructionData), IsDouble);
+  withRounding(Data, InstructionData, [&] {
+    writeFloat(Data, regDest(InstructionData), Op(Data.Builder, L, R), IsDouble);
+  });
+}
+
+void buildFloatSqrt(IRData& Data, uint32_t InstructionData, bool IsDouble) {
+  StrictFP Strict(Data);
+  llvm::Value *Source = readFloat(Data, regSrc1(InstructionData), IsDouble);
+  withRounding(Data, InstructionData, [&] {
+    llvm::Value *Result = constrainedCall(Data, llvm::Intrinsic::experimental_constrained_sqrt, {Source});
+    writeFloat(Data, regDest(InstructionData), Result, IsDouble);
+  });
+}
+
+// rs1 * rs2 + rs3 with the product and the addend optionally negated.
+void buildFloatFMA(IRData& Data, uint32_t InstructionData, bool IsDouble, bool NegateProduct, bool NegateAddend) {
+  StrictFP Strict(Data);
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *A = readFloat(Data, regSrc1(InstructionData), IsDouble);
+  llvm::Value *M = readFloat(Data, regSrc2(InstructionData), IsDouble);
+  llvm::Value *C = readFloat(Data, regSrc3(InstructionData), IsDouble);
+  if (NegateProduct)
+    A = B.CreateFNeg(A);
+  if (NegateAddend)
+    C = B.CreateFNeg(C);
+  withRounding(Data, InstructionData, [&] {
+    llvm::Value *Result = constrainedCall(Data, llvm::Intrinsic::experimental_constrained_fma, {A, M, C});
+    writeFloat(Data, regDest(InstructionData), Result, IsDouble);
+  });
+}
+
+// fsgnj, fsgnjn and fsgnjx: the magnitude of rs1 with a sign taken from rs2.
+enum class SignOp { Copy, Negate, Xor };
+
+void buildSignInjection(IRData& Data, uint32_t InstructionData, bool IsDouble, SignOp Op) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  Format const& F = format(IsDouble);
+  llvm::Value *SignBit = B.getIntN(F.Bits, 1ULL << (F.Bits - 1));
+  llvm::Value *L = readFloatBits(Data, regSrc1(InstructionData), IsDouble);
+  llvm::Value *R = readFloatBits(Data, regSrc2(InstructionData), IsDouble);
+  llvm::Value *Sign = Op == SignOp::Copy ? R : Op == SignOp::Negate ? B.CreateNot(R) : B.CreateXor(L, R);
+  llvm::Value *Result = B.CreateOr(B.CreateAnd(L, B.CreateNot(SignBit)), B.CreateAnd(Sign, SignBit));
+  writeFloatBits(Data, regDest(InstructionData), Result);
+}
+
+// fmin and fmax: a NaN operand yields the other one, -0 orders below +0,
+// and only signaling NaNs raise invalid (through the quiet compares).
+void buildFloatMinMax(IRData& Data, uint32_t InstructionData, bool IsDouble, bool IsMax) {
+  StrictFP Strict(Data);
+  llvm::IRBuilder<>& B = Data.Builder;
+  Format const& F = format(IsDouble);
+  llvm::Value *LBits = readFloatBits(Data, regSrc1(InstructionData), IsDouble);
+  llvm::Value *RBits = readFloatBits(Data, regSrc2(InstructionData), IsDouble);
+  llvm::Value *L = B.CreateBitCast(LBits, floatType(B, IsDouble));
+  llvm::Value *R = B.CreateBitCast(RBits, floatType(B, IsDouble));
+  llvm::Value *Less = B.CreateFCmpOLT(L, R);
+  llvm::Value *Greater = B.CreateFCmpOLT(R, L);
+  llvm::Value *Result =
+      IsMax ? B.CreateSelect(Less, RBits, B.CreateSelect(Greater, LBits, B.CreateAnd(LBits, RBits)))
+            : B.CreateSelect(Less, LBits, B.CreateSelect(Greater, RBits, B.CreateOr(LBits, RBits)));
+  llvm::Value *LNaN = isNaN(B, LBits, F);
+  llvm::Value *RNaN = isNaN(B, RBits, F);
+  Result = B.CreateSelect(LNaN, RBits, B.CreateSelect(RNaN, LBits, Result));
+  Result = B.CreateSelect(B.CreateAnd(LNaN, RNaN), B.getIntN(F.Bits, F.CanonicalNaN), Result);
+  writeFloatBits(Data, regDest(InstructionData), Result);
+}
+
+// feq is a quiet comparison, flt and fle signaling ones.
+void buildFloatCompare(IRData& Data, uint32_t InstructionData, bool IsDouble, llvm::CmpInst::Predicate Pred) {
+  StrictFP Strict(Data);
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *L = readFloat(Data, regSrc1(InstructionData), IsDouble);
+  llvm::Value *R = readFloat(Data, regSrc2(InstructionData), IsDouble);
+  llvm::Value *Result = Pred == llvm::CmpInst::FCMP_OEQ ? B.CreateFCmp(Pred, L, R) : B.CreateFCmpS(Pred, L, R);
+  Data.writeReg(regDest(InstructionData), B.CreateZExt(Result, B.getInt32Ty()));
+}
+
+void buildFloatClass(IRData& Data, uint32_t InstructionData, bool IsDouble) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  Format const& F = format(IsDouble);
+  llvm::Value *Bits = readFloatBits(Data, regSrc1(InstructionData), IsDouble);
+  uint64_t MantissaMask = (1ULL << F.MantissaBits) - 1;
+  uint64_t ExponentMask = ((1ULL << (F.Bits - 1 - F.MantissaBits)) - 1) << F.MantissaBits;
+  llvm::Value *Negative = B.CreateICmpSLT(Bits, B.getIntN(F.Bits, 0));
+  llvm::Value *Exponent = B.CreateAnd(Bits, B.getIntN(F.Bits, ExponentMask));
+  llvm::Value *Mantissa = B.CreateAnd(Bits, B.getIntN(F.Bits, MantissaMask));
+  llvm::Value *ExponentMax = B.CreateICmpEQ(Exponent, B.getIntN(F.Bits, ExponentMask));
+  llvm::Value *ExponentZero = B.CreateICmpEQ(Exponent, B.getIntN(F.Bits, 0));
+  llvm::Value *MantissaZero = B.CreateICmpEQ(Mantissa, B.getIntN(F.Bits, 0));
+  llvm::Value *Quiet = B.CreateICmpNE(B.CreateAnd(Bits, B.getIntN(F.Bits, 1ULL << (F.MantissaBits - 1))),
+                                      B.getIntN(F.Bits, 0));
+
+  llvm::Value *Result = B.getInt32(0);
+  // Classes with a negative (bit NegBit) and a positive (bit PosBit) form.
+  auto Signed = [&](llvm::Value* Cond, unsigned NegBit, unsigned PosBit) {
+    llvm::Value *Bit = B.CreateSelect(Negative, B.getInt32(1U << NegBit), B.getInt32(1U << PosBit));
+    Result = B.CreateOr(Result, B.CreateSelect(Cond, Bit, B.getInt32(0)));
+  };
+  Signed(B.CreateAnd(ExponentMax, MantissaZero), 0, 7);
+  Signed(B.CreateNot(B.CreateOr(ExponentMax, ExponentZero)), 1, 6);
+  Signed(B.CreateAnd(ExponentZero, B.CreateNot(MantissaZero)), 2, 5);
+  Signed(B.CreateAnd(ExponentZero, MantissaZero), 3, 4);
+  llvm::Value *NaN = B.CreateAnd(ExponentMax, B.CreateNot(MantissaZero));
+  llvm::Value *NaNBit = B.CreateSelect(Quiet, B.getInt32(1U << 9), B.getInt32(1U << 8));
+  Result = B.CreateOr(Result, B.CreateSelect(NaN, NaNBit, B.getInt32(0)));
+  Data.writeReg(regDest(InstructionData), Result);
+}
+
+// fcvt.w and fcvt.wu: rounds in the FP domain as rm says, then saturates
+// out-of-range values and NaNs, raising invalid for those and inexact when
+// rounding changed the value. The flags go to fflags directly, the host
+// conversion only ever seeing in-range integral values.
+void buildFloatToInt(IRData& Data, uint32_t InstructionData, bool IsDouble, bool IsSigned) {
+  StrictFP Strict(Data);
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Type *Ty = floatType(B, IsDouble);
+  llvm::Value *Bits = readFloatBits(Data, regSrc1(InstructionData), IsDouble);
+  llvm::Value *Source = B.CreateBitCast(Bits, Ty);
+
+  llvm::Intrinsic::ID Rounding;
+  switch (roundingMode(InstructionData)) {
+    case 0: Rounding = llvm::Intrinsic::experimental_constrained_roundeven; break;
+    case 1: Rounding = llvm::Intrinsic::experimental_constrained_trunc; break;
+    case 2: Rounding = llvm::Intrinsic::experimental_constrained_floor; break;
+    case 3: Rounding = llvm::Intrinsic::experimental_constrained_ceil; break;
+    case 4: Rounding = llvm::Intrinsic::experimental_constrained_round; break;
+    default: Rounding = llvm::Intrinsic::experimental_constrained_nearbyint; break;
+  }
+  llvm::Value *Rounded = constrainedCall(Data, Rounding, {Source});
+
+  double Low = IsSigned ? -2147483648.0 : 0.0;
+  double High = IsSigned ? 2147483648.0 : 4294967296.0;
+  llvm::Value *NaN = isNaN(B, Bits, format(IsDouble));
+  llvm::Value *Below = B.CreateFCmpOLT(Rounded, llvm::ConstantFP::get(Ty, Low));
+  llvm::Value *Above = B.CreateFCmpOGE(Rounded, llvm::ConstantFP::get(Ty, High));
+  llvm::Value *Invalid = B.CreateOr(NaN, B.CreateOr(Below, Above));
+  llvm::Value *InRange = B.CreateSelect(Invalid, llvm::ConstantFP::get(Ty, 0.0), Rounded);
+  llvm::Value *Result = IsSigned ? B.CreateFPToSI(InRange, B.getInt32Ty()) : B.CreateFPToUI(InRange, B.getInt32Ty());
+
+  llvm::Value *Max = B.getInt32(IsSigned ? 0x7FFFFFFF : 0xFFFFFFFF);
+  llvm::Value *Min = B.getInt32(IsSigned ? 0x80000000 : 0);
+  Result = B.CreateSelect(B.CreateOr(NaN, Above), Max, B.CreateSelect(Below, Min, Result));
+  Data.writeReg(regDest(InstructionData), Result);
+
+  llvm::Value *Inexact = B.CreateAnd(B.CreateNot(Invalid), B.CreateFCmpUNE(Rounded, Source));
+  raiseFlags(Data, B.CreateOr(B.CreateSelect(Invalid, B.getInt32(FlagInvalid), B.getInt32(0)),
+                              B.CreateSelect(Inexact, B.getInt32(FlagInexact), B.getInt32(0))));
+}
+
+void buildIntToFloat(IRData& Data, uint32_t InstructionData, bool IsDouble, bool IsSigned) {
+  StrictFP Strict(Data);
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *Source = Data.readReg(regSrc1(InstructionData));
+  withRounding(Data, InstructionData, [&] {
+    llvm::Type *Ty = floatType(B, IsDouble);
+    llvm::Value *Result = IsSigned ? B.CreateSIToFP(Source, Ty) : B.CreateUIToFP(Source, Ty);
+    writeFloat(Data, regDest(InstructionData), Result, IsDouble);
+  });
+}
+
+// The CSRs the translated code knows: the FP ones and the read-only vector
+// ones and mhartid. Others read as zero and ignore writes.
+enum CSR : uint32_t {
+  FFlags = 0x001,
+  Frm = 0x002,
+  Fcsr = 0x003,
+  VL = 0xC20,
+  VType = 0xC21,
+  VLenB = 0xC22,
+  MHartId = 0xF14,
+};
+
+llvm::Value* readCSR(IRData& Data, uint32_t Number) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  switch (Number) {
+    case FFlags:
+    case Fcsr: {
+      B.CreateCall(Data.FloatFunctions[0], {statePtr(Data)});
+      llvm::Value *Value = B.CreateLoad(B.getInt32Ty(), Data.FCSRPtr);
+      return B.CreateAnd(Value, B.getInt32(Number == FFlags ? FFlagsMask : FFlagsMask | FrmMask));
+    }
+    case Frm:
+      return B.CreateLShr(B.CreateAnd(B.CreateLoad(B.getInt32Ty(), Data.FCSRPtr), B.getInt32(FrmMask)), FrmShift);
+    case VL:
+      return B.CreateLoad(B.getInt32Ty(), Data.VLPtr);
+    case VType:
+      return B.CreateLoad(B.getInt32Ty(), Data.VTypePtr);
+    case VLenB:
+      return B.getInt32(VectorBytes);
+    case MHartId:
+      return B.CreateLoad(B.getInt32Ty(), B.CreateStructGEP(Data.CPUStateTy, statePtr(Data), 8));
+    default:
+      return B.getInt32(0);
+  }
+}
+
+void writeCSR(IRData& Data, uint32_t Number, llvm::Value* Value) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *State = statePtr(Data);
+  switch (Number) {
+    case FFlags: {
+      B.CreateCall(Data.FloatFunctions[0], {State});
+      llvm::Value *Old = B.CreateAnd(B.CreateLoad(B.getInt32Ty(), Data.FCSRPtr), B.getInt32(FrmMask));
+      B.CreateStore(B.CreateOr(Old, B.CreateAnd(Value, B.getInt32(FFlagsMask))), Data.FCSRPtr);
+      break;
+    }
+    case Frm: {
+      llvm::Value *Old = B.CreateAnd(B.CreateLoad(B.getInt32Ty(), Data.FCSRPtr), B.getInt32(FFlagsMask));
+      llvm::Value *Mode = B.CreateAnd(B.CreateShl(Value, FrmShift), B.getInt32(FrmMask));
+      B.CreateStore(B.CreateOr(Old, Mode), Data.FCSRPtr);
+      B.CreateCall(Data.FloatFunctions[1], {State});
+      break;
+    }
+    case Fcsr:
+      B.CreateCall(Data.FloatFunctions[0], {State});
+      B.CreateStore(B.CreateAnd(Value, B.getInt32(FFlagsMask | FrmMask)), Data.FCSRPtr);
+      B.CreateCall(Data.FloatFunctions[1], {State});
+      break;
+  }
+}
+
+enum class CSROp { Write, Set, Clear };
+
+// The old value is read unless csrrw discards it into x0, and csrrs and
+// csrrc with x0 or a zero immediate only read.
+void buildCSR(IRData& Data, Instr InstrType, uint32_t InstructionData, CSROp Op, bool IsImmediate) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  uint32_t Number = immediate(InstrType, InstructionData);
+  uint32_t Rd = regDest(InstructionData);
+  uint32_t Rs1 = regSrc1(InstructionData);
+  llvm::Value *Source = IsImmediate ? B.getInt32(Rs1) : Data.readReg(Rs1);
+  llvm::Value *Old = Op != CSROp::Write || Rd != 0 ? readCSR(Data, Number) : nullptr;
+  if (Op == CSROp::Write)
+    writeCSR(Data, Number, Source);
+  else if (Rs1 != 0)
+    writeCSR(Data, Number, Op == CSROp::Set ? B.CreateOr(Old, Source) : B.CreateAnd(Old, B.CreateNot(Source)));
+  if (Old)
+    Data.writeReg(Rd, Old);
+}
+
+} // end anonymous namespace
+
+void FLWInstruction::build_ir(IRData& Data) { buildFloatLoad(Data, Instr::FLW, InstructionData, false); }
+void FSWInstruction::build_ir(IRData& Data) { buildFloatStore(Data, Instr::FSW, InstructionData, false); }
+void FLDInstruction::build_ir(IRData& Data) { buildFloatLoad(Data, Instr::FLD, InstructionData, true); }
+void FSDInstruction::build_ir(IRData& Data) { buildFloatStore(Data, Instr::FSD, InstructionData, true); }
+
+void FMADDSInstruction::build_ir(IRData& Data) { buildFloatFMA(Data, InstructionData, false, false, false); }
+void FMSUBSInstruction::build_ir(IRData& Data) { buildFloatFMA(Data, InstructionData, false, false, true); }
+void FNMSUBSInstruction::build_ir(IRData& Data) { buildFloatFMA(Data, InstructionData, false, true, false); }
+void FNMADDSInstruction::build_ir(IRData& Data) { buildFloatFMA(Data, InstructionData, false, true, true); }
+void FMADDDInstruction::build_ir(IRData& Data) { buildFloatFMA(Data, InstructionData, true, false, false); }
+void FMSUBDInstruction::build_ir(IRData& Data) { buildFloatFMA(Data, InstructionData, true, false, true); }
+void FNMSUBDInstruction::build_ir(IRData& Data) { buildFloatFMA(Data, InstructionData, true, true, false); }
+void FNMADDDInstruction::build_ir(IRData& Data) { buildFloatFMA(Data, InstructionData, true, true, true); }
+
+void FADDSInstruction::build_ir(IRData& Data) {
+  buildFloatBinary(Data, InstructionData, false, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateFAdd(L, R);
+  });
+}
+
+void FSUBSInstruction::build_ir(IRData& Data) {
+  buildFloatBinary(Data, InstructionData, false, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateFSub(L, R);
+  });
+}
+
+void FMULSInstruction::build_ir(IRData& Data) {
+  buildFloatBinary(Data, InstructionData, false, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateFMul(L, R);
+  });
+}
+
+void FDIVSInstruction::build_ir(IRData& Data) {
+  buildFloatBinary(Data, InstructionData, false, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateFDiv(L, R);
+  });
+}
+
+void FADDDInstruction::build_ir(IRData& Data) {
+  buildFloatBinary(Data, InstructionData, true, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateFAdd(L, R);
+  });
+}
+
+void FSUBDInstruction::build_ir(IRData& Data) {
+  buildFloatBinary(Data, InstructionData, true, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateFSub(L, R);
+  });
+}
+
+void FMULDInstruction::build_ir(IRData& Data) {
+  buildFloatBinary(Data, InstructionData, true, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateFMul(L, R);
+  });
+}
+
+void FDIVDInstruction::build_ir(IRData& Data) {
+  buildFloatBinary(Data, InstructionData, true, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateFDiv(L, R);
+  });
+}
+
+void FSQRTSInstruction::build_ir(IRData& Data) { buildFloatSqrt(Data, InstructionData, false); }
+void FSQRTDInstruction::build_ir(IRData& Data) { buildFloatSqrt(Data, InstructionData, true); }
+
+void FSGNJSInstruction::build_ir(IRData& Data) { buildSignInjection(Data, InstructionData, false, SignOp::Copy); }
+void FSGNJNSInstruction::build_ir(IRData& Data) { buildSignInjection(Data, InstructionData, false, SignOp::Negate); }
+void FSGNJXSInstruction::build_ir(IRData& Data) { buildSignInjection(Data, InstructionData, false, SignOp::Xor); }
+void FSGNJDInstruction::build_ir(IRData& Data) { buildSignInjection(Data, InstructionData, true, SignOp::Copy); }
+void FSGNJNDInstruction::build_ir(IRData& Data) { buildSignInjection(Data, InstructionData, true, SignOp::Negate); }
+void FSGNJXDInstruction::build_ir(IRData& Data) { buildSignInjection(Data, InstructionData, true, SignOp::Xor); }
+
+void FMINSInstruction::build_ir(IRData& Data) { buildFloatMinMax(Data, InstructionData, false, false); }
+void FMAXSInstruction::build_ir(IRData& Data) { buildFloatMinMax(Data, InstructionData, false, true); }
+void FMINDInstruction::build_ir(IRData& Data) { buildFloatMinMax(Data, InstructionData, true, false); }
+void FMAXDInstruction::build_ir(IRData& Data) { buildFloatMinMax(Data, InstructionData, true, true); }
+
+void FEQSInstruction::build_ir(IRData& Data) { buildFloatCompare(Data, InstructionData, false, llvm::CmpInst::FCMP_OEQ); }
+void FLTSInstruction::build_ir(IRData& Data) { buildFloatCompare(Data, InstructionData, false, llvm::CmpInst::FCMP_OLT); }
+void FLESInstruction::build_ir(IRData& Data) { buildFloatCompare(Data, InstructionData, false, llvm::CmpInst::FCMP_OLE); }
+void FEQDInstruction::build_ir(IRData& Data) { buildFloatCompare(Data, InstructionData, true, llvm::CmpInst::FCMP_OEQ); }
+void FLTDInstruction::build_ir(IRData& Data) { buildFloatCompare(Data, InstructionData, true, llvm::CmpInst::FCMP_OLT); }
+void FLEDInstruction::build_ir(IRData& Data) { buildFloatCompare(Data, InstructionData, true, llvm::CmpInst::FCMP_OLE); }
+
+void FCLASSSInstruction::build_ir(IRData& Data) { buildFloatClass(Data, InstructionData, false); }
+void FCLASSDInstruction::build_ir(IRData& Data) { buildFloatClass(Data, InstructionData, true); }
+
+void FCVTWSInstruction::build_ir(IRData& Data) { buildFloatToInt(Data, InstructionData, false, true); }
+void FCVTWUSInstruction::build_ir(IRData& Data) { buildFloatToInt(Data, InstructionData, false, false); }
+void FCVTWDInstruction::build_ir(IRData& Data) { buildFloatToInt(Data, InstructionData, true, true); }
+void FCVTWUDInstruction::build_ir(IRData& Data) { buildFloatToInt(Data, InstructionData, true, false); }
+void FCVTSWInstruction::build_ir(IRData& Data) { buildIntToFloat(Data, InstructionData, false, true); }
+void FCVTSWUInstruction::build_ir(IRData& Data) { buildIntToFloat(Data, InstructionData, false, false); }
+void FCVTDWInstruction::build_ir(IRData& Data) { buildIntToFloat(Data, InstructionData, true, true); }
+void FCVTDWUInstruction::build_ir(IRData& Data) { buildIntToFloat(Data, InstructionData, true, false); }
+
+void FCVTSDInstruction::build_ir(IRData& Data) {
+  StrictFP Strict(Data);
+  llvm::Value *Source = readFloat(Data, regSrc1(InstructionData), true);
+  withRounding(Data, InstructionData, [&] {
+    writeFloat(Data, regDest(InstructionData), Data.Builder.CreateFPTrunc(Source, Data.Builder.getFloatTy()), false);
+  });
+}
+
+void FCVTDSInstruction::build_ir(IRData& Data) {
+  StrictFP Strict(Data);
+  llvm::Value *Source = readFloat(Data, regSrc1(InstructionData), false);
+  writeFloat(Data, regDest(InstructionData), Data.Builder.CreateFPExt(Source, Data.Builder.getDoubleTy()), true);
+}
+
+// fmv moves the low 32 bits unchanged, without checking the NaN-boxing.
+void FMVXWInstruction::build_ir(IRData& Data) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *Bits = B.CreateLoad(B.getInt64Ty(), floatReg(Data, regSrc1(InstructionData)));
+  Data.writeReg(regDest(InstructionData), B.CreateTrunc(Bits, B.getInt32Ty()));
+}
+
+void FMVWXInstruction::build_ir(IRData& Data) {
+  writeFloatBits(Data, regDest(InstructionData), Data.readReg(regSrc1(InstructionData)));
+}
+
+void CSRRWInstruction::build_ir(IRData& Data) { buildCSR(Data, Instr::CSRRW, InstructionData, CSROp::Write, false); }
+void CSRRSInstruction::build_ir(IRData& Data) { buildCSR(Data, Instr::CSRRS, InstructionData, CSROp::Set, false); }
+void CSRRCInstruction::build_ir(IRData& Data) { buildCSR(Data, Instr::CSRRC, InstructionData, CSROp::Clear, false); }
+void CSRRWIInstruction::build_ir(IRData& Data) { buildCSR(Data, Instr::CSRRWI, InstructionData, CSROp::Write, true); }
+void CSRRSIInstruction::build_ir(IRData& Data) { buildCSR(Data, Instr::CSRRSI, InstructionData, CSROp::Set, true); }
+void CSRRCIInstruction::build_ir(IRData& Data) { buildCSR(Data, Instr::CSRRCI, InstructionData, CSROp::Clear, true); }
+
+} // end namespace riscv
@@ -0,0 +1,70 @@
+#include "FloatEnv.h"
+#include <llvm/ExecutionEngine/Orc/AbsoluteSymbols.h>
+
+namespace riscv {
+
+namespace {
+
+int hostRounding(uint32_t Mode) {
+  switch (Mode) {
+    case 1: return FE_TOWARDZERO;
+    case 2: return FE_DOWNWARD;
+    case 3: return FE_UPWARD;
+    default: return FE_TONEAREST;
+  }
+}
+
+// The raised host flags as fflags.
+uint32_t raisedFlags() {
+  int Raised = std::fetestexcept(FE_ALL_EXCEPT);
+  return (Raised & FE_INVALID ? FlagInvalid : 0) | (Raised & FE_DIVBYZERO ? FlagDivByZero : 0) |
+         (Raised & FE_OVERFLOW ? FlagOverflow : 0) | (Raised & FE_UNDERFLOW ? FlagUnderflow : 0) |
+         (Raised & FE_INEXACT ? FlagInexact : 0);
+}
+
+} // end anonymous namespace
+
+void enterGuestFloat(CPUState const& State) {
+  std::feclearexcept(FE_ALL_EXCEPT);
+  std::fesetround(hostRounding((State.FCSR & FrmMask) >> FrmShift));
+}
+
+void leaveGuestFloat(CPUState& State) {
+  syncFloatFlags(&State);
+  std::fesetround(FE_TONEAREST);
+}
+
+void syncFloatFlags(CPUState* State) {
+  State->FCSR |= raisedFlags();
+  std::feclearexcept(FE_ALL_EXCEPT);
+}
+
+void applyRoundingMode(CPUState* State) {
+  std::fesetround(hostRounding((State->FCSR & FrmMask) >> FrmShift));
+}
+
+void setRoundingMode(uint32_t Mode) {
+  std::fesetround(hostRounding(Mode));
+}
+
+HostFloatScope::HostFloatScope() {
+  std::feholdexcept(&Saved);
+  std::fesetround(FE_TONEAREST);
+}
+
+HostFloatScope::~HostFloatScope() {
+  std::fesetenv(&Saved);
+}
+
+llvm::Error addHostFloatRuntime(llvm::orc::LLJIT& JIT) {
+  auto Symbol = [](auto* Function) {
+    return llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(Function), llvm::JITSymbolFlags::Exported);
+  };
+  return JIT.getMainJITDylib().define(llvm::orc::absoluteSymbols({
+      {JIT.mangleAndIntern(SyncFloatFlagsSymbol), Symbol(&syncFloatFlags)},
+      {JIT.mangleAndIntern(ApplyRoundingSymbol), Symbol(&applyRoundingMode)},
+      {JIT.mangleAndIntern(SetRoundingSymbol), Symbol(&setRoundingMode)},
+  }));
+}
+
+} // end namespace riscv
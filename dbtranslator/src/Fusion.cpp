@@ -0,0 +1,137 @@
+// Peephole fusion of two-instruction idioms. The second instruction of an
+// UpperImmediate pair is still emitted by its own build_ir(), with
+// IRData::Forwarded handing it the constant the first produced, so the
+// IRBuilder folds its address or jump target while building it. A far call
+// (AUIPC+JALR) thus ends its block with a constant PC, like JAL.
+
+#include "Fusion.h"
+#include <llvm/IR/IRBuilder.h>
+
+namespace riscv {
+
+namespace {
+
+// Instructions whose rs1 is a base or operand that a LUI or AUIPC just set.
+bool usesUpperBase(Instr I) {
+  switch (I) {
+    case Instr::ADDI:
+    case Instr::JALR:
+    case Instr::LB:
+    case Instr::LH:
+    case Instr::LW:
+    case Instr::LBU:
+    case Instr::LHU:
+    case Instr::SB:
+    case Instr::SH:
+    case Instr::SW:
+    case Instr::FLW:
+    case Instr::FSW:
+    case Instr::FLD:
+    case Instr::FSD:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool writesRegDest(Instr I) {
+  switch (I) {
+    case Instr::ADDI:
+    case Instr::JALR:
+    case Instr::LB:
+    case Instr::LH:
+    case Instr::LW:
+    case Instr::LBU:
+    case Instr::LHU:
+      return true;
+    default:
+      return false;
+  }
+}
+
+std::optional<llvm::CmpInst::Predicate> comparison(Instr I) {
+  switch (I) {
+    case Instr::SLT:
+    case Instr::SLTI:
+      return llvm::CmpInst::ICMP_SLT;
+    case Instr::SLTU:
+    case Instr::SLTIU:
+      return llvm::CmpInst::ICMP_ULT;
+    default:
+      return std::nullopt;
+  }
+}
+
+} // end anonymous namespace
+
+Fusion matchFusion(Instr First, uint32_t FirstData, Instr Second, uint32_t SecondData) {
+  uint32_t Rd = regDest(FirstData);
+  if (Rd == 0)
+    return Fusion::None;
+  if ((First == Instr::LUI || First == Instr::AUIPC) && usesUpperBase(Second) && regSrc1(SecondData) == Rd)
+    return Fusion::UpperImmediate;
+  if (comparison(First) && (Second == Instr::BEQ || Second == Instr::BNE)) {
+    uint32_t Rs1 = regSrc1(SecondData);
+    uint32_t Rs2 = regSrc2(SecondData);
+    if ((Rs1 == Rd && Rs2 == 0) || (Rs1 == 0 && Rs2 == Rd))
+      return Fusion::CompareBranch;
+  }
+  return Fusion::None;
+}
+
+uint32_t upperImmediate(Instr First, uint32_t FirstData, uint32_t PC) {
+  uint32_t Imm = immediate(First, FirstData);
+  return First == Instr::AUIPC ? PC + Imm : Imm;
+}
+
+bool overwritesUpper(uint32_t FirstData, Instr Second, uint32_t SecondData) {
+  return writesRegDest(Second) && regDest(SecondData) == regDest(FirstData);
+}
+
+std::optional<uint32_t> fusedJumpTarget(Instr First, uint32_t FirstData, uint32_t PC, Instr Second,
+                                        uint32_t SecondData) {
+  if (Second != Instr::JALR || matchFusion(First, FirstData, Second, SecondData) != Fusion::UpperImmediate)
+    return std::nullopt;
+  return (upperImmediate(First, FirstData, PC) + immediate(Instr::JALR, SecondData)) & ~1U;
+}
+
+void buildFusion(IRData& Data, Fusion Kind, Instr First, uint32_t FirstData, Instr Second, uint32_t SecondData,
+                 uint32_t SecondLength) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  uint32_t Rd = regDest(FirstData);
+  switch (Kind) {
+    case Fusion::UpperImmediate: {
+      llvm::Value *Upper = B.getInt32(upperImmediate(First, FirstData, Data.PC));
+      if (!overwritesUpper(FirstData, Second, SecondData))
+        Data.writeReg(Rd, Upper);
+      Data.PC = Data.nextPC();
+      Data.Length = SecondLength;
+      Data.Forwarded = {Rd, Upper};
+      generate(Second, SecondData, Data);
+      Data.Forwarded.reset();
+      return;
+    }
+    case Fusion::CompareBranch: {
+      llvm::Value *L = Data.readReg(regSrc1(FirstData));
+      llvm::Value *R = First == Instr::SLT || First == Instr::SLTU ? Data.readReg(regSrc2(FirstData))
+                                                                   : B.getInt32(immediate(First, FirstData));
+      llvm::Value *Cond = B.CreateICmp(*comparison(First), L, R);
+      Data.writeReg(Rd, B.CreateZExt(Cond, B.getInt32Ty()));
+      Data.PC = Data.nextPC();
+      Data.Length = SecondLength;
+      if (Second == Instr::BEQ)
+        Cond = B.CreateNot(Cond);
+      uint32_t Target = Data.PC + immediate(Second, SecondData);
+      Data.writePC(B.CreateSelect(Cond, B.getInt32(Target), B.getInt32(Data.nextPC())));
+      return;
+    }
+    case Fusion::None:
+      generate(First, FirstData, Data);
+      Data.PC = Data.nextPC();
+      Data.Length = SecondLength;
+      generate(Second, SecondData, Data);
+      return;
+  }
+}
+
+} // end namespace riscv
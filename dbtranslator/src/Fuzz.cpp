@@ -0,0 +1,126 @@
+#include "Fuzz.h"
+#include <algorithm>
+#include <cstring>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+
+namespace riscv {
+
+llvm::Expected<std::unique_ptr<FuzzSession>> FuzzSession::create(Options Opts, llvm::ArrayRef<std::string> InputPaths) {
+  std::vector<std::string> Files;
+  for (std::string const& Path : InputPaths) {
+    if (!llvm::sys::fs::is_directory(Path)) {
+      Files.push_back(Path);
+      continue;
+    }
+    std::error_code EC;
+    std::vector<std::string> Entries;
+    for (llvm::sys::fs::directory_iterator It(Path, EC), End; It != End && !EC; It.increment(EC)) {
+      if (llvm::sys::fs::is_regular_file(It->path()))
+        Entries.push_back(It->path());
+    }
+    if (EC)
+      return llvm::createFileError(Path, EC);
+    std::sort(Entries.begin(), Entries.end());
+    Files.insert(Files.end(), Entries.begin(), Entries.end());
+  }
+  if (Files.empty())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), "no fuzz inputs");
+
+  std::unique_ptr<FuzzSession> Session(new FuzzSession(Opts));
+  for (std::string const& File : Files) {
+    auto Input = llvm::MemoryBuffer::getFile(File, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!Input)
+      return llvm::createFileError(File, Input.getError());
+    Session->Inputs.push_back(std::move(*Input));
+  }
+  return std::move(Session);
+}
+
+llvm::Error FuzzSession::start(CPUState& State) {
+  MemoryManager* Manager = State.Manager;
+  uint8_t* Buffer = mapAddress<uint8_t>(Manager, Opts.InputAddr);
+  if (!Opts.MaxInputSize || !Buffer ||
+      mapAddress<uint8_t>(Manager, Opts.InputAddr + Opts.MaxInputSize - 1) != Buffer + Opts.MaxInputSize - 1)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), "the fuzz input buffer is not mapped guest memory");
+
+  Saved = State;
+  for (uint32_t I = 0; I < Manager->NumSegments; ++I) {
+    SegmentManager const& Segment = Manager->SegmentData[I];
+    SavedSegments.emplace_back(Segment.Memory, Segment.Memory + Segment.MemorySize);
+  }
+  DirtyPages.reset(new uint8_t[PageBitmapBytes]());
+  DirtyList.reset(new uint32_t[PageBitmapBytes * 8]);
+  Manager->DirtyPages = DirtyPages.get();
+  Manager->DirtyList = DirtyList.get();
+  Manager->NumDirty = 0;
+  for (uint32_t I = 0; I < Manager->NumSegments; ++I) {
+    SegmentManager const& Segment = Manager->SegmentData[I];
+    if (!Segment.MemorySize)
+      continue;
+    uint32_t First = Segment.GuestAddress >> GuestPageShift;
+    uint32_t Last = (Segment.GuestAddress + Segment.MemorySize - 1) >> GuestPageShift;
+    for (uint32_t Page = First; Page <= Last; ++Page)
+      setPage(Manager->WatchedPages, Page);
+  }
+
+  Start = std::chrono::steady_clock::now();
+  load(State, *Inputs[NextInput++]);
+  return llvm::Error::success();
+}
+
+bool FuzzSession::next(CPUState& State) {
+  ++Runs;
+  if (NextInput == Inputs.size())
+    return false;
+
+  MemoryManager* Manager = State.Manager;
+  for (uint32_t I = 0; I < Manager->NumDirty; ++I) {
+    uint32_t Page = Manager->DirtyList[I];
+    uint64_t PageBegin = uint64_t(Page) << GuestPageShift;
+    uint64_t PageEnd = PageBegin + (uint64_t(1) << GuestPageShift);
+    for (uint32_t S = 0; S < Manager->NumSegments; ++S) {
+      SegmentManager const& Segment = Manager->SegmentData[S];
+      uint64_t Begin = std::max<uint64_t>(PageBegin, Segment.GuestAddress);
+      uint64_t End = std::min<uint64_t>(PageEnd, uint64_t(Segment.GuestAddress) + Segment.MemorySize);
+      if (Begin < End)
+        std::memcpy(Segment.Memory + (Begin - Segment.GuestAddress),
+                    SavedSegments[S].data() + (Begin - Segment.GuestAddress), End - Begin);
+    }
+    // Restored code bytes are a code write like any other.
+    if (testPage(Manager->CodePages, Page)) {
+      setPage(Manager->WrittenCodePages, Page);
+      std::atomic_ref<uint32_t>(Manager->CodeWritten).store(1, std::memory_order_release);
+    }
+    clearPage(Manager->DirtyPages, Page);
+    updateWatch(Manager, Page);
+  }
+  RestoredPages += Manager->NumDirty;
+  Manager->NumDirty = 0;
+
+  State = Saved;
+  load(State, *Inputs[NextInput++]);
+  return true;
+}
+
+void FuzzSession::load(CPUState& State, llvm::MemoryBuffer const& Input) {
+  uint32_t Size = std::min<size_t>(Input.getBufferSize(), Opts.MaxInputSize);
+  std::memcpy(mapAddress<uint8_t>(State.Manager, Opts.InputAddr), Input.getBufferStart(), Size);
+  // Written behind the store path's back, so the pages are marked here.
+  if (Size) {
+    for (uint32_t Page = Opts.InputAddr >> GuestPageShift; Page <= (Opts.InputAddr + Size - 1) >> GuestPageShift; ++Page)
+      noteWatchedStore(State.Manager, Page);
+  }
+  State.Registers[10] = Opts.InputAddr;
+  State.Registers[11] = Size;
+}
+
+void FuzzSession::printStats(llvm::raw_ostream& OS) const {
+  double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+  OS << "fuzz: " << Runs << " runs in " << llvm::format("%.3f", Seconds) << " s ("
+     << llvm::format("%.0f", Seconds > 0 ? Runs / Seconds : 0.0) << " runs/s), "
+     << llvm::format("%.1f", Runs ? double(RestoredPages) / Runs : 0.0) << " pages restored per run\n";
+}
+
+} // end namespace riscv
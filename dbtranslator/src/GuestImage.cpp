@@ -0,0 +1,126 @@
+#include "GuestImage.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace riscv {
+
+namespace {
+
+uint64_t alignTo(uint64_t Value, uint64_t Align) {
+  return (Value + Align - 1) / Align * Align;
+}
+
+llvm::Error lastError(llvm::StringRef What) {
+  return llvm::createStringError(std::error_code(errno, std::generic_category()), "%s", What.str().c_str());
+}
+
+} // end anonymous namespace
+
+llvm::Expected<std::unique_ptr<GuestImage>> GuestImage::create(llvm::StringRef ElfPath) {
+  if (!llvm::sys::fs::exists(ElfPath))
+    return llvm::createFileError(ElfPath, std::make_error_code(std::errc::no_such_file_or_directory));
+  std::unique_ptr<GuestImage> Image(new GuestImage());
+  Image->Pristine = parseElf(ElfPath.str().c_str(), false).first;
+  Image->Info = parseElfCode(ElfPath.str().c_str());
+
+  Image->FD = ::memfd_create("dbtranslator-image", MFD_CLOEXEC);
+  if (Image->FD < 0)
+    return lastError("memfd_create");
+  // Segments start page-aligned; the zero-filled stack stays a hole.
+  uint64_t PageSize = llvm::sys::fs::mapped_file_region::alignment();
+  uint64_t Offset = 0;
+  MemoryManager const& Manager = *Image->Pristine;
+  for (uint32_t I = 0; I < Manager.NumSegments; ++I) {
+    Image->Offsets.push_back(Offset);
+    Offset = alignTo(Offset + Manager.SegmentData[I].MemorySize, PageSize);
+  }
+  if (::ftruncate(Image->FD, Offset) < 0)
+    return lastError("ftruncate");
+  for (uint32_t I = 0; I + 1 < Manager.NumSegments; ++I) {
+    SegmentManager const& Segment = Manager.SegmentData[I];
+    for (uint64_t Done = 0; Done < Segment.MemorySize;) {
+      ssize_t Written = ::pwrite(Image->FD, Segment.Memory + Done, Segment.MemorySize - Done, Image->Offsets[I] + Done);
+      if (Written <= 0)
+        return lastError("pwrite");
+      Done += Written;
+    }
+  }
+  return std::move(Image);
+}
+
+GuestImage::~GuestImage() {
+  if (FD >= 0)
+    ::close(FD);
+  if (Pristine)
+    freeElf(Pristine);
+}
+
+bool GuestImage::isCode(uint32_t PC) const {
+  for (CodeRegion const& Region : Info.ExecutableRegions) {
+    if (Region.Begin <= PC && PC < Region.End)
+      return true;
+  }
+  return false;
+}
+
+llvm::Expected<std::unique_ptr<GuestMemory>> GuestImage::instantiate() const {
+  std::unique_ptr<GuestMemory> Memory(new GuestMemory());
+  Memory->Segments.resize(Pristine->NumSegments);
+  for (uint32_t I = 0; I < Pristine->NumSegments; ++I) {
+    SegmentManager& Segment = Memory->Segments[I];
+    Segment = Pristine->SegmentData[I];
+    Segment.Memory = nullptr;
+    if (!Segment.MemorySize)
+      continue;
+    std::error_code EC;
+    llvm::sys::fs::mapped_file_region Mapping(FD, llvm::sys::fs::mapped_file_region::priv, Segment.MemorySize,
+                                              Offsets[I], EC);
+    if (EC)
+      return llvm::createStringError(EC, "cannot map guest segment %u", I);
+    Segment.Memory = reinterpret_cast<uint8_t*>(Mapping.data());
+    Memory->Mappings.push_back(std::move(Mapping));
+  }
+  Memory->WatchedPages.reset(new uint8_t[PageBitmapBytes]());
+  Memory->CodePages.reset(new uint8_t[PageBitmapBytes]());
+  Memory->WrittenCodePages.reset(new uint8_t[PageBitmapBytes]());
+  Memory->Manager = {Memory->Segments.data(), static_cast<uint32_t>(Memory->Segments.size()),
+                     Memory->WatchedPages.get(), Memory->CodePages.get(), Memory->WrittenCodePages.get(),
+                     0, nullptr, nullptr, 0};
+  markCode(Memory->manager());
+  return std::move(Memory);
+}
+
+void GuestImage::markCode(MemoryManager* Manager) const {
+  for (CodeRegion const& Region : Info.ExecutableRegions) {
+    if (Region.Begin == Region.End)
+      continue;
+    for (uint32_t Page = Region.Begin >> GuestPageShift; Page <= (Region.End - 1) >> GuestPageShift; ++Page) {
+      setPage(Manager->CodePages, Page);
+      setPage(Manager->WatchedPages, Page);
+      clearPage(Manager->WrittenCodePages, Page);
+    }
+  }
+}
+
+bool GuestImage::sameCode(MemoryManager* Manager, bool OnlyWritten) const {
+  for (CodeRegion const& Region : Info.ExecutableRegions) {
+    if (Region.Begin == Region.End)
+      continue;
+    for (uint32_t Page = Region.Begin >> GuestPageShift; Page <= (Region.End - 1) >> GuestPageShift; ++Page) {
+      if (OnlyWritten && !testPage(Manager->WrittenCodePages, Page))
+        continue;
+      uint32_t Begin = std::max(Region.Begin, Page << GuestPageShift);
+      uint32_t End = std::min<uint64_t>(Region.End, (uint64_t(Page) + 1) << GuestPageShift);
+      uint8_t const* Expected = mapAddress<uint8_t>(Pristine, Begin);
+      uint8_t const* Actual = mapAddress<uint8_t>(Manager, Begin);
+      if (!Expected || !Actual || mapAddress<uint8_t>(Manager, End - 1) != Actual + (End - 1 - Begin) ||
+          std::memcmp(Expected, Actual, End - Begin) != 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+} // end namespace riscv
@@ -0,0 +1,36 @@
+#include "Harts.h"
+#include <thread>
+#include <utility>
+#include <llvm/ExecutionEngine/Orc/AbsoluteSymbols.h>
+
+namespace riscv {
+
+namespace {
+
+thread_local bool Paused = false;
+
+} // end anonymous namespace
+
+void spinPause() {
+  Paused = true;
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#else
+  std::this_thread::yield();
+#endif
+}
+
+bool takePause() {
+  return std::exchange(Paused, false);
+}
+
+llvm::Error addHostHartRuntime(llvm::orc::LLJIT& JIT) {
+  return JIT.getMainJITDylib().define(llvm::orc::absoluteSymbols({
+      {JIT.mangleAndIntern(PauseSymbol),
+       llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(&spinPause), llvm::JITSymbolFlags::Exported)},
+  }));
+}
+
+} // end namespace riscv
@@ -1,6 +1,7 @@
 #include "Instruction.h"
 #include "CPU.h"
 #include <cstdint>
+#include <llvm/IR/Intrinsics.h>
 #include <llvm-20/llvm/IR/Value.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/Support/raw_ostream.h>
@@ -9,17 +10,149 @@ namespace riscv {
 
 namespace {
 
-static void updatePC(IRData& Data) {
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *CPUArg = Data.CurrentFunction->getArg(0);
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);  
-  llvm::Value *NewPCVal = Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4));
-  Data.Builder.CreateStore(NewPCVal, PCPtr);
+void buildBranch(IRData& Data, Instr InstrType, uint32_t InstructionData, llvm::CmpInst::Predicate Pred) {
+  llvm::Value *Cond = Data.Builder.CreateICmp(Pred, Data.readReg(regSrc1(InstructionData)),
+                                             Data.readReg(regSrc2(InstructionData)));
+  uint32_t Target = Data.PC + immediate(InstrType, InstructionData);
+  Data.writePC(Data.Builder.CreateSelect(Cond, Data.Builder.getInt32(Target), Data.Builder.getInt32(Data.nextPC())));
+}
+
+void buildLoad(IRData& Data, Instr InstrType, uint32_t InstructionData, unsigned Bytes, bool Signed) {
+  llvm::Value *Address = Data.Builder.CreateAdd(Data.readReg(regSrc1(InstructionData)),
+                                                Data.Builder.getInt32(immediate(InstrType, InstructionData)));
+  llvm::Value *Value = Data.readMemory(Bytes, Address);
+  Data.writeReg(regDest(InstructionData), Signed ? Data.Builder.CreateSExt(Value, Data.Builder.getInt32Ty())
+                                                 : Data.Builder.CreateZExt(Value, Data.Builder.getInt32Ty()));
+}
+
+void buildStore(IRData& Data, Instr InstrType, uint32_t InstructionData, unsigned Bytes) {
+  llvm::Value *Address = Data.Builder.CreateAdd(Data.readReg(regSrc1(InstructionData)),
+                                                Data.Builder.getInt32(immediate(InstrType, InstructionData)));
+  Data.writeMemory(Bytes, Address, Data.readReg(regSrc2(InstructionData)));
+}
+
+using BinaryOp = llvm::Value* (*)(llvm::IRBuilder<>&, llvm::Value*, llvm::Value*);
+
+void buildRegImm(IRData& Data, Instr InstrType, uint32_t InstructionData, BinaryOp Op) {
+  llvm::Value *Imm = Data.Builder.getInt32(immediate(InstrType, InstructionData));
+  Data.writeReg(regDest(InstructionData), Op(Data.Builder, Data.readReg(regSrc1(InstructionData)), Imm));
+}
+
+void buildRegReg(IRData& Data, uint32_t InstructionData, BinaryOp Op) {
+  Data.writeReg(regDest(InstructionData), Op(Data.Builder, Data.readReg(regSrc1(InstructionData)),
+                                             Data.readReg(regSrc2(InstructionData))));
+}
+
+using UnaryOp = llvm::Value* (*)(llvm::IRBuilder<>&, llvm::Value*);
+
+void buildUnary(IRData& Data, uint32_t InstructionData, UnaryOp Op) {
+  Data.writeReg(regDest(InstructionData), Op(Data.Builder, Data.readReg(regSrc1(InstructionData))));
+}
+
+// Register shifts only use the low five bits of rs2.
+llvm::Value* shiftAmount(llvm::IRBuilder<>& B, llvm::Value* Amount) {
+  return B.CreateAnd(Amount, B.getInt32(0x1F));
+}
+
+// High 32 bits of the 64-bit product, with each operand sign- or
+// zero-extended.
+llvm::Value* multiplyHigh(llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R, bool SignedL, bool SignedR) {
+  llvm::Value *WideL = SignedL ? B.CreateSExt(L, B.getInt64Ty()) : B.CreateZExt(L, B.getInt64Ty());
+  llvm::Value *WideR = SignedR ? B.CreateSExt(R, B.getInt64Ty()) : B.CreateZExt(R, B.getInt64Ty());
+  return B.CreateTrunc(B.CreateLShr(B.CreateMul(WideL, WideR), 32), B.getInt32Ty());
+}
+
+// Single-bit mask for the Zbs instructions: 1 << (Index & 31).
+llvm::Value* bitMask(llvm::IRBuilder<>& B, llvm::Value* Index) {
+  return B.CreateShl(B.getInt32(1), shiftAmount(B, Index));
+}
+
+// RISC-V division never traps: x / 0 gives all ones (x % 0 gives x) and
+// INT_MIN / -1 gives INT_MIN (remainder 0). Both cases divide by 1 instead,
+// which already yields the overflow results, and division by zero selects
+// its result afterwards. The divisor is picked with a select, so there is
+// no branch on the common path.
+llvm::Value* safeDivisor(llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R, bool Signed) {
+  llvm::Value *Special = B.CreateICmpEQ(R, B.getInt32(0));
+  if (Signed)
+    Special = B.CreateOr(Special, B.CreateAnd(B.CreateICmpEQ(L, B.getInt32(0x80000000)),
+                                              B.CreateICmpEQ(R, B.getInt32(0xFFFFFFFF))));
+  return B.CreateSelect(Special, B.getInt32(1), R);
 }
 
 } // end anonymous namespace
-  
+
+IRData::IRData(llvm::Module& M, llvm::IRBuilder<>& B, llvm::Function* F)
+    : Module(M), Builder(B), CurrentFunction(F) {
+  llvm::LLVMContext& Ctx = B.getContext();
+  CPUStateTy = llvm::cast<llvm::StructType>(getCPUStateType(Ctx));
+  RegsArrTy = llvm::ArrayType::get(B.getInt32Ty(), constants::REG_SIZE);
+  llvm::Value *CPUArg = F->getArg(0);
+  RegsPtr = B.CreateStructGEP(CPUStateTy, CPUArg, 0);
+  PCPtr = B.CreateStructGEP(CPUStateTy, CPUArg, 1);
+  MemoryManagerPtr = B.CreateLoad(B.getPtrTy(), B.CreateStructGEP(CPUStateTy, CPUArg, 2));
+  VLPtr = B.CreateStructGEP(CPUStateTy, CPUArg, 3);
+  VTypePtr = B.CreateStructGEP(CPUStateTy, CPUArg, 4);
+  VectorRegsPtr = B.CreateStructGEP(CPUStateTy, CPUArg, 5);
+  FloatRegsPtr = B.CreateStructGEP(CPUStateTy, CPUArg, 6);
+  FCSRPtr = B.CreateStructGEP(CPUStateTy, CPUArg, 7);
+}
+
+llvm::Value* IRData::readReg(uint32_t Reg) {
+  if (Reg == 0)
+    return Builder.getInt32(0);
+  if (Forwarded && Forwarded->first == Reg)
+    return Forwarded->second;
+  llvm::Value *RegPtr = Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr, {Builder.getInt32(0), Builder.getInt32(Reg)});
+  return Builder.CreateLoad(Builder.getInt32Ty(), RegPtr);
+}
+
+void IRData::writeReg(uint32_t Reg, llvm::Value* Value) {
+  if (Reg == 0)
+    return;
+  llvm::Value *RegPtr = Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr, {Builder.getInt32(0), Builder.getInt32(Reg)});
+  Builder.CreateStore(Value, RegPtr);
+}
+
+void IRData::writePC(llvm::Value* Value) {
+  Builder.CreateStore(Value, PCPtr);
+}
+
+llvm::Value* IRData::readMemory(unsigned Bytes, llvm::Value* Address) {
+  unsigned Index = Bytes == 1 ? 0 : Bytes == 2 ? 1 : 2;
+  return Builder.CreateCall(MemoryFunctions[Index], {MemoryManagerPtr, Address});
+}
+
+void IRData::writeMemory(unsigned Bytes, llvm::Value* Address, llvm::Value* Value) {
+  unsigned Index = Bytes == 1 ? 3 : Bytes == 2 ? 4 : 5;
+  Value = Builder.CreateTrunc(Value, Builder.getIntNTy(Bytes * 8));
+  Builder.CreateCall(MemoryFunctions[Index], {MemoryManagerPtr, Address, Value});
+}
+
+llvm::Value* IRData::vectorReg(uint32_t Reg) {
+  return Builder.CreateConstInBoundsGEP2_32(CPUStateTy->getElementType(5), VectorRegsPtr, 0, Reg);
+}
+
+void IRData::readVectorMemory(uint32_t Reg, llvm::Value* Address, llvm::Value* Stride, unsigned Bytes,
+                              llvm::Value* Mask) {
+  Builder.CreateCall(MemoryFunctions[6], {MemoryManagerPtr, Address, Stride, Builder.getInt32(Bytes), Mask,
+                                          vectorReg(Reg)});
+}
+
+void IRData::writeVectorMemory(uint32_t Reg, llvm::Value* Address, llvm::Value* Stride, unsigned Bytes,
+                               llvm::Value* Mask) {
+  Builder.CreateCall(MemoryFunctions[7], {MemoryManagerPtr, Address, Stride, Builder.getInt32(Bytes), Mask,
+                                          vectorReg(Reg)});
+}
+
+llvm::Value* IRData::atomicAddress(llvm::Value* Address) {
+  return Builder.CreateCall(MemoryFunctions[8], {MemoryManagerPtr, Address});
+}
+
+void IRData::atomicStored(llvm::Value* Address) {
+  Builder.CreateCall(MemoryFunctions[9], {MemoryManagerPtr, Address});
+}
+
 char const* InstrToLiteral(Instr I) {
   switch (I) {
   case Instr::UNKNOWN:
@@ -98,6 +231,310 @@ char const* InstrToLiteral(Instr I) {
     return "OR";
   case Instr::AND:
     return "AND";
+  case Instr::MUL:
+    return "MUL";
+  case Instr::MULH:
+    return "MULH";
+  case Instr::MULHSU:
+    return "MULHSU";
+  case Instr::MULHU:
+    return "MULHU";
+  case Instr::DIV:
+    return "DIV";
+  case Instr::DIVU:
+    return "DIVU";
+  case Instr::REM:
+    return "REM";
+  case Instr::REMU:
+    return "REMU";
+  case Instr::SH1ADD:
+    return "SH1ADD";
+  case Instr::SH2ADD:
+    return "SH2ADD";
+  case Instr::SH3ADD:
+    return "SH3ADD";
+  case Instr::ANDN:
+    return "ANDN";
+  case Instr::ORN:
+    return "ORN";
+  case Instr::XNOR:
+    return "XNOR";
+  case Instr::CLZ:
+    return "CLZ";
+  case Instr::CTZ:
+    return "CTZ";
+  case Instr::CPOP:
+    return "CPOP";
+  case Instr::MAX:
+    return "MAX";
+  case Instr::MAXU:
+    return "MAXU";
+  case Instr::MIN:
+    return "MIN";
+  case Instr::MINU:
+    return "MINU";
+  case Instr::SEXTB:
+    return "SEXT.B";
+  case Instr::SEXTH:
+    return "SEXT.H";
+  case Instr::ZEXTH:
+    return "ZEXT.H";
+  case Instr::ROL:
+    return "ROL";
+  case Instr::ROR:
+    return "ROR";
+  case Instr::RORI:
+    return "RORI";
+  case Instr::ORCB:
+    return "ORC.B";
+  case Instr::REV8:
+    return "REV8";
+  case Instr::BCLR:
+    return "BCLR";
+  case Instr::BCLRI:
+    return "BCLRI";
+  case Instr::BEXT:
+    return "BEXT";
+  case Instr::BEXTI:
+    return "BEXTI";
+  case Instr::BINV:
+    return "BINV";
+  case Instr::BINVI:
+    return "BINVI";
+  case Instr::BSET:
+    return "BSET";
+  case Instr::BSETI:
+    return "BSETI";
+  case Instr::VSETVLI:
+    return "VSETVLI";
+  case Instr::VSETIVLI:
+    return "VSETIVLI";
+  case Instr::VSETVL:
+    return "VSETVL";
+  case Instr::VLE8:
+    return "VLE8.V";
+  case Instr::VLE16:
+    return "VLE16.V";
+  case Instr::VLE32:
+    return "VLE32.V";
+  case Instr::VLSE8:
+    return "VLSE8.V";
+  case Instr::VLSE16:
+    return "VLSE16.V";
+  case Instr::VLSE32:
+    return "VLSE32.V";
+  case Instr::VSE8:
+    return "VSE8.V";
+  case Instr::VSE16:
+    return "VSE16.V";
+  case Instr::VSE32:
+    return "VSE32.V";
+  case Instr::VSSE8:
+    return "VSSE8.V";
+  case Instr::VSSE16:
+    return "VSSE16.V";
+  case Instr::VSSE32:
+    return "VSSE32.V";
+  case Instr::VADDVV:
+    return "VADD.VV";
+  case Instr::VADDVX:
+    return "VADD.VX";
+  case Instr::VADDVI:
+    return "VADD.VI";
+  case Instr::VSUBVV:
+    return "VSUB.VV";
+  case Instr::VSUBVX:
+    return "VSUB.VX";
+  case Instr::VRSUBVX:
+    return "VRSUB.VX";
+  case Instr::VRSUBVI:
+    return "VRSUB.VI";
+  case Instr::VMULVV:
+    return "VMUL.VV";
+  case Instr::VMULVX:
+    return "VMUL.VX";
+  case Instr::VANDVV:
+    return "VAND.VV";
+  case Instr::VANDVX:
+    return "VAND.VX";
+  case Instr::VANDVI:
+    return "VAND.VI";
+  case Instr::VORVV:
+    return "VOR.VV";
+  case Instr::VORVX:
+    return "VOR.VX";
+  case Instr::VORVI:
+    return "VOR.VI";
+  case Instr::VXORVV:
+    return "VXOR.VV";
+  case Instr::VXORVX:
+    return "VXOR.VX";
+  case Instr::VXORVI:
+    return "VXOR.VI";
+  case Instr::VMVVV:
+    return "VMV.V.V";
+  case Instr::VMVVX:
+    return "VMV.V.X";
+  case Instr::VMVVI:
+    return "VMV.V.I";
+  case Instr::VMVXS:
+    return "VMV.X.S";
+  case Instr::VMVSX:
+    return "VMV.S.X";
+  case Instr::VREDSUM:
+    return "VREDSUM.VS";
+  case Instr::VREDAND:
+    return "VREDAND.VS";
+  case Instr::VREDOR:
+    return "VREDOR.VS";
+  case Instr::VREDXOR:
+    return "VREDXOR.VS";
+  case Instr::VREDMINU:
+    return "VREDMINU.VS";
+  case Instr::VREDMIN:
+    return "VREDMIN.VS";
+  case Instr::VREDMAXU:
+    return "VREDMAXU.VS";
+  case Instr::VREDMAX:
+    return "VREDMAX.VS";
+  case Instr::FLW:
+    return "FLW";
+  case Instr::FSW:
+    return "FSW";
+  case Instr::FMADDS:
+    return "FMADD.S";
+  case Instr::FMSUBS:
+    return "FMSUB.S";
+  case Instr::FNMSUBS:
+    return "FNMSUB.S";
+  case Instr::FNMADDS:
+    return "FNMADD.S";
+  case Instr::FADDS:
+    return "FADD.S";
+  case Instr::FSUBS:
+    return "FSUB.S";
+  case Instr::FMULS:
+    return "FMUL.S";
+  case Instr::FDIVS:
+    return "FDIV.S";
+  case Instr::FSQRTS:
+    return "FSQRT.S";
+  case Instr::FSGNJS:
+    return "FSGNJ.S";
+  case Instr::FSGNJNS:
+    return "FSGNJN.S";
+  case Instr::FSGNJXS:
+    return "FSGNJX.S";
+  case Instr::FMINS:
+    return "FMIN.S";
+  case Instr::FMAXS:
+    return "FMAX.S";
+  case Instr::FCVTWS:
+    return "FCVT.W.S";
+  case Instr::FCVTWUS:
+    return "FCVT.WU.S";
+  case Instr::FMVXW:
+    return "FMV.X.W";
+  case Instr::FEQS:
+    return "FEQ.S";
+  case Instr::FLTS:
+    return "FLT.S";
+  case Instr::FLES:
+    return "FLE.S";
+  case Instr::FCLASSS:
+    return "FCLASS.S";
+  case Instr::FCVTSW:
+    return "FCVT.S.W";
+  case Instr::FCVTSWU:
+    return "FCVT.S.WU";
+  case Instr::FMVWX:
+    return "FMV.W.X";
+  case Instr::FLD:
+    return "FLD";
+  case Instr::FSD:
+    return "FSD";
+  case Instr::FMADDD:
+    return "FMADD.D";
+  case Instr::FMSUBD:
+    return "FMSUB.D";
+  case Instr::FNMSUBD:
+    return "FNMSUB.D";
+  case Instr::FNMADDD:
+    return "FNMADD.D";
+  case Instr::FADDD:
+    return "FADD.D";
+  case Instr::FSUBD:
+    return "FSUB.D";
+  case Instr::FMULD:
+    return "FMUL.D";
+  case Instr::FDIVD:
+    return "FDIV.D";
+  case Instr::FSQRTD:
+    return "FSQRT.D";
+  case Instr::FSGNJD:
+    return "FSGNJ.D";
+  case Instr::FSGNJND:
+    return "FSGNJN.D";
+  case Instr::FSGNJXD:
+    return "FSGNJX.D";
+  case Instr::FMIND:
+    return "FMIN.D";
+  case Instr::FMAXD:
+    return "FMAX.D";
+  case Instr::FCVTSD:
+    return "FCVT.S.D";
+  case Instr::FCVTDS:
+    return "FCVT.D.S";
+  case Instr::FEQD:
+    return "FEQ.D";
+  case Instr::FLTD:
+    return "FLT.D";
+  case Instr::FLED:
+    return "FLE.D";
+  case Instr::FCLASSD:
+    return "FCLASS.D";
+  case Instr::FCVTWD:
+    return "FCVT.W.D";
+  case Instr::FCVTWUD:
+    return "FCVT.WU.D";
+  case Instr::FCVTDW:
+    return "FCVT.D.W";
+  case Instr::FCVTDWU:
+    return "FCVT.D.WU";
+  case Instr::CSRRW:
+    return "CSRRW";
+  case Instr::CSRRS:
+    return "CSRRS";
+  case Instr::CSRRC:
+    return "CSRRC";
+  case Instr::CSRRWI:
+    return "CSRRWI";
+  case Instr::CSRRSI:
+    return "CSRRSI";
+  case Instr::CSRRCI:
+    return "CSRRCI";
+  case Instr::LRW:
+    return "LR.W";
+  case Instr::SCW:
+    return "SC.W";
+  case Instr::AMOSWAPW:
+    return "AMOSWAP.W";
+  case Instr::AMOADDW:
+    return "AMOADD.W";
+  case Instr::AMOXORW:
+    return "AMOXOR.W";
+  case Instr::AMOANDW:
+    return "AMOAND.W";
+  case Instr::AMOORW:
+    return "AMOOR.W";
+  case Instr::AMOMINW:
+    return "AMOMIN.W";
+  case Instr::AMOMAXW:
+    return "AMOMAX.W";
+  case Instr::AMOMINUW:
+    return "AMOMINU.W";
+  case Instr::AMOMAXUW:
+    return "AMOMAXU.W";
   case Instr::FENCE:
     return "FENCE";
   case Instr::FENCETSO:
@@ -114,1070 +551,442 @@ char const* InstrToLiteral(Instr I) {
 }
 
 void LUIInstruction::build_ir(IRData& Data) {
-  uint32_t Immediate = InstructionData & 0xFFFFF000;
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUPtrTy = riscv::getCPUStatePointerType(Data.Builder.getContext());
-  auto *CPUArg = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *RegDestPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Data.Builder.getInt32(Immediate), RegDestPtr);
-
-  updatePC(Data);
+  Data.writeReg(regDest(InstructionData), Data.Builder.getInt32(immediate(Instr::LUI, InstructionData)));
 }
 
 void AUIPCInstruction::build_ir(IRData& Data) {
-  uint32_t Immediate = InstructionData & 0xFFFFF000;
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUPtrTy = riscv::getCPUStatePointerType(Data.Builder.getContext());
-  auto *CPUArg = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *RegDestPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);                                      
-  Data.Builder.CreateStore(Data.Builder.CreateAdd(Data.Builder.getInt32(Immediate), PCVal), RegDestPtr);
-  
-  llvm::Value *NewPCVal = Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4));
-  Data.Builder.CreateStore(NewPCVal, PCPtr);
+  Data.writeReg(regDest(InstructionData), Data.Builder.getInt32(Data.PC + immediate(Instr::AUIPC, InstructionData)));
 }
 
 void JALInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-
-  uint32_t Offset = ((InstructionData >> 31) & 0x1) << 20
-                | ((InstructionData >> 12) & 0xFF) << 12
-                | ((InstructionData >> 20) & 0x1) << 11
-                | ((InstructionData >> 21) & 0x3FF) << 1;
-
-  if (Offset & 0x80000) {
-    Offset |= 0xFFF00000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUPtrTy = riscv::getCPUStatePointerType(Data.Builder.getContext());
-  auto *CPUArg = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *RegDestPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);                                      
-  Data.Builder.CreateStore(Data.Builder.CreateAdd(Data.Builder.getInt32(4), PCVal), RegDestPtr);
-  Data.Builder.CreateStore(Data.Builder.CreateAdd(Data.Builder.getInt32(Offset), PCVal), PCPtr);
+  Data.writeReg(regDest(InstructionData), Data.Builder.getInt32(Data.nextPC()));
+  Data.writePC(Data.Builder.getInt32(Data.PC + immediate(Instr::JAL, InstructionData)));
 }
 
 void JALRInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc  = (InstructionData >> 15) & 0x1F;
-  uint32_t Offset  = (InstructionData >> 20) & 0xFFF;
-
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUPtrTy    = riscv::getCPUStatePointerType(Data.Builder.getContext());
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4)), RegDestPtr);
-
-  llvm::Value *Target = Data.Builder.CreateAdd(RegSrcVal, Data.Builder.getInt32(Offset));
-  llvm::Value *TargetAligned = Data.Builder.CreateAnd(Target, Data.Builder.getInt32(~1U));
-  Data.Builder.CreateStore(TargetAligned, PCPtr);
+  // rs1 is read before rd is written, as rd may be the same register.
+  llvm::Value *Target = Data.Builder.CreateAdd(Data.readReg(regSrc1(InstructionData)),
+                                               Data.Builder.getInt32(immediate(Instr::JALR, InstructionData)));
+  Data.writeReg(regDest(InstructionData), Data.Builder.getInt32(Data.nextPC()));
+  Data.writePC(Data.Builder.CreateAnd(Target, Data.Builder.getInt32(~1U)));
 }
 
 void BEQInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 31) & 0x1) << 12
-                  | ((InstructionData >> 7) & 0x1) << 11
-                  | ((InstructionData >> 25) & 0x3F) << 5
-                  | ((InstructionData >> 8) & 0xF) << 1;
-  if (Offset & 0x1000) {
-    Offset |= 0xFFFFE000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);
-
-  llvm::Value *Cond = Data.Builder.CreateICmpEQ(Reg1Val, Reg2Val);
-  llvm::Value *PCPlusOffset = Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(Offset));
-  llvm::Value *PCNext = Data.Builder.CreateSelect(Cond, PCPlusOffset,
-                                                  Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4)));
-  Data.Builder.CreateStore(PCNext, PCPtr);
+  buildBranch(Data, Instr::BEQ, InstructionData, llvm::CmpInst::ICMP_EQ);
 }
 
 void BNEInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 31) & 0x1) << 12
-                  | ((InstructionData >> 7) & 0x1) << 11
-                  | ((InstructionData >> 25) & 0x3F) << 5
-                  | ((InstructionData >> 8) & 0xF) << 1;
-  if (Offset & 0x1000) {
-    Offset |= 0xFFFFE000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);
-
-  llvm::Value *Cond = Data.Builder.CreateICmpNE(Reg1Val, Reg2Val);
-  llvm::Value *PCPlusOffset = Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(Offset));
-  llvm::Value *PCNext = Data.Builder.CreateSelect(Cond, PCPlusOffset,
-                                                  Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4)));
-  Data.Builder.CreateStore(PCNext, PCPtr);
+  buildBranch(Data, Instr::BNE, InstructionData, llvm::CmpInst::ICMP_NE);
 }
 
 void BLTInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 31) & 0x1) << 12
-                  | ((InstructionData >> 7) & 0x1) << 11
-                  | ((InstructionData >> 25) & 0x3F) << 5
-                  | ((InstructionData >> 8) & 0xF) << 1;
-  if (Offset & 0x1000) {
-    Offset |= 0xFFFFE000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);
-
-  llvm::Value *Cond = Data.Builder.CreateICmpSLT(Reg1Val, Reg2Val);
-  llvm::Value *PCPlusOffset = Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(Offset));
-  llvm::Value *PCNext = Data.Builder.CreateSelect(Cond, PCPlusOffset,
-                                                  Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4)));
-  Data.Builder.CreateStore(PCNext, PCPtr);
+  buildBranch(Data, Instr::BLT, InstructionData, llvm::CmpInst::ICMP_SLT);
 }
 
 void BGEInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 31) & 0x1) << 12
-                  | ((InstructionData >> 7) & 0x1) << 11
-                  | ((InstructionData >> 25) & 0x3F) << 5
-                  | ((InstructionData >> 8) & 0xF) << 1;
-  if (Offset & 0x1000) {
-    Offset |= 0xFFFFE000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);
-
-  llvm::Value *Cond = Data.Builder.CreateICmpSGE(Reg1Val, Reg2Val);
-  llvm::Value *PCPlusOffset = Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(Offset));
-  llvm::Value *PCNext = Data.Builder.CreateSelect(Cond, PCPlusOffset,
-                                                  Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4)));
-  Data.Builder.CreateStore(PCNext, PCPtr);
+  buildBranch(Data, Instr::BGE, InstructionData, llvm::CmpInst::ICMP_SGE);
 }
 
 void BLTUInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 31) & 0x1) << 12
-                  | ((InstructionData >> 7) & 0x1) << 11
-                  | ((InstructionData >> 25) & 0x3F) << 5
-                  | ((InstructionData >> 8) & 0xF) << 1;
-  if (Offset & 0x1000) {
-    Offset |= 0xFFFFE000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);
-
-  llvm::Value *Cond = Data.Builder.CreateICmpULT(Reg1Val, Reg2Val);
-  llvm::Value *PCPlusOffset = Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(Offset));
-  llvm::Value *PCNext = Data.Builder.CreateSelect(Cond, PCPlusOffset,
-                                                  Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4)));
-  Data.Builder.CreateStore(PCNext, PCPtr);
-} 
+  buildBranch(Data, Instr::BLTU, InstructionData, llvm::CmpInst::ICMP_ULT);
+}
 
 void BGEUInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 31) & 0x1) << 12
-                  | ((InstructionData >> 7) & 0x1) << 11
-                  | ((InstructionData >> 25) & 0x3F) << 5
-                  | ((InstructionData >> 8) & 0xF) << 1;
-  if (Offset & 0x1000) {
-    Offset |= 0xFFFFE000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *PCPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 1);
-  llvm::Value *PCVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), PCPtr);
-
-  llvm::Value *Cond = Data.Builder.CreateICmpUGE(Reg1Val, Reg2Val);
-  llvm::Value *PCPlusOffset = Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(Offset));
-  llvm::Value *PCNext = Data.Builder.CreateSelect(Cond, PCPlusOffset,
-                                                  Data.Builder.CreateAdd(PCVal, Data.Builder.getInt32(4)));
-  Data.Builder.CreateStore(PCNext, PCPtr);
+  buildBranch(Data, Instr::BGEU, InstructionData, llvm::CmpInst::ICMP_UGE);
 }
 
 void LBInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-  uint32_t Offset = (InstructionData >> 20) & 0xFFF;
-  
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-  
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *MemoryManagerPtrPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 2);
-  llvm::Value *MemoryManagerPtr = Data.Builder.CreateLoad(Data.Builder.getPtrTy(), MemoryManagerPtrPtr);
-  llvm::Value *RegDestPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrcPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-  llvm::Value *Address = Data.Builder.CreateAdd(RegSrcVal, Data.Builder.getInt32(Offset));
-  llvm::Value *ReadMemory = Data.Builder.CreateCall(Data.MemoryFunctions[0], {MemoryManagerPtr, Address});
-  
-  Data.Builder.CreateStore(Data.Builder.CreateSExt(ReadMemory, Data.Builder.getInt32Ty()), RegDestPtr);
-  
-  updatePC(Data);
+  buildLoad(Data, Instr::LB, InstructionData, 1, true);
 }
 
 void LHInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-  uint32_t Offset = (InstructionData >> 20) & 0xFFF;
-  
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-  
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *MemoryManagerPtrPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 2);
-  llvm::Value *MemoryManagerPtr = Data.Builder.CreateLoad(Data.Builder.getPtrTy(), MemoryManagerPtrPtr);
-  llvm::Value *RegDestPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrcPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-  llvm::Value *Address = Data.Builder.CreateAdd(RegSrcVal, Data.Builder.getInt32(Offset));
-  llvm::Value *ReadMemory = Data.Builder.CreateCall(Data.MemoryFunctions[1], {MemoryManagerPtr, Address});
-  
-  Data.Builder.CreateStore(Data.Builder.CreateSExt(ReadMemory, Data.Builder.getInt32Ty()), RegDestPtr);
-  
-  updatePC(Data);
+  buildLoad(Data, Instr::LH, InstructionData, 2, true);
 }
 
 void LWInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-  uint32_t Offset = (InstructionData >> 20) & 0xFFF;
-  
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-  
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *MemoryManagerPtrPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 2);
-  llvm::Value *MemoryManagerPtr = Data.Builder.CreateLoad(Data.Builder.getPtrTy(), MemoryManagerPtrPtr);
-  llvm::Value *RegDestPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrcPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-  llvm::Value *Address = Data.Builder.CreateAdd(RegSrcVal, Data.Builder.getInt32(Offset));
-  llvm::Value *ReadMemory = Data.Builder.CreateCall(Data.MemoryFunctions[2], {MemoryManagerPtr, Address});
-  
-  Data.Builder.CreateStore(Data.Builder.CreateSExt(ReadMemory, Data.Builder.getInt32Ty()), RegDestPtr);
-  
-  updatePC(Data);
+  buildLoad(Data, Instr::LW, InstructionData, 4, true);
 }
 
 void LBUInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-  uint32_t Offset = (InstructionData >> 20) & 0xFFF;
-  
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *MemoryManagerPtrPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 2);
-  llvm::Value *MemoryManagerPtr = Data.Builder.CreateLoad(Data.Builder.getPtrTy(), MemoryManagerPtrPtr);
-  llvm::Value *RegDestPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrcPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-  llvm::Value *Address = Data.Builder.CreateAdd(RegSrcVal, Data.Builder.getInt32(Offset));
-  llvm::Value *ReadMemory = Data.Builder.CreateCall(Data.MemoryFunctions[0], {MemoryManagerPtr, Address});
-  
-  Data.Builder.CreateStore(Data.Builder.CreateZExt(ReadMemory, Data.Builder.getInt32Ty()), RegDestPtr);
-  
-  updatePC(Data);
+  buildLoad(Data, Instr::LBU, InstructionData, 1, false);
 }
 
 void LHUInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-  uint32_t Offset = (InstructionData >> 20) & 0xFFF;
-  
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-  
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *MemoryManagerPtrPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 2);
-  llvm::Value *MemoryManagerPtr = Data.Builder.CreateLoad(Data.Builder.getPtrTy(), MemoryManagerPtrPtr);
-  llvm::Value *RegDestPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrcPtr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-  llvm::Value *Address = Data.Builder.CreateAdd(RegSrcVal, Data.Builder.getInt32(Offset));
-  llvm::Value *ReadMemory = Data.Builder.CreateCall(Data.MemoryFunctions[1], {MemoryManagerPtr, Address});
-  
-  Data.Builder.CreateStore(Data.Builder.CreateZExt(ReadMemory, Data.Builder.getInt32Ty()), RegDestPtr);
-  
-  updatePC(Data);
+  buildLoad(Data, Instr::LHU, InstructionData, 2, false);
 }
 
 void SBInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 25) & 0x7F) << 5
-                  | ((InstructionData >> 7)  & 0x1F);
-  
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-  
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *MemoryManagerPtrPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 2);
-  llvm::Value *RegSrc1Ptr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *RegSrc2Ptr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-
-                                          
-  llvm::Value *RegSrc1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc1Ptr);
-  llvm::Value *RegSrc2Val = Data.Builder.CreateLoad(Data.Builder.getInt8Ty(), RegSrc2Ptr);
-  llvm::Value *MemoryManagerPtr = Data.Builder.CreateLoad(Data.Builder.getPtrTy(), MemoryManagerPtrPtr);
-  llvm::Value *Address = Data.Builder.CreateAdd(RegSrc1Val, Data.Builder.getInt32(Offset));
-
-  Data.Builder.CreateCall(Data.MemoryFunctions[3], {MemoryManagerPtr, Address, RegSrc2Val});
-
-  updatePC(Data);
+  buildStore(Data, Instr::SB, InstructionData, 1);
 }
 
 void SHInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 25) & 0x7F) << 5
-                  | ((InstructionData >> 7)  & 0x1F);
-  
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-  
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *MemoryManagerPtrPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 2);
-  llvm::Value *RegSrc1Ptr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *RegSrc2Ptr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-
-                                          
-  llvm::Value *RegSrc1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc1Ptr);
-  llvm::Value *RegSrc2Val = Data.Builder.CreateLoad(Data.Builder.getInt16Ty(), RegSrc2Ptr);
-  llvm::Value *MemoryManagerPtr = Data.Builder.CreateLoad(Data.Builder.getPtrTy(), MemoryManagerPtrPtr);
-  llvm::Value *Address = Data.Builder.CreateAdd(RegSrc1Val, Data.Builder.getInt32(Offset));
-
-  Data.Builder.CreateCall(Data.MemoryFunctions[4], {MemoryManagerPtr, Address, RegSrc2Val});
-
-  updatePC(Data);
+  buildStore(Data, Instr::SH, InstructionData, 2);
 }
 
 void SWInstruction::build_ir(IRData& Data) {
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-  
-  uint32_t Offset = ((InstructionData >> 25) & 0x7F) << 5
-                  | ((InstructionData >> 7)  & 0x1F);
-  
-  if (Offset & 0x800) {
-    Offset |= 0xFFFFF000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-  llvm::Value *MemoryManagerPtrPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 2);
-  llvm::Value *RegSrc1Ptr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *RegSrc2Ptr  = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                        {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-
-                                          
-  llvm::Value *RegSrc1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc1Ptr);
-  llvm::Value *RegSrc2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc2Ptr);
-  llvm::Value *MemoryManagerPtr = Data.Builder.CreateLoad(Data.Builder.getPtrTy(), MemoryManagerPtrPtr);
-  llvm::Value *Address = Data.Builder.CreateAdd(RegSrc1Val, Data.Builder.getInt32(Offset));
-
-  Data.Builder.CreateCall(Data.MemoryFunctions[5], {MemoryManagerPtr, Address, RegSrc2Val});
-
-  updatePC(Data);
+  buildStore(Data, Instr::SW, InstructionData, 4);
 }
 
 void ADDIInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc  = (InstructionData >> 15) & 0x1F;
-  uint32_t Imm      = (InstructionData >> 20) & 0xFFF;
-
-  if (Imm & 0x800) {
-    Imm |= 0xFFFFF000;
-  }
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-
-  llvm::Value *Result = Data.Builder.CreateAdd(RegSrcVal, Data.Builder.getInt32(Imm));
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
-
-  updatePC(Data);
+  buildRegImm(Data, Instr::ADDI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAdd(L, R);
+  });
 }
 
 void SLTIInstruction::build_ir(IRData& Data) {
-  uint32_t Immediate = (InstructionData >> 20) & 0xFFF;
-  if (Immediate & 0x800) {
-    Immediate |= 0xFFFFF000;
-  }
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *SrcValue = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);  
-  llvm::Value *Cond = Data.Builder.CreateICmpSLT(SrcValue, Data.Builder.getInt32(Immediate));
-  Data.Builder.CreateStore(Data.Builder.CreateZExt(Cond, Data.Builder.getInt32Ty()), RegDestPtr);
-
-  updatePC(Data);
+  buildRegImm(Data, Instr::SLTI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateZExt(B.CreateICmpSLT(L, R), B.getInt32Ty());
+  });
 }
 
 void SLTIUInstruction::build_ir(IRData& Data) {
-  uint32_t Immediate = (InstructionData >> 20) & 0xFFF;
-  if (Immediate & 0x800) {
-    Immediate |= 0xFFFFF000;
-  }
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *SrcValue = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);  
-  llvm::Value *Cond = Data.Builder.CreateICmpULT(SrcValue, Data.Builder.getInt32(Immediate));
-  Data.Builder.CreateStore(Data.Builder.CreateZExt(Cond, Data.Builder.getInt32Ty()), RegDestPtr);
-
-  updatePC(Data);
+  buildRegImm(Data, Instr::SLTIU, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateZExt(B.CreateICmpULT(L, R), B.getInt32Ty());
+  });
 }
 
 void XORIInstruction::build_ir(IRData& Data) {
-  uint32_t Immediate = (InstructionData >> 20) & 0xFFF;
-  if (Immediate & 0x800) {
-    Immediate |= 0xFFFFF000;
-  }
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-
-  llvm::Value *Result = Data.Builder.CreateXor(RegSrcVal, Data.Builder.getInt32(Immediate));
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
-
-  updatePC(Data);
+  buildRegImm(Data, Instr::XORI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateXor(L, R);
+  });
 }
 
 void ORIInstruction::build_ir(IRData& Data) {
-  uint32_t Immediate = (InstructionData >> 20) & 0xFFF;
-  if (Immediate & 0x800) {
-    Immediate |= 0xFFFFF000;
-  }
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-
-  llvm::Value *Result = Data.Builder.CreateOr(RegSrcVal, Data.Builder.getInt32(Immediate));
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
-
-  updatePC(Data);
+  buildRegImm(Data, Instr::ORI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateOr(L, R);
+  });
 }
 
 void ANDIInstruction::build_ir(IRData& Data) {
-  uint32_t Immediate = (InstructionData >> 20) & 0xFFF;
-  if (Immediate & 0x800) {
-    Immediate |= 0xFFFFF000;
-  }
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
-
-  llvm::Value *Result = Data.Builder.CreateAnd(RegSrcVal, Data.Builder.getInt32(Immediate));
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
-
-  updatePC(Data);
+  buildRegImm(Data, Instr::ANDI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAnd(L, R);
+  });
 }
 
 void SLLIInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-  uint32_t Shamt = (InstructionData >> 20) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
+  buildRegImm(Data, Instr::SLLI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateShl(L, R);
+  });
+}
 
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
+void SRLIInstruction::build_ir(IRData& Data) {
+  buildRegImm(Data, Instr::SRLI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateLShr(L, R);
+  });
+}
 
-  llvm::Value *Result = Data.Builder.CreateShl(RegSrcVal, Data.Builder.getInt32(Shamt));
+void SRAIInstruction::build_ir(IRData& Data) {
+  buildRegImm(Data, Instr::SRAI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAShr(L, R);
+  });
+}
 
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
+void ADDInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAdd(L, R);
+  });
+}
 
-  updatePC(Data);
+void SUBInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateSub(L, R);
+  });
 }
 
-void SRLIInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-  uint32_t Shamt = (InstructionData >> 20) & 0x1F;
+void SLLInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateShl(L, shiftAmount(B, R));
+  });
+}
 
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
+void SRLInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateLShr(L, shiftAmount(B, R));
+  });
+}
 
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
+void SRAInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAShr(L, shiftAmount(B, R));
+  });
+}
 
-  llvm::Value *Result = Data.Builder.CreateLShr(RegSrcVal, Data.Builder.getInt32(Shamt));
+void XORInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateXor(L, R);
+  });
+}
 
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
+void ORInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateOr(L, R);
+  });
+}
 
-  updatePC(Data);
+void ANDInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAnd(L, R);
+  });
 }
 
-void SRAIInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc = (InstructionData >> 15) & 0x1F;
-  uint32_t Shamt = (InstructionData >> 20) & 0x1F;
+void SLTInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateZExt(B.CreateICmpSLT(L, R), B.getInt32Ty());
+  });
+}
 
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
+void SLTUInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateZExt(B.CreateICmpULT(L, R), B.getInt32Ty());
+  });
+}
 
-  llvm::Value *RegSrcPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc)});
-  llvm::Value *RegSrcVal = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrcPtr);
+void MULInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateMul(L, R);
+  });
+}
 
-  llvm::Value *Result = Data.Builder.CreateAShr(RegSrcVal, Data.Builder.getInt32(Shamt));
+void MULHInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return multiplyHigh(B, L, R, true, true);
+  });
+}
 
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
+void MULHSUInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return multiplyHigh(B, L, R, true, false);
+  });
+}
 
-  updatePC(Data);
+void MULHUInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return multiplyHigh(B, L, R, false, false);
+  });
 }
 
-void ADDInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
+void DIVInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    llvm::Value *Quotient = B.CreateSDiv(L, safeDivisor(B, L, R, true));
+    return B.CreateSelect(B.CreateICmpEQ(R, B.getInt32(0)), B.getInt32(0xFFFFFFFF), Quotient);
+  });
+}
 
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
+void DIVUInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    llvm::Value *Quotient = B.CreateUDiv(L, safeDivisor(B, L, R, false));
+    return B.CreateSelect(B.CreateICmpEQ(R, B.getInt32(0)), B.getInt32(0xFFFFFFFF), Quotient);
+  });
+}
 
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
+void REMInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    llvm::Value *Remainder = B.CreateSRem(L, safeDivisor(B, L, R, true));
+    return B.CreateSelect(B.CreateICmpEQ(R, B.getInt32(0)), L, Remainder);
+  });
+}
 
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
+void REMUInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    llvm::Value *Remainder = B.CreateURem(L, safeDivisor(B, L, R, false));
+    return B.CreateSelect(B.CreateICmpEQ(R, B.getInt32(0)), L, Remainder);
+  });
+}
 
-  llvm::Value *Result = Data.Builder.CreateAdd(Reg1Val, Reg2Val);
+void SH1ADDInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAdd(B.CreateShl(L, 1), R);
+  });
+}
 
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
+void SH2ADDInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAdd(B.CreateShl(L, 2), R);
+  });
+}
 
-  updatePC(Data);
+void SH3ADDInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAdd(B.CreateShl(L, 3), R);
+  });
 }
 
-void SUBInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
+void ANDNInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAnd(L, B.CreateNot(R));
+  });
+}
 
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
+void ORNInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateOr(L, B.CreateNot(R));
+  });
+}
 
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
+void XNORInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateNot(B.CreateXor(L, R));
+  });
+}
 
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
+// The counts are defined for zero (32), which the intrinsics give with
+// is_zero_poison false.
+void CLZInstruction::build_ir(IRData& Data) {
+  buildUnary(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* V) -> llvm::Value* {
+    return B.CreateIntrinsic(llvm::Intrinsic::ctlz, {B.getInt32Ty()}, {V, B.getFalse()});
+  });
+}
 
-  llvm::Value *Result = Data.Builder.CreateSub(Reg1Val, Reg2Val);
+void CTZInstruction::build_ir(IRData& Data) {
+  buildUnary(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* V) -> llvm::Value* {
+    return B.CreateIntrinsic(llvm::Intrinsic::cttz, {B.getInt32Ty()}, {V, B.getFalse()});
+  });
+}
 
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
+void CPOPInstruction::build_ir(IRData& Data) {
+  buildUnary(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* V) -> llvm::Value* {
+    return B.CreateUnaryIntrinsic(llvm::Intrinsic::ctpop, V);
+  });
+}
 
-  updatePC(Data);
+void MAXInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) -> llvm::Value* {
+    return B.CreateBinaryIntrinsic(llvm::Intrinsic::smax, L, R);
+  });
 }
 
-void SLLInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
+void MAXUInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) -> llvm::Value* {
+    return B.CreateBinaryIntrinsic(llvm::Intrinsic::umax, L, R);
+  });
+}
 
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
+void MINInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) -> llvm::Value* {
+    return B.CreateBinaryIntrinsic(llvm::Intrinsic::smin, L, R);
+  });
+}
 
-  llvm::Value *RegSrc1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *RegSrc1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc1Ptr);
-  llvm::Value *RegSrc2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  llvm::Value *RegSrc2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc2Ptr);
+void MINUInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) -> llvm::Value* {
+    return B.CreateBinaryIntrinsic(llvm::Intrinsic::umin, L, R);
+  });
+}
 
-  llvm::Value *Result = Data.Builder.CreateShl(RegSrc1Val, RegSrc2Val);
+void SEXTBInstruction::build_ir(IRData& Data) {
+  buildUnary(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* V) {
+    return B.CreateSExt(B.CreateTrunc(V, B.getInt8Ty()), B.getInt32Ty());
+  });
+}
 
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
+void SEXTHInstruction::build_ir(IRData& Data) {
+  buildUnary(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* V) {
+    return B.CreateSExt(B.CreateTrunc(V, B.getInt16Ty()), B.getInt32Ty());
+  });
+}
 
-  updatePC(Data);
+void ZEXTHInstruction::build_ir(IRData& Data) {
+  buildUnary(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* V) {
+    return B.CreateAnd(V, B.getInt32(0xFFFF));
+  });
 }
 
-void SRLInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
+// Rotates are funnel shifts of a value with itself; the intrinsics take the
+// amount modulo 32.
+void ROLInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) -> llvm::Value* {
+    return B.CreateIntrinsic(llvm::Intrinsic::fshl, {B.getInt32Ty()}, {L, L, R});
+  });
+}
 
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
+void RORInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) -> llvm::Value* {
+    return B.CreateIntrinsic(llvm::Intrinsic::fshr, {B.getInt32Ty()}, {L, L, R});
+  });
+}
 
-  llvm::Value *RegSrc1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *RegSrc1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc1Ptr);
-  llvm::Value *RegSrc2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  llvm::Value *RegSrc2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc2Ptr);
+void RORIInstruction::build_ir(IRData& Data) {
+  buildRegImm(Data, Instr::RORI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) -> llvm::Value* {
+    return B.CreateIntrinsic(llvm::Intrinsic::fshr, {B.getInt32Ty()}, {L, L, R});
+  });
+}
 
-  llvm::Value *Result = Data.Builder.CreateLShr(RegSrc1Val, RegSrc2Val);
+// Every non-zero byte becomes 0xFF: bit 7 of ((b & 0x7F) + 0x7F) | b is set
+// exactly when b is not zero, and multiplying those bits, moved down to
+// bit 0, by 0xFF fills their bytes without carries.
+void ORCBInstruction::build_ir(IRData& Data) {
+  buildUnary(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* V) {
+    llvm::Value *Low = B.CreateAdd(B.CreateAnd(V, B.getInt32(0x7F7F7F7F)), B.getInt32(0x7F7F7F7F));
+    llvm::Value *NonZero = B.CreateAnd(B.CreateOr(Low, V), B.getInt32(0x80808080));
+    return B.CreateMul(B.CreateLShr(NonZero, 7), B.getInt32(0xFF));
+  });
+}
 
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
+void REV8Instruction::build_ir(IRData& Data) {
+  buildUnary(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* V) -> llvm::Value* {
+    return B.CreateUnaryIntrinsic(llvm::Intrinsic::bswap, V);
+  });
+}
 
-  updatePC(Data);
+void BCLRInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAnd(L, B.CreateNot(bitMask(B, R)));
+  });
 }
 
-void SRAInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
+void BCLRIInstruction::build_ir(IRData& Data) {
+  buildRegImm(Data, Instr::BCLRI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAnd(L, B.CreateNot(bitMask(B, R)));
+  });
+}
 
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
+void BEXTInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAnd(B.CreateLShr(L, shiftAmount(B, R)), B.getInt32(1));
+  });
+}
 
-  llvm::Value *RegSrc1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *RegSrc1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc1Ptr);
-  llvm::Value *RegSrc2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  llvm::Value *RegSrc2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc2Ptr);
+void BEXTIInstruction::build_ir(IRData& Data) {
+  buildRegImm(Data, Instr::BEXTI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateAnd(B.CreateLShr(L, R), B.getInt32(1));
+  });
+}
 
-  llvm::Value *Result = Data.Builder.CreateAShr(RegSrc1Val, RegSrc2Val);
+void BINVInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateXor(L, bitMask(B, R));
+  });
+}
 
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
+void BINVIInstruction::build_ir(IRData& Data) {
+  buildRegImm(Data, Instr::BINVI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateXor(L, bitMask(B, R));
+  });
+}
 
-  updatePC(Data);
+void BSETInstruction::build_ir(IRData& Data) {
+  buildRegReg(Data, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateOr(L, bitMask(B, R));
+  });
 }
 
-void XORInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
+void BSETIInstruction::build_ir(IRData& Data) {
+  buildRegImm(Data, Instr::BSETI, InstructionData, [](llvm::IRBuilder<>& B, llvm::Value* L, llvm::Value* R) {
+    return B.CreateOr(L, bitMask(B, R));
+  });
+}
 
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
+// EBREAK has no debugger to trap to and runs as a no-op; breakpoints of the
+// engine are PCs given to Guest::stopAt(), checked by the dispatcher.
+void EBREAKInstruction::build_ir(IRData& Data) {}
 
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *Result = Data.Builder.CreateXor(Reg1Val, Reg2Val);
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
-
-  updatePC(Data);
-}
-
-void ORInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *Result = Data.Builder.CreateOr(Reg1Val, Reg2Val);
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
-
-  updatePC(Data);
-}
-
-void ANDInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *Reg1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Reg2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc2)});
-  llvm::Value *Reg1Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg1Ptr);
-  llvm::Value *Reg2Val = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Reg2Ptr);
-
-  llvm::Value *Result = Data.Builder.CreateAnd(Reg1Val, Reg2Val);
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  Data.Builder.CreateStore(Result, RegDestPtr);
-
-  updatePC(Data);
-}
-
-void SLTInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrc1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Src1Value = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc1Ptr);  
-  llvm::Value *RegSrc2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Src2Value = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc2Ptr); 
-  llvm::Value *Cond = Data.Builder.CreateICmpSLT(Src1Value, Src2Value);
-  Data.Builder.CreateStore(Data.Builder.CreateZExt(Cond, Data.Builder.getInt32Ty()), RegDestPtr);
-
-  updatePC(Data); 
-}
-
-void SLTUInstruction::build_ir(IRData& Data) {
-  uint32_t RegDest = (InstructionData >> 7) & 0x1F;
-  uint32_t RegSrc1 = (InstructionData >> 15) & 0x1F;
-  uint32_t RegSrc2 = (InstructionData >> 20) & 0x1F;
-
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-  llvm::Value *RegsPtr = Data.Builder.CreateStructGEP(CPUStructTy, CPUArg, 0);
-
-  llvm::Value *RegDestPtr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegDest)});
-  llvm::Value *RegSrc1Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Src1Value = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc1Ptr);  
-  llvm::Value *RegSrc2Ptr = Data.Builder.CreateInBoundsGEP(RegsArrTy, RegsPtr,
-                                      {Data.Builder.getInt32(0), Data.Builder.getInt32(RegSrc1)});
-  llvm::Value *Src2Value = Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), RegSrc2Ptr); 
-  llvm::Value *Cond = Data.Builder.CreateICmpULT(Src1Value, Src2Value);
-  Data.Builder.CreateStore(Data.Builder.CreateZExt(Cond, Data.Builder.getInt32Ty()), RegDestPtr);
-
-  updatePC(Data);
-}
-
-void FENCEInstruction::build_ir(IRData& Data) {
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  updatePC(Data);
-}
-void FENCETSOInstruction::build_ir(IRData& Data) {
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  updatePC(Data); 
-}
-void PAUSEInstruction::build_ir(IRData& Data) {
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  updatePC(Data);
-}
-void ECALLInstruction::build_ir(IRData& Data) {}
-void EBREAKInstruction::build_ir(IRData& Data) {
-  auto *CPUStructTy = riscv::getCPUStateType(Data.Builder.getContext());
-  auto *RegsArrTy   = llvm::ArrayType::get(llvm::Type::getInt32Ty(Data.Builder.getContext()), 32);
-  auto *CPUArg      = Data.CurrentFunction->getArg(0);
-
-  updatePC(Data);
-}
+// Syscalls run on the host (see handleSyscall); exit sets PC to 0, which
+// ends the dispatcher loop. ECALL ends its block, so nothing after the call
+// relies on registers loaded before it.
+void ECALLInstruction::build_ir(IRData& Data) {
+  Data.writePC(Data.Builder.getInt32(Data.nextPC()));
+  Data.Builder.CreateCall(Data.SyscallFunction, {Data.CurrentFunction->getArg(0)});
+}
 
 namespace {
 constexpr uint32_t opcode(uint32_t instr) { return instr & 0x7F; }
@@ -1213,15 +1022,37 @@ Instr decode(uint32_t InstructionData) {
     case 0x13:
       switch (f3) {
         case 0x0: return Instr::ADDI;
-        case 0x1: 
-          if ((InstructionData >> 25) == 0x00) return Instr::SLLI;
+        case 0x1:
+          switch (f7) {
+            case 0x00: return Instr::SLLI;
+            case 0x14: return Instr::BSETI;
+            case 0x24: return Instr::BCLRI;
+            case 0x34: return Instr::BINVI;
+            case 0x30:
+              switch ((InstructionData >> 20) & 0x1F) {
+                case 0x0: return Instr::CLZ;
+                case 0x1: return Instr::CTZ;
+                case 0x2: return Instr::CPOP;
+                case 0x4: return Instr::SEXTB;
+                case 0x5: return Instr::SEXTH;
+              }
+              break;
+          }
           break;
         case 0x2: return Instr::SLTI;
         case 0x3: return Instr::SLTIU;
         case 0x4: return Instr::XORI;
         case 0x5:
-          if ((InstructionData >> 25) == 0x00) return Instr::SRLI;
-          else if ((InstructionData >> 25) == 0x20) return Instr::SRAI;
+          switch (InstructionData >> 20) {
+            case 0x287: return Instr::ORCB;
+            case 0x698: return Instr::REV8;
+          }
+          switch (f7) {
+            case 0x00: return Instr::SRLI;
+            case 0x20: return Instr::SRAI;
+            case 0x24: return Instr::BEXTI;
+            case 0x30: return Instr::RORI;
+          }
           break;
         case 0x6: return Instr::ORI;
         case 0x7: return Instr::ANDI;
@@ -1248,24 +1079,287 @@ Instr decode(uint32_t InstructionData) {
       break;
     
     case 0x33:
+      switch (f7) {
+        case 0x00:
+          switch (f3) {
+            case 0x0: return Instr::ADD;
+            case 0x1: return Instr::SLL;
+            case 0x2: return Instr::SLT;
+            case 0x3: return Instr::SLTU;
+            case 0x4: return Instr::XOR;
+            case 0x5: return Instr::SRL;
+            case 0x6: return Instr::OR;
+            case 0x7: return Instr::AND;
+          }
+          break;
+        case 0x20:
+          switch (f3) {
+            case 0x0: return Instr::SUB;
+            case 0x4: return Instr::XNOR;
+            case 0x5: return Instr::SRA;
+            case 0x6: return Instr::ORN;
+            case 0x7: return Instr::ANDN;
+          }
+          break;
+        case 0x01:
+          switch (f3) {
+            case 0x0: return Instr::MUL;
+            case 0x1: return Instr::MULH;
+            case 0x2: return Instr::MULHSU;
+            case 0x3: return Instr::MULHU;
+            case 0x4: return Instr::DIV;
+            case 0x5: return Instr::DIVU;
+            case 0x6: return Instr::REM;
+            case 0x7: return Instr::REMU;
+          }
+          break;
+        case 0x10:
+          switch (f3) {
+            case 0x2: return Instr::SH1ADD;
+            case 0x4: return Instr::SH2ADD;
+            case 0x6: return Instr::SH3ADD;
+          }
+          break;
+        case 0x05:
+          switch (f3) {
+            case 0x4: return Instr::MIN;
+            case 0x5: return Instr::MINU;
+            case 0x6: return Instr::MAX;
+            case 0x7: return Instr::MAXU;
+          }
+          break;
+        case 0x04:
+          if (f3 == 0x4 && ((InstructionData >> 20) & 0x1F) == 0) return Instr::ZEXTH;
+          break;
+        case 0x30:
+          if (f3 == 0x1) return Instr::ROL;
+          if (f3 == 0x5) return Instr::ROR;
+          break;
+        case 0x24:
+          if (f3 == 0x1) return Instr::BCLR;
+          if (f3 == 0x5) return Instr::BEXT;
+          break;
+        case 0x34:
+          if (f3 == 0x1) return Instr::BINV;
+          break;
+        case 0x14:
+          if (f3 == 0x1) return Instr::BSET;
+          break;
+      }
+      break;
+    
+    // Scalar FP and vector loads and stores, told apart by the width. Vector
+    // ones only with unit-stride and strided addressing, without segments.
+    case 0x07:
+    case 0x27: {
+      if (f3 == 0x2) return op == 0x07 ? Instr::FLW : Instr::FSW;
+      if (f3 == 0x3) return op == 0x07 ? Instr::FLD : Instr::FSD;
+      uint32_t mop = (InstructionData >> 26) & 0x3;
+      bool Strided = mop == 0x2;
+      if ((InstructionData >> 28) != 0 || !(Strided || (mop == 0x0 && regSrc2(InstructionData) == 0)))
+        break;
+      bool Load = op == 0x07;
+      switch (f3) {
+        case 0x0: return Load ? (Strided ? Instr::VLSE8 : Instr::VLE8) : (Strided ? Instr::VSSE8 : Instr::VSE8);
+        case 0x5: return Load ? (Strided ? Instr::VLSE16 : Instr::VLE16) : (Strided ? Instr::VSSE16 : Instr::VSE16);
+        case 0x6: return Load ? (Strided ? Instr::VLSE32 : Instr::VLE32) : (Strided ? Instr::VSSE32 : Instr::VSE32);
+      }
+      break;
+    }
+
+    case 0x57: {
+      uint32_t f6 = InstructionData >> 26;
+      bool Masked = !((InstructionData >> 25) & 0x1);
       switch (f3) {
+        case 0x7:
+          if (!(InstructionData >> 31)) return Instr::VSETVLI;
+          if ((InstructionData >> 30) == 0x3) return Instr::VSETIVLI;
+          if (f7 == 0x40) return Instr::VSETVL;
+          break;
+        // OPIVV
         case 0x0:
-          if (f7 == 0x00) return Instr::ADD;
-          else if (f7 == 0x20) return Instr::SUB;
+          switch (f6) {
+            case 0x00: return Instr::VADDVV;
+            case 0x02: return Instr::VSUBVV;
+            case 0x09: return Instr::VANDVV;
+            case 0x0A: return Instr::VORVV;
+            case 0x0B: return Instr::VXORVV;
+            case 0x17:
+              if (!Masked && regSrc2(InstructionData) == 0) return Instr::VMVVV;
+              break;
+          }
           break;
-        case 0x1: return Instr::SLL;
-        case 0x2: return Instr::SLT;
-        case 0x3: return Instr::SLTU;
-        case 0x4: return Instr::XOR;
-        case 0x5:
-          if (f7 == 0x00) return Instr::SRL;
-          else if (f7 == 0x20) return Instr::SRA;
+        // OPIVX
+        case 0x4:
+          switch (f6) {
+            case 0x00: return Instr::VADDVX;
+            case 0x02: return Instr::VSUBVX;
+            case 0x03: return Instr::VRSUBVX;
+            case 0x09: return Instr::VANDVX;
+            case 0x0A: return Instr::VORVX;
+            case 0x0B: return Instr::VXORVX;
+            case 0x17:
+              if (!Masked && regSrc2(InstructionData) == 0) return Instr::VMVVX;
+              break;
+          }
+          break;
+        // OPIVI
+        case 0x3:
+          switch (f6) {
+            case 0x00: return Instr::VADDVI;
+            case 0x03: return Instr::VRSUBVI;
+            case 0x09: return Instr::VANDVI;
+            case 0x0A: return Instr::VORVI;
+            case 0x0B: return Instr::VXORVI;
+            case 0x17:
+              if (!Masked && regSrc2(InstructionData) == 0) return Instr::VMVVI;
+              break;
+          }
+          break;
+        // OPMVV
+        case 0x2:
+          switch (f6) {
+            case 0x00: return Instr::VREDSUM;
+            case 0x01: return Instr::VREDAND;
+            case 0x02: return Instr::VREDOR;
+            case 0x03: return Instr::VREDXOR;
+            case 0x04: return Instr::VREDMINU;
+            case 0x05: return Instr::VREDMIN;
+            case 0x06: return Instr::VREDMAXU;
+            case 0x07: return Instr::VREDMAX;
+            case 0x25: return Instr::VMULVV;
+            case 0x10:
+              if (!Masked && regSrc1(InstructionData) == 0) return Instr::VMVXS;
+              break;
+          }
+          break;
+        // OPMVX
+        case 0x6:
+          switch (f6) {
+            case 0x25: return Instr::VMULVX;
+            case 0x10:
+              if (!Masked && regSrc2(InstructionData) == 0) return Instr::VMVSX;
+              break;
+          }
           break;
-        case 0x6: return Instr::OR;
-        case 0x7: return Instr::AND;
       }
       break;
-    
+    }
+
+    // Fused multiply-add; fmt in bits 26:25.
+    case 0x43:
+    case 0x47:
+    case 0x4B:
+    case 0x4F: {
+      static constexpr Instr Single[] = {Instr::FMADDS, Instr::FMSUBS, Instr::FNMSUBS, Instr::FNMADDS};
+      static constexpr Instr Double[] = {Instr::FMADDD, Instr::FMSUBD, Instr::FNMSUBD, Instr::FNMADDD};
+      uint32_t fmt = f7 & 0x3;
+      if (fmt == 0x0) return Single[(op >> 2) & 0x3];
+      if (fmt == 0x1) return Double[(op >> 2) & 0x3];
+      break;
+    }
+
+    case 0x53: {
+      uint32_t rs2 = regSrc2(InstructionData);
+      switch (f7) {
+        case 0x00: return Instr::FADDS;
+        case 0x04: return Instr::FSUBS;
+        case 0x08: return Instr::FMULS;
+        case 0x0C: return Instr::FDIVS;
+        case 0x2C:
+          if (rs2 == 0) return Instr::FSQRTS;
+          break;
+        case 0x10:
+          if (f3 == 0x0) return Instr::FSGNJS;
+          if (f3 == 0x1) return Instr::FSGNJNS;
+          if (f3 == 0x2) return Instr::FSGNJXS;
+          break;
+        case 0x14:
+          if (f3 == 0x0) return Instr::FMINS;
+          if (f3 == 0x1) return Instr::FMAXS;
+          break;
+        case 0x60:
+          if (rs2 == 0) return Instr::FCVTWS;
+          if (rs2 == 1) return Instr::FCVTWUS;
+          break;
+        case 0x70:
+          if (rs2 == 0 && f3 == 0x0) return Instr::FMVXW;
+          if (rs2 == 0 && f3 == 0x1) return Instr::FCLASSS;
+          break;
+        case 0x50:
+          if (f3 == 0x0) return Instr::FLES;
+          if (f3 == 0x1) return Instr::FLTS;
+          if (f3 == 0x2) return Instr::FEQS;
+          break;
+        case 0x68:
+          if (rs2 == 0) return Instr::FCVTSW;
+          if (rs2 == 1) return Instr::FCVTSWU;
+          break;
+        case 0x78:
+          if (rs2 == 0 && f3 == 0x0) return Instr::FMVWX;
+          break;
+        case 0x01: return Instr::FADDD;
+        case 0x05: return Instr::FSUBD;
+        case 0x09: return Instr::FMULD;
+        case 0x0D: return Instr::FDIVD;
+        case 0x2D:
+          if (rs2 == 0) return Instr::FSQRTD;
+          break;
+        case 0x11:
+          if (f3 == 0x0) return Instr::FSGNJD;
+          if (f3 == 0x1) return Instr::FSGNJND;
+          if (f3 == 0x2) return Instr::FSGNJXD;
+          break;
+        case 0x15:
+          if (f3 == 0x0) return Instr::FMIND;
+          if (f3 == 0x1) return Instr::FMAXD;
+          break;
+        case 0x20:
+          if (rs2 == 1) return Instr::FCVTSD;
+          break;
+        case 0x21:
+          if (rs2 == 0) return Instr::FCVTDS;
+          break;
+        case 0x51:
+          if (f3 == 0x0) return Instr::FLED;
+          if (f3 == 0x1) return Instr::FLTD;
+          if (f3 == 0x2) return Instr::FEQD;
+          break;
+        case 0x71:
+          if (rs2 == 0 && f3 == 0x1) return Instr::FCLASSD;
+          break;
+        case 0x61:
+          if (rs2 == 0) return Instr::FCVTWD;
+          if (rs2 == 1) return Instr::FCVTWUD;
+          break;
+        case 0x69:
+          if (rs2 == 0) return Instr::FCVTDW;
+          if (rs2 == 1) return Instr::FCVTDWU;
+          break;
+      }
+      break;
+    }
+
+    case 0x2F:
+      if (f3 == 0x2) {
+        switch (f7 >> 2) {
+          case 0x02:
+            if (regSrc2(InstructionData) == 0) return Instr::LRW;
+            break;
+          case 0x03: return Instr::SCW;
+          case 0x01: return Instr::AMOSWAPW;
+          case 0x00: return Instr::AMOADDW;
+          case 0x04: return Instr::AMOXORW;
+          case 0x0C: return Instr::AMOANDW;
+          case 0x08: return Instr::AMOORW;
+          case 0x10: return Instr::AMOMINW;
+          case 0x14: return Instr::AMOMAXW;
+          case 0x18: return Instr::AMOMINUW;
+          case 0x1C: return Instr::AMOMAXUW;
+        }
+      }
+      break;
+
     case 0x0F:
       if (f3 == 0x0) {
         uint32_t fm = (InstructionData >> 28) & 0xF;
@@ -1276,7 +1370,7 @@ Instr decode(uint32_t InstructionData) {
           return Instr::FENCETSO;
         }
         
-        if ((InstructionData & 0xFFFFF000) == 0x0000100F) {
+        if (InstructionData == 0x0100000F) {
           return Instr::PAUSE;
         }
         
@@ -1285,10 +1379,19 @@ Instr decode(uint32_t InstructionData) {
       break;
     
     case 0x73:
-      if (f3 == 0x0) {
-        uint32_t imm12 = (InstructionData >> 20) & 0xFFF;
-        if (imm12 == 0x000) return Instr::ECALL;
-        else if (imm12 == 0x001) return Instr::EBREAK;
+      switch (f3) {
+        case 0x0: {
+          uint32_t imm12 = (InstructionData >> 20) & 0xFFF;
+          if (imm12 == 0x000) return Instr::ECALL;
+          else if (imm12 == 0x001) return Instr::EBREAK;
+          break;
+        }
+        case 0x1: return Instr::CSRRW;
+        case 0x2: return Instr::CSRRS;
+        case 0x3: return Instr::CSRRC;
+        case 0x5: return Instr::CSRRWI;
+        case 0x6: return Instr::CSRRSI;
+        case 0x7: return Instr::CSRRCI;
       }
       break;
   }
@@ -1296,6 +1399,126 @@ Instr decode(uint32_t InstructionData) {
   return Instr::UNKNOWN;
 }
 
+uint32_t immediate(Instr InstrType, uint32_t InstructionData) {
+  switch (InstrType) {
+    case Instr::LUI:
+    case Instr::AUIPC:
+      return InstructionData & 0xFFFFF000;
+    case Instr::JAL: {
+      uint32_t Offset = ((InstructionData >> 31) & 0x1) << 20
+                      | ((InstructionData >> 12) & 0xFF) << 12
+                      | ((InstructionData >> 20) & 0x1) << 11
+                      | ((InstructionData >> 21) & 0x3FF) << 1;
+      if (Offset & 0x100000) {
+        Offset |= 0xFFE00000;
+      }
+      return Offset;
+    }
+    case Instr::BEQ:
+    case Instr::BNE:
+    case Instr::BLT:
+    case Instr::BGE:
+    case Instr::BLTU:
+    case Instr::BGEU: {
+      uint32_t Offset = ((InstructionData >> 31) & 0x1) << 12
+                      | ((InstructionData >> 7) & 0x1) << 11
+                      | ((InstructionData >> 25) & 0x3F) << 5
+                      | ((InstructionData >> 8) & 0xF) << 1;
+      if (Offset & 0x1000) {
+        Offset |= 0xFFFFE000;
+      }
+      return Offset;
+    }
+    case Instr::SB:
+    case Instr::SH:
+    case Instr::SW:
+    case Instr::FSW:
+    case Instr::FSD: {
+      uint32_t Offset = ((InstructionData >> 25) & 0x7F) << 5
+                      | ((InstructionData >> 7)  & 0x1F);
+      if (Offset & 0x800) {
+        Offset |= 0xFFFFF000;
+      }
+      return Offset;
+    }
+    case Instr::SLLI:
+    case Instr::SRLI:
+    case Instr::SRAI:
+    case Instr::RORI:
+    case Instr::BCLRI:
+    case Instr::BEXTI:
+    case Instr::BINVI:
+    case Instr::BSETI:
+      return (InstructionData >> 20) & 0x1F;
+    case Instr::VADDVI:
+    case Instr::VRSUBVI:
+    case Instr::VANDVI:
+    case Instr::VORVI:
+    case Instr::VXORVI:
+    case Instr::VMVVI: {
+      uint32_t Imm = (InstructionData >> 15) & 0x1F;
+      if (Imm & 0x10) {
+        Imm |= 0xFFFFFFE0;
+      }
+      return Imm;
+    }
+    case Instr::VSETVLI:
+      return (InstructionData >> 20) & 0x7FF;
+    case Instr::VSETIVLI:
+      return (InstructionData >> 20) & 0x3FF;
+    case Instr::CSRRW:
+    case Instr::CSRRS:
+    case Instr::CSRRC:
+    case Instr::CSRRWI:
+    case Instr::CSRRSI:
+    case Instr::CSRRCI:
+      return (InstructionData >> 20) & 0xFFF;
+    case Instr::JALR:
+    case Instr::FLW:
+    case Instr::FLD:
+    case Instr::LB:
+    case Instr::LH:
+    case Instr::LW:
+    case Instr::LBU:
+    case Instr::LHU:
+    case Instr::ADDI:
+    case Instr::SLTI:
+    case Instr::SLTIU:
+    case Instr::XORI:
+    case Instr::ORI:
+    case Instr::ANDI: {
+      uint32_t Imm = (InstructionData >> 20) & 0xFFF;
+      if (Imm & 0x800) {
+        Imm |= 0xFFFFF000;
+      }
+      return Imm;
+    }
+    default:
+      return 0;
+  }
+}
+
+bool endsBlock(Instr InstrType) {
+  switch (InstrType) {
+    case Instr::BEQ:
+    case Instr::BNE:
+    case Instr::BLT:
+    case Instr::BGE:
+    case Instr::BLTU:
+    case Instr::BGEU:
+    case Instr::JAL:
+    case Instr::JALR:
+    case Instr::ECALL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool needsLLVM(Instr InstrType) {
+  return InstrType >= Instr::VSETVLI && InstrType <= Instr::PAUSE;
+}
+
 void generate(Instr InstrType, uint32_t InstructionData, IRData& Data) {
   switch (InstrType) {
     case Instr::UNKNOWN:
@@ -1411,6 +1634,462 @@ void generate(Instr InstrType, uint32_t InstructionData, IRData& Data) {
     case Instr::AND:
       ANDInstruction{InstructionData}.build_ir(Data);
       return;
+    case Instr::MUL:
+      MULInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::MULH:
+      MULHInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::MULHSU:
+      MULHSUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::MULHU:
+      MULHUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::DIV:
+      DIVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::DIVU:
+      DIVUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::REM:
+      REMInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::REMU:
+      REMUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::SH1ADD:
+      SH1ADDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::SH2ADD:
+      SH2ADDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::SH3ADD:
+      SH3ADDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::ANDN:
+      ANDNInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::ORN:
+      ORNInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::XNOR:
+      XNORInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CLZ:
+      CLZInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CTZ:
+      CTZInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CPOP:
+      CPOPInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::MAX:
+      MAXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::MAXU:
+      MAXUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::MIN:
+      MINInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::MINU:
+      MINUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::SEXTB:
+      SEXTBInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::SEXTH:
+      SEXTHInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::ZEXTH:
+      ZEXTHInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::ROL:
+      ROLInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::ROR:
+      RORInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::RORI:
+      RORIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::ORCB:
+      ORCBInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::REV8:
+      REV8Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::BCLR:
+      BCLRInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::BCLRI:
+      BCLRIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::BEXT:
+      BEXTInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::BEXTI:
+      BEXTIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::BINV:
+      BINVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::BINVI:
+      BINVIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::BSET:
+      BSETInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::BSETI:
+      BSETIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSETVLI:
+      VSETVLIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSETIVLI:
+      VSETIVLIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSETVL:
+      VSETVLInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VLE8:
+      VLE8Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VLE16:
+      VLE16Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VLE32:
+      VLE32Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VLSE8:
+      VLSE8Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VLSE16:
+      VLSE16Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VLSE32:
+      VLSE32Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSE8:
+      VSE8Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSE16:
+      VSE16Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSE32:
+      VSE32Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSSE8:
+      VSSE8Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSSE16:
+      VSSE16Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSSE32:
+      VSSE32Instruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VADDVV:
+      VADDVVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VADDVX:
+      VADDVXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VADDVI:
+      VADDVIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSUBVV:
+      VSUBVVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VSUBVX:
+      VSUBVXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VRSUBVX:
+      VRSUBVXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VRSUBVI:
+      VRSUBVIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VMULVV:
+      VMULVVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VMULVX:
+      VMULVXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VANDVV:
+      VANDVVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VANDVX:
+      VANDVXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VANDVI:
+      VANDVIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VORVV:
+      VORVVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VORVX:
+      VORVXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VORVI:
+      VORVIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VXORVV:
+      VXORVVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VXORVX:
+      VXORVXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VXORVI:
+      VXORVIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VMVVV:
+      VMVVVInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VMVVX:
+      VMVVXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VMVVI:
+      VMVVIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VMVXS:
+      VMVXSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VMVSX:
+      VMVSXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VREDSUM:
+      VREDSUMInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VREDAND:
+      VREDANDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VREDOR:
+      VREDORInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VREDXOR:
+      VREDXORInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VREDMINU:
+      VREDMINUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VREDMIN:
+      VREDMINInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VREDMAXU:
+      VREDMAXUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::VREDMAX:
+      VREDMAXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FLW:
+      FLWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSW:
+      FSWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMADDS:
+      FMADDSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMSUBS:
+      FMSUBSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FNMSUBS:
+      FNMSUBSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FNMADDS:
+      FNMADDSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FADDS:
+      FADDSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSUBS:
+      FSUBSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMULS:
+      FMULSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FDIVS:
+      FDIVSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSQRTS:
+      FSQRTSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSGNJS:
+      FSGNJSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSGNJNS:
+      FSGNJNSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSGNJXS:
+      FSGNJXSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMINS:
+      FMINSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMAXS:
+      FMAXSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTWS:
+      FCVTWSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTWUS:
+      FCVTWUSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMVXW:
+      FMVXWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FEQS:
+      FEQSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FLTS:
+      FLTSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FLES:
+      FLESInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCLASSS:
+      FCLASSSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTSW:
+      FCVTSWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTSWU:
+      FCVTSWUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMVWX:
+      FMVWXInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FLD:
+      FLDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSD:
+      FSDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMADDD:
+      FMADDDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMSUBD:
+      FMSUBDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FNMSUBD:
+      FNMSUBDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FNMADDD:
+      FNMADDDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FADDD:
+      FADDDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSUBD:
+      FSUBDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMULD:
+      FMULDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FDIVD:
+      FDIVDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSQRTD:
+      FSQRTDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSGNJD:
+      FSGNJDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSGNJND:
+      FSGNJNDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FSGNJXD:
+      FSGNJXDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMIND:
+      FMINDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FMAXD:
+      FMAXDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTSD:
+      FCVTSDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTDS:
+      FCVTDSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FEQD:
+      FEQDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FLTD:
+      FLTDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FLED:
+      FLEDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCLASSD:
+      FCLASSDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTWD:
+      FCVTWDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTWUD:
+      FCVTWUDInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTDW:
+      FCVTDWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::FCVTDWU:
+      FCVTDWUInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CSRRW:
+      CSRRWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CSRRS:
+      CSRRSInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CSRRC:
+      CSRRCInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CSRRWI:
+      CSRRWIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CSRRSI:
+      CSRRSIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::CSRRCI:
+      CSRRCIInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::LRW:
+      LRWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::SCW:
+      SCWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOSWAPW:
+      AMOSWAPWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOADDW:
+      AMOADDWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOXORW:
+      AMOXORWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOANDW:
+      AMOANDWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOORW:
+      AMOORWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOMINW:
+      AMOMINWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOMAXW:
+      AMOMAXWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOMINUW:
+      AMOMINUWInstruction{InstructionData}.build_ir(Data);
+      return;
+    case Instr::AMOMAXUW:
+      AMOMAXUWInstruction{InstructionData}.build_ir(Data);
+      return;
     case Instr::FENCE:
       FENCEInstruction{InstructionData}.build_ir(Data);
       return;
@@ -0,0 +1,132 @@
+#include "JumpTable.h"
+#include "Compressed.h"
+#include <array>
+#include <llvm/IR/IRBuilder.h>
+
+namespace riscv {
+
+namespace {
+
+// What the scan knows about a register at one point of the block.
+struct Fact {
+  enum Kind { Unknown, Constant, TableAddress, TableEntry };
+  Kind K = Unknown;
+  // The constant, or the address of the first entry.
+  uint32_t Value = 0;
+  // TableEntry: constant added to the loaded word so far.
+  uint32_t Addend = 0;
+  // TableEntry: position of the load in the block.
+  size_t Load = 0;
+};
+
+bool contains(std::vector<CodeRegion> const& Regions, uint32_t Begin, uint32_t Size) {
+  for (auto const& Region : Regions) {
+    if (Region.Begin <= Begin && uint64_t(Begin) + Size <= Region.End)
+      return true;
+  }
+  return false;
+}
+
+// Base + Other, where Other is not known: an address into a table at Base.
+Fact indexInto(Fact const& Base, Fact const& Other) {
+  if (Base.K == Fact::Constant && Other.K == Fact::Constant)
+    return {Fact::Constant, Base.Value + Other.Value};
+  if (Base.K == Fact::Constant && Other.K == Fact::Unknown)
+    return {Fact::TableAddress, Base.Value};
+  if (Base.K == Fact::Constant && Other.K == Fact::TableEntry)
+    return {Fact::TableEntry, Other.Value, Other.Addend + Base.Value, Other.Load};
+  return {};
+}
+
+} // end anonymous namespace
+
+std::optional<JumpTable> findJumpTable(MemoryManager* Manager, ElfCodeInfo const& Info, uint32_t PC, size_t NumInstrs) {
+  std::array<Fact, 32> Regs{};
+  Regs[0] = {Fact::Constant, 0};
+  for (size_t I = 0; I < NumInstrs; ++I) {
+    uint32_t Length;
+    uint32_t InstructionData = fetchInstruction(Manager, PC, Length);
+    Instr CurrentInstruction = decode(InstructionData);
+    Fact const& A = Regs[regSrc1(InstructionData)];
+    Fact const& B = Regs[regSrc2(InstructionData)];
+    uint32_t Imm = immediate(CurrentInstruction, InstructionData);
+    Fact Result;
+    switch (CurrentInstruction) {
+      case Instr::LUI:
+        Result = {Fact::Constant, Imm};
+        break;
+      case Instr::AUIPC:
+        Result = {Fact::Constant, PC + Imm};
+        break;
+      case Instr::ADDI:
+        Result = indexInto({Fact::Constant, Imm}, A);
+        if (A.K == Fact::TableAddress)
+          Result = {Fact::TableAddress, A.Value + Imm};
+        break;
+      case Instr::ADD:
+        Result = A.K == Fact::Constant ? indexInto(A, B) : indexInto(B, A);
+        break;
+      case Instr::SH2ADD:
+        if (B.K == Fact::Constant && A.K == Fact::Unknown)
+          Result = {Fact::TableAddress, B.Value};
+        break;
+      case Instr::LW:
+        if (A.K == Fact::TableAddress)
+          Result = {Fact::TableEntry, A.Value + Imm, 0, I};
+        break;
+      case Instr::JALR: {
+        if (A.K != Fact::TableEntry || I + 1 != NumInstrs)
+          return std::nullopt;
+        JumpTable Table{A.Load, A.Value, {}, {}};
+        for (uint32_t Address = A.Value; Table.Entries.size() < MaxJumpTableEntries; Address += 4) {
+          if (!contains(Info.ReadOnlyRegions, Address, 4))
+            break;
+          uint32_t Entry = read32(Manager, Address);
+          uint32_t Target = (Entry + A.Addend + Imm) & ~1U;
+          if (!contains(Info.ExecutableRegions, Target, 2))
+            break;
+          Table.Entries.push_back(Entry);
+          Table.Targets.push_back(Target);
+        }
+        if (Table.Entries.empty())
+          return std::nullopt;
+        return Table;
+      }
+      default:
+        break;
+    }
+    // Anything else may have written rd; forgetting a register is safe.
+    if (regDest(InstructionData) != 0)
+      Regs[regDest(InstructionData)] = Result;
+    PC += Length;
+  }
+  return std::nullopt;
+}
+
+void buildTableLoad(IRData& Data, JumpTable const& Table, uint32_t InstructionData) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::LLVMContext& Ctx = B.getContext();
+  llvm::Value *Address = B.CreateAdd(Data.readReg(regSrc1(InstructionData)), B.getInt32(immediate(Instr::LW, InstructionData)));
+
+  auto *Other = llvm::BasicBlock::Create(Ctx, "table_other", Data.CurrentFunction);
+  auto *Done = llvm::BasicBlock::Create(Ctx, "table_done", Data.CurrentFunction);
+  auto *Switch = B.CreateSwitch(Address, Other, Table.Entries.size());
+  B.SetInsertPoint(Done);
+  llvm::PHINode *Value = B.CreatePHI(B.getInt32Ty(), Table.Entries.size() + 1);
+  for (size_t I = 0; I < Table.Entries.size(); ++I) {
+    auto *Case = llvm::BasicBlock::Create(Ctx, "table_case", Data.CurrentFunction, Other);
+    Switch->addCase(B.getInt32(Table.Base + 4 * I), Case);
+    B.SetInsertPoint(Case);
+    B.CreateBr(Done);
+    Value->addIncoming(B.getInt32(Table.Entries[I]), Case);
+  }
+
+  B.SetInsertPoint(Other);
+  llvm::Value *Loaded = Data.readMemory(4, Address);
+  B.CreateBr(Done);
+  Value->addIncoming(Loaded, B.GetInsertBlock());
+  B.SetInsertPoint(Done);
+  Data.writeReg(regDest(InstructionData), Value);
+}
+
+} // end namespace riscv
@@ -0,0 +1,181 @@
+#include "Libc.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <llvm/ExecutionEngine/Orc/AbsoluteSymbols.h>
+#include <llvm/IR/IRBuilder.h>
+
+namespace riscv {
+
+namespace {
+
+struct RoutineName {
+  LibcRoutine Routine;
+  char const* Name;
+};
+
+constexpr RoutineName RoutineNames[] = {
+    {LibcRoutine::Memcpy, "memcpy"}, {LibcRoutine::Memmove, "memmove"}, {LibcRoutine::Memset, "memset"},
+    {LibcRoutine::Memcmp, "memcmp"}, {LibcRoutine::Strlen, "strlen"},
+};
+
+SegmentManager* segmentOf(MemoryManager* Manager, uint32_t Addr) {
+  for (uint32_t I = 0; I < Manager->NumSegments; ++I) {
+    SegmentManager& Segment = Manager->SegmentData[I];
+    if (Segment.GuestAddress <= Addr && Addr - Segment.GuestAddress < Segment.MemorySize)
+      return &Segment;
+  }
+  return nullptr;
+}
+
+// Host address of the Size bytes at Addr, if they are in one segment.
+uint8_t* mapRange(MemoryManager* Manager, uint32_t Addr, uint32_t Size) {
+  SegmentManager* Segment = segmentOf(Manager, Addr);
+  if (!Segment || uint64_t(Addr - Segment->GuestAddress) + Size > Segment->MemorySize)
+    return nullptr;
+  return Segment->Memory + (Addr - Segment->GuestAddress);
+}
+
+// noteStore() for every page of a write of Size bytes.
+void noteRangeStore(MemoryManager* Manager, uint32_t Addr, uint32_t Size) {
+  for (uint32_t Page = Addr >> GuestPageShift; Page <= (Addr + Size - 1) >> GuestPageShift; ++Page) {
+    if (testPage(Manager->WatchedPages, Page))
+      noteWatchedStore(Manager, Page);
+  }
+}
+
+// memcpy is done as memmove: an overlapping copy has no single right result,
+// and this is one of them.
+void guestMemmove(MemoryManager* Manager, uint32_t Dst, uint32_t Src, uint32_t Size) {
+  if (!Size)
+    return;
+  uint8_t* To = mapRange(Manager, Dst, Size);
+  uint8_t const* From = mapRange(Manager, Src, Size);
+  if (To && From) {
+    std::memmove(To, From, Size);
+    noteRangeStore(Manager, Dst, Size);
+    return;
+  }
+  if (Dst - Src < Size) {
+    for (uint32_t I = Size; I-- > 0;)
+      write8(Manager, Dst + I, read8(Manager, Src + I));
+  } else {
+    for (uint32_t I = 0; I < Size; ++I)
+      write8(Manager, Dst + I, read8(Manager, Src + I));
+  }
+}
+
+void guestMemset(MemoryManager* Manager, uint32_t Dst, uint8_t Value, uint32_t Size) {
+  if (!Size)
+    return;
+  if (uint8_t* To = mapRange(Manager, Dst, Size)) {
+    std::memset(To, Value, Size);
+    noteRangeStore(Manager, Dst, Size);
+    return;
+  }
+  for (uint32_t I = 0; I < Size; ++I)
+    write8(Manager, Dst + I, Value);
+}
+
+// The difference of the first bytes that differ, as the usual C
+// implementations return.
+uint32_t guestMemcmp(MemoryManager* Manager, uint32_t L, uint32_t R, uint32_t Size) {
+  uint8_t const* Left = mapRange(Manager, L, Size);
+  uint8_t const* Right = mapRange(Manager, R, Size);
+  if (Size && Left && Right) {
+    if (!std::memcmp(Left, Right, Size))
+      return 0;
+    auto [A, B] = std::mismatch(Left, Left + Size, Right);
+    return int32_t(*A) - int32_t(*B);
+  }
+  for (uint32_t I = 0; I < Size; ++I) {
+    uint8_t A = read8(Manager, L + I);
+    uint8_t B = read8(Manager, R + I);
+    if (A != B)
+      return int32_t(A) - int32_t(B);
+  }
+  return 0;
+}
+
+// Searched a segment at a time; an unmapped byte ends the string.
+uint32_t guestStrlen(MemoryManager* Manager, uint32_t Str) {
+  uint32_t Length = 0;
+  while (SegmentManager* Segment = segmentOf(Manager, Str + Length)) {
+    uint32_t Offset = Str + Length - Segment->GuestAddress;
+    uint8_t const* Begin = Segment->Memory + Offset;
+    uint32_t Available = Segment->MemorySize - Offset;
+    if (auto const* End = static_cast<uint8_t const*>(std::memchr(Begin, 0, Available)))
+      return Length + (End - Begin);
+    Length += Available;
+  }
+  return Length;
+}
+
+// None if the symbol's code is not all mapped in one segment.
+std::optional<uint64_t> codeHash(MemoryManager* Manager, uint32_t Begin, uint32_t Size) {
+  uint8_t const* Code = mapRange(Manager, Begin, Size);
+  if (!Code)
+    return std::nullopt;
+  uint64_t Hash = 0xcbf29ce484222325;
+  for (uint32_t I = 0; I < Size; ++I)
+    Hash = (Hash ^ Code[I]) * 0x100000001b3;
+  return Hash;
+}
+
+} // end anonymous namespace
+
+char const* libcName(LibcRoutine Routine) {
+  for (auto const& Entry : RoutineNames) {
+    if (Entry.Routine == Routine)
+      return Entry.Name;
+  }
+  return "unknown";
+}
+
+void callLibc(CPUState* State, uint32_t Routine) {
+  uint32_t* Regs = State->Registers;
+  MemoryManager* Manager = State->Manager;
+  switch (static_cast<LibcRoutine>(Routine)) {
+  case LibcRoutine::Memcpy:
+  case LibcRoutine::Memmove:
+    guestMemmove(Manager, Regs[10], Regs[11], Regs[12]);
+    return;
+  case LibcRoutine::Memset:
+    guestMemset(Manager, Regs[10], Regs[11], Regs[12]);
+    return;
+  case LibcRoutine::Memcmp:
+    Regs[10] = guestMemcmp(Manager, Regs[10], Regs[11], Regs[12]);
+    return;
+  case LibcRoutine::Strlen:
+    Regs[10] = guestStrlen(Manager, Regs[10]);
+    return;
+  }
+}
+
+std::vector<LibcFunction> findLibcFunctions(MemoryManager* Manager, ElfCodeInfo const& Info) {
+  std::vector<LibcFunction> Result;
+  for (auto const& Symbol : Info.NamedFunctions) {
+    for (auto const& Entry : RoutineNames) {
+      if (Symbol.Name != Entry.Name)
+        continue;
+      if (auto Hash = codeHash(Manager, Symbol.Address, Symbol.Size))
+        Result.push_back({Entry.Routine, Symbol.Address, *Hash});
+    }
+  }
+  return Result;
+}
+
+void buildLibcCall(IRData& Data, LibcRoutine Routine) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  B.CreateCall(Data.LibcFunction, {Data.CurrentFunction->getArg(0), B.getInt32(static_cast<uint32_t>(Routine))});
+  Data.writePC(B.CreateAnd(Data.readReg(1), B.getInt32(~1U)));
+}
+
+llvm::Error addHostLibc(llvm::orc::LLJIT& JIT) {
+  return JIT.getMainJITDylib().define(llvm::orc::absoluteSymbols({
+      {JIT.mangleAndIntern(LibcSymbol),
+       llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(&callLibc), llvm::JITSymbolFlags::Exported)},
+  }));
+}
+
+} // end namespace riscv
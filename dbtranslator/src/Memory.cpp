@@ -28,7 +28,10 @@ llvm::Type* getMemoryType(llvm::LLVMContext& Ctx) {
   }
   llvm::StructType *MemTy = llvm::StructType::create(Ctx, "MemoryManager");
 
-  MemTy->setBody({ llvm::PointerType::getUnqual(llvm::PointerType::getUnqual(getSegmentType(Ctx))), llvm::Type::getInt32Ty(Ctx) });
+  llvm::Type *i8PtrTy = llvm::PointerType::getUnqual(llvm::Type::getInt8Ty(Ctx));
+  llvm::Type *i32Ty = llvm::Type::getInt32Ty(Ctx);
+  MemTy->setBody({ llvm::PointerType::getUnqual(llvm::PointerType::getUnqual(getSegmentType(Ctx))), i32Ty,
+                   i8PtrTy, i8PtrTy, i8PtrTy, i32Ty, i8PtrTy, llvm::PointerType::getUnqual(i32Ty), i32Ty });
   return MemTy;
 }
 
@@ -54,16 +57,36 @@ uint32_t read32(MemoryManager* Manager, uint32_t Addr) {
 void write8(MemoryManager* Manager, uint32_t Addr, uint8_t Data) {
   uint8_t* MappedAddr = mapAddress<uint8_t>(Manager, Addr);
   *MappedAddr = Data;
+  noteStore(Manager, Addr, sizeof(Data));
 }
 
 void write16(MemoryManager* Manager, uint32_t Addr, uint16_t Data) {
   uint16_t* MappedAddr = mapAddress<uint16_t>(Manager, Addr);
   *MappedAddr = Data;
+  noteStore(Manager, Addr, sizeof(Data));
 }
 
 void write32(MemoryManager* Manager, uint32_t Addr, uint32_t Data) {
   uint32_t* MappedAddr = mapAddress<uint32_t>(Manager, Addr);
   *MappedAddr = Data;
+  noteStore(Manager, Addr, sizeof(Data));
+}
+
+void readVector(MemoryManager* Manager, uint32_t Addr, uint32_t Stride, uint32_t Size, uint32_t Mask, uint8_t* Data) {
+  copyElementsIn(Manager, Addr, Stride, Size, Mask, Data);
+}
+
+void writeVector(MemoryManager* Manager, uint32_t Addr, uint32_t Stride, uint32_t Size, uint32_t Mask,
+                 uint8_t const* Data) {
+  copyElementsOut(Manager, Addr, Stride, Size, Mask, Data);
+}
+
+uint32_t* atomicAddress(MemoryManager* Manager, uint32_t Addr) {
+  return mapAddress<uint32_t>(Manager, Addr);
+}
+
+void atomicStored(MemoryManager* Manager, uint32_t Addr) {
+  noteStore(Manager, Addr, sizeof(uint32_t));
 }
 
 } // end namespace riscv
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "MemoryRuntime.h"
+#include "Memory.h"
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/ExecutionEngine/Orc/AbsoluteSymbols.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
+
+namespace riscv {
+
+namespace {
+
+// Generated at build time from runtime/MemoryRuntime.cpp.
+constexpr unsigned char RuntimeBitcode[] = {
+#include "MemoryRuntime.inc"
+};
+
+} // end anonymous namespace
+
+llvm::Error addHostMemoryRuntime(llvm::orc::LLJIT& JIT) {
+  auto Symbol = [](auto* Function) {
+    return llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(Function), llvm::JITSymbolFlags::Exported);
+  };
+  return JIT.getMainJITDylib().define(llvm::orc::absoluteSymbols({
+      {JIT.mangleAndIntern("read8"), Symbol(&read8)},
+      {JIT.mangleAndIntern("read16"), Symbol(&read16)},
+      {JIT.mangleAndIntern("read32"), Symbol(&read32)},
+      {JIT.mangleAndIntern("write8"), Symbol(&write8)},
+      {JIT.mangleAndIntern("write16"), Symbol(&write16)},
+      {JIT.mangleAndIntern("write32"), Symbol(&write32)},
+      {JIT.mangleAndIntern("readVector"), Symbol(&readVector)},
+      {JIT.mangleAndIntern("writeVector"), Symbol(&writeVector)},
+      {JIT.mangleAndIntern("atomicAddress"), Symbol(&atomicAddress)},
+      {JIT.mangleAndIntern("atomicStored"), Symbol(&atomicStored)},
+  }));
+}
+
+llvm::Expected<std::unique_ptr<llvm::Module>> loadMemoryRuntime(llvm::LLVMContext& Ctx) {
+  llvm::StringRef Bitcode(reinterpret_cast<char const*>(RuntimeBitcode), sizeof(RuntimeBitcode));
+  return llvm::parseBitcodeFile(llvm::MemoryBufferRef(Bitcode, "MemoryRuntime.bc"), Ctx);
+}
+
+llvm::Error linkMemoryRuntime(llvm::Module& M) {
+  auto Runtime = loadMemoryRuntime(M.getContext());
+  if (!Runtime)
+    return Runtime.takeError();
+  (*Runtime)->setDataLayout(M.getDataLayout());
+  (*Runtime)->setTargetTriple(M.getTargetTriple());
+  bool Failed = llvm::Linker::linkModules(M, std::move(*Runtime), llvm::Linker::LinkOnlyNeeded,
+                                          [](llvm::Module& M, llvm::StringSet<> const& Linked) {
+    for (auto const& Name : Linked) {
+      llvm::Function* F = M.getFunction(Name.getKey());
+      F->setLinkage(llvm::GlobalValue::InternalLinkage);
+      F->addFnAttr(llvm::Attribute::AlwaysInline);
+    }
+  });
+  if (Failed)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), "cannot link the memory runtime into %s",
+                                   M.getModuleIdentifier().c_str());
+  llvm::legacy::PassManager PM;
+  PM.add(llvm::createAlwaysInlinerLegacyPass());
+  PM.run(M);
+  return llvm::Error::success();
+}
+
+} // end namespace riscv
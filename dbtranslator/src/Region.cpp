@@ -0,0 +1,119 @@
+#include "Region.h"
+#include "CPU.h"
+#include "Translator.h"
+#include <algorithm>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/IR/MDBuilder.h>
+
+namespace riscv {
+
+namespace {
+
+// Fields of CPUState after the reservation.
+enum StateField : unsigned { RegionInstrs = 12, RegionBudget = 13 };
+
+// Branch weights are 32-bit; scale all weights of one terminator together so
+// their ratios survive.
+std::vector<uint32_t> scaleWeights(std::vector<uint64_t> const& Counts) {
+  uint64_t Max = *std::max_element(Counts.begin(), Counts.end());
+  uint64_t Scale = Max / UINT32_MAX + 1;
+  std::vector<uint32_t> Weights;
+  for (uint64_t Count : Counts)
+    Weights.push_back(std::max<uint64_t>(Count / Scale, 1));
+  return Weights;
+}
+
+} // end anonymous namespace
+
+std::vector<RegionBlock> formRegion(uint32_t Head, RegionLookup Lookup, size_t MaxBlocks, uint64_t MinEdgeShare) {
+  std::vector<RegionBlock> Blocks;
+  std::unordered_set<uint32_t> Seen{Head};
+  std::deque<uint32_t> Worklist{Head};
+  while (!Worklist.empty() && Blocks.size() < MaxBlocks) {
+    RegionBlock Block;
+    if (!Lookup(Worklist.front(), Block)) {
+      Worklist.pop_front();
+      continue;
+    }
+    Worklist.pop_front();
+    // Depth-first along the likelier successor (pushed last, popped first) so
+    // the hot path is laid out as straight-line fall-through.
+    int Order[] = {0, 1};
+    if (Block.Edges.Counts[1] < Block.Edges.Counts[0])
+      std::swap(Order[0], Order[1]);
+    for (int I : Order) {
+      uint64_t Count = Block.Edges.Counts[I];
+      uint32_t Target = Block.Edges.Targets[I];
+      if (!Count || Count * MinEdgeShare < Block.ExecCount || !Seen.insert(Target).second)
+        continue;
+      Worklist.push_front(Target);
+    }
+    Blocks.push_back(Block);
+  }
+  return Blocks;
+}
+
+void buildRegion(IRData& Data, MemoryManager* Manager, std::vector<RegionBlock> const& Blocks) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::LLVMContext& Ctx = B.getContext();
+  llvm::Function* F = Data.CurrentFunction;
+  auto *CPUStructTy = getCPUStateType(Ctx);
+
+  std::unordered_map<uint32_t, llvm::BasicBlock*> Entries;
+  std::unordered_map<uint32_t, size_t> Order;
+  for (size_t Index = 0; Index < Blocks.size(); ++Index) {
+    Order[Blocks[Index].PC] = Index;
+    Entries[Blocks[Index].PC] = llvm::BasicBlock::Create(Ctx, "pc_" + llvm::utohexstr(Blocks[Index].PC), F);
+  }
+  // Created last so it is placed after all guest blocks.
+  auto *Exit = llvm::BasicBlock::Create(Ctx, "exit", F);
+
+  llvm::Value* InstrsPtr = B.CreateStructGEP(CPUStructTy, F->getArg(0), RegionInstrs);
+  llvm::Value* BudgetPtr = B.CreateStructGEP(CPUStructTy, F->getArg(0), RegionBudget);
+  B.CreateBr(Entries[Blocks.front().PC]);
+  llvm::MDBuilder MDB(Ctx);
+  for (size_t Index = 0; Index < Blocks.size(); ++Index) {
+    RegionBlock const& Block = Blocks[Index];
+    B.SetInsertPoint(Entries[Block.PC]);
+    emitBlock(Data, Manager, Block.PC, Block.NumInstrs);
+    llvm::Value* Instrs = B.CreateAdd(B.CreateLoad(B.getInt32Ty(), InstrsPtr), B.getInt32(Block.NumInstrs));
+    B.CreateStore(Instrs, InstrsPtr);
+
+    llvm::Value* PCPtr = B.CreateStructGEP(CPUStructTy, F->getArg(0), 1);
+    llvm::Value* NextPC = B.CreateLoad(B.getInt32Ty(), PCPtr);
+    llvm::BasicBlock* Current = B.GetInsertBlock();
+    auto *Switch = B.CreateSwitch(NextPC, Exit, EdgeProfile::NumTargets);
+    // Weights[0] is the default (leave the region) destination.
+    std::vector<uint64_t> Weights{Block.Edges.OtherCount};
+    for (int I = 0; I < EdgeProfile::NumTargets; ++I) {
+      if (!Block.Edges.Counts[I])
+        continue;
+      auto It = Entries.find(Block.Edges.Targets[I]);
+      if (It == Entries.end()) {
+        Weights[0] += Block.Edges.Counts[I];
+        continue;
+      }
+      // Every loop in the region has an edge back to a block laid out no
+      // later than its source; that is where a spent budget leaves.
+      llvm::BasicBlock* Target = It->second;
+      if (Order[Block.Edges.Targets[I]] <= Index) {
+        Target = llvm::BasicBlock::Create(Ctx, "back_" + llvm::utohexstr(Block.PC), F, Exit);
+        B.SetInsertPoint(Target);
+        llvm::Value* Spent = B.CreateICmpUGE(Instrs, B.CreateLoad(B.getInt32Ty(), BudgetPtr));
+        B.CreateCondBr(Spent, Exit, It->second, MDB.createBranchWeights(scaleWeights({1, Block.Edges.Counts[I]})));
+        B.SetInsertPoint(Current);
+      }
+      Switch->addCase(B.getInt32(Block.Edges.Targets[I]), Target);
+      Weights.push_back(Block.Edges.Counts[I]);
+    }
+    Switch->setMetadata(llvm::LLVMContext::MD_prof, MDB.createBranchWeights(scaleWeights(Weights)));
+  }
+
+  B.SetInsertPoint(Exit);
+  B.CreateRetVoid();
+}
+
+} // end namespace riscv
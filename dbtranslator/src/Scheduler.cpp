@@ -0,0 +1,154 @@
+#include "Scheduler.h"
+#include "Engine.h"
+#include <algorithm>
+#include <thread>
+
+using namespace llvm;
+
+namespace riscv {
+
+// Waiting is raised before Changes is checked and read after it is bumped,
+// so either the waiter sees the change or the notifier sees the waiter and
+// takes the mutex, which the waiter holds until it sleeps.
+void IdleWorkers::notify() {
+  ++Changes;
+  if (Waiting) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Wakeup.notify_all();
+  }
+}
+
+void IdleWorkers::wait(uint64_t Seen) {
+  std::unique_lock<std::mutex> Lock(Mutex);
+  ++Waiting;
+  Wakeup.wait(Lock, [&] { return Changes != Seen; });
+  --Waiting;
+}
+
+void RunQueue::push(size_t Task) {
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Tasks.push_back(Task);
+  }
+  Idle.notify();
+}
+
+std::optional<size_t> RunQueue::pop() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (Tasks.empty())
+    return std::nullopt;
+  size_t Task = Tasks.front();
+  Tasks.pop_front();
+  return Task;
+}
+
+std::optional<size_t> RunQueue::stealFrom(RunQueue& Victim) {
+  std::deque<size_t> Stolen;
+  {
+    std::lock_guard<std::mutex> Lock(Victim.Mutex);
+    size_t Count = (Victim.Tasks.size() + 1) / 2;
+    Stolen.assign(Victim.Tasks.end() - Count, Victim.Tasks.end());
+    Victim.Tasks.resize(Victim.Tasks.size() - Count);
+  }
+  if (Stolen.empty())
+    return std::nullopt;
+  size_t Task = Stolen.front();
+  Stolen.pop_front();
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Tasks.insert(Tasks.end(), Stolen.begin(), Stolen.end());
+  return Task;
+}
+
+// A guest stops when its hart 0 does; its other harts finish at their next
+// turn. Workers without tasks sleep until a task is pushed, which another
+// worker does whenever a quantum ends, and look for one to steal again,
+// until every task finished.
+Expected<std::vector<Engine::StopReason>> Engine::runAll(ArrayRef<Guest*> Guests, unsigned Workers, uint64_t Quantum) {
+  struct Task {
+    Guest* G;
+    size_t GuestIndex;
+    CPUState* State;
+  };
+  std::vector<Task> Tasks;
+  for (size_t I = 0; I < Guests.size(); ++I) {
+    Tasks.push_back({Guests[I], I, &Guests[I]->State});
+    for (auto& Hart : Guests[I]->Harts)
+      Tasks.push_back({Guests[I], I, Hart.get()});
+  }
+  std::vector<StopReason> Reasons(Guests.size(), StopReason::Exited);
+  if (Tasks.empty())
+    return Reasons;
+
+  Workers = std::clamp<size_t>(Workers, 1, Tasks.size());
+  IdleWorkers Idle;
+  std::vector<std::unique_ptr<RunQueue>> Queues;
+  for (unsigned W = 0; W < Workers; ++W)
+    Queues.push_back(std::make_unique<RunQueue>(Idle));
+  for (size_t I = 0; I < Tasks.size(); ++I)
+    Queues[I % Workers]->push(I);
+  std::vector<std::unique_ptr<JumpCache>> Caches;
+  for (unsigned W = 0; W < Workers; ++W) {
+    Caches.push_back(std::make_unique<JumpCache>());
+    Caches.back()->Generation = CodeGeneration;
+  }
+  std::vector<std::atomic<bool>> Stopped(Guests.size());
+  std::atomic<size_t> Remaining = Tasks.size();
+  std::atomic<uint64_t> RunQuanta = 0;
+  std::atomic<uint64_t> RunSteals = 0;
+  std::mutex ErrorMutex;
+  Error Result = Error::success();
+
+  auto Work = [&](unsigned W) {
+    while (Remaining.load(std::memory_order_acquire)) {
+      uint64_t Seen = Idle.changes();
+      std::optional<size_t> Next = Queues[W]->pop();
+      for (unsigned I = 1; !Next && I < Workers; ++I) {
+        Next = Queues[W]->stealFrom(*Queues[(W + I) % Workers]);
+        if (Next)
+          ++RunSteals;
+      }
+      if (!Next) {
+        Idle.wait(Seen);
+        continue;
+      }
+      Task& T = Tasks[*Next];
+      ++RunQuanta;
+      auto ReasonOrErr = runHart(*T.G, *T.State, *Caches[W], Quantum, Stopped[T.GuestIndex], /*YieldOnPause=*/true);
+      if (!ReasonOrErr) {
+        std::lock_guard<std::mutex> Lock(ErrorMutex);
+        Result = joinErrors(std::move(Result), ReasonOrErr.takeError());
+        for (auto& Flag : Stopped)
+          Flag = true;
+      } else if (*ReasonOrErr == StopReason::InstructionLimit && !Stopped[T.GuestIndex]) {
+        Queues[W]->push(*Next);
+        continue;
+      } else if (T.State == &T.G->State) {
+        Reasons[T.GuestIndex] = *ReasonOrErr;
+        Stopped[T.GuestIndex] = true;
+      }
+      if (Remaining.fetch_sub(1, std::memory_order_release) == 1)
+        Idle.notify();
+    }
+  };
+
+  Parallel = true;
+  std::vector<std::thread> Threads;
+  for (unsigned W = 1; W < Workers; ++W)
+    Threads.emplace_back(Work, W);
+  Work(0);
+  for (std::thread& Thread : Threads)
+    Thread.join();
+  Parallel = false;
+  Quanta += RunQuanta;
+  Steals += RunSteals;
+
+  if (auto Err = freeRetired())
+    Result = joinErrors(std::move(Result), std::move(Err));
+  if (auto Err = installRegions(true))
+    Result = joinErrors(std::move(Result), std::move(Err));
+  if (Result)
+    return std::move(Result);
+  return Reasons;
+}
+
+} // end namespace riscv
@@ -0,0 +1,174 @@
+#include "Snapshot.h"
+#include "Aot.h"
+#include <algorithm>
+#include <cstring>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace riscv {
+
+namespace {
+
+constexpr char Magic[8] = {'D', 'B', 'T', 'S', 'N', 'A', 'P', '3'};
+
+struct FileHeader {
+  char Magic[8];
+  FileHash ElfHash;
+  uint32_t Registers[32];
+  uint32_t PC;
+  uint32_t VL;
+  uint32_t VType;
+  uint8_t VectorRegisters[32][VectorBytes];
+  uint64_t FloatRegisters[32];
+  uint32_t FCSR;
+  uint32_t NumSegments;
+  uint32_t NumBlocks;
+};
+
+struct FileSegment {
+  uint32_t GuestAddress;
+  uint32_t MemorySize;
+  uint64_t Offset;
+};
+
+uint64_t alignTo(uint64_t Value, uint64_t Align) {
+  return (Value + Align - 1) / Align * Align;
+}
+
+} // end anonymous namespace
+
+llvm::Error Snapshot::write(llvm::StringRef Path, llvm::StringRef ElfPath, CPUState const& State,
+                            llvm::ArrayRef<DiscoveredBlock> Blocks) {
+  auto ElfHash = hashFile(ElfPath);
+  if (!ElfHash)
+    return ElfHash.takeError();
+  MemoryManager const& Manager = *State.Manager;
+
+  FileHeader Header;
+  std::memcpy(Header.Magic, Magic, sizeof(Magic));
+  Header.ElfHash = *ElfHash;
+  std::copy(std::begin(State.Registers), std::end(State.Registers), Header.Registers);
+  Header.PC = State.PC;
+  Header.VL = State.VL;
+  Header.VType = State.VType;
+  std::memcpy(Header.VectorRegisters, State.VectorRegisters, sizeof(Header.VectorRegisters));
+  std::memcpy(Header.FloatRegisters, State.FloatRegisters, sizeof(Header.FloatRegisters));
+  Header.FCSR = State.FCSR;
+  Header.NumSegments = Manager.NumSegments;
+  Header.NumBlocks = Blocks.size();
+
+  uint64_t PageSize = llvm::sys::fs::mapped_file_region::alignment();
+  std::vector<FileSegment> Segments(Manager.NumSegments);
+  uint64_t Offset = alignTo(sizeof(Header) + Segments.size() * sizeof(FileSegment) + Blocks.size() * sizeof(DiscoveredBlock), PageSize);
+  for (uint32_t I = 0; I < Manager.NumSegments; ++I) {
+    SegmentManager const& Segment = Manager.SegmentData[I];
+    Segments[I] = {Segment.GuestAddress, Segment.MemorySize, Offset};
+    Offset = alignTo(Offset + Segment.MemorySize, PageSize);
+  }
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::OF_None);
+  if (EC)
+    return llvm::createFileError(Path, EC);
+  OS.write(reinterpret_cast<char const*>(&Header), sizeof(Header));
+  OS.write(reinterpret_cast<char const*>(Segments.data()), Segments.size() * sizeof(FileSegment));
+  OS.write(reinterpret_cast<char const*>(Blocks.data()), Blocks.size() * sizeof(DiscoveredBlock));
+  // Only pages with data are written; the rest stay holes that read back as
+  // zeros. The last page of a segment is always written so the file covers
+  // the whole image.
+  for (uint32_t I = 0; I < Manager.NumSegments; ++I) {
+    SegmentManager const& Segment = Manager.SegmentData[I];
+    for (uint64_t Begin = 0; Begin < Segment.MemorySize; Begin += PageSize) {
+      uint64_t Size = std::min<uint64_t>(PageSize, Segment.MemorySize - Begin);
+      char const* Page = reinterpret_cast<char const*>(Segment.Memory) + Begin;
+      bool Last = Begin + Size == Segment.MemorySize;
+      if (!Last && std::all_of(Page, Page + Size, [](char C) { return C == 0; }))
+        continue;
+      OS.seek(Segments[I].Offset + Begin);
+      OS.write(Page, Size);
+    }
+  }
+  OS.close();
+  if (OS.has_error())
+    return llvm::createFileError(Path, OS.error());
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::unique_ptr<Snapshot>> Snapshot::restore(llvm::StringRef Path, llvm::StringRef ElfPath) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return llvm::createFileError(Path, Buffer.getError());
+  llvm::StringRef Contents = (*Buffer)->getBuffer();
+  auto Corrupt = [&] {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), "%s: not a valid snapshot", Path.str().c_str());
+  };
+
+  FileHeader Header;
+  if (Contents.size() < sizeof(Header))
+    return Corrupt();
+  std::memcpy(&Header, Contents.data(), sizeof(Header));
+  if (std::memcmp(Header.Magic, Magic, sizeof(Magic)) != 0)
+    return Corrupt();
+  auto ElfHash = hashFile(ElfPath);
+  if (!ElfHash)
+    return ElfHash.takeError();
+  if (Header.ElfHash != *ElfHash)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), "%s was taken from a different ELF than %s",
+                                   Path.str().c_str(), ElfPath.str().c_str());
+
+  uint64_t TableSize = sizeof(Header) + uint64_t(Header.NumSegments) * sizeof(FileSegment) +
+                       uint64_t(Header.NumBlocks) * sizeof(DiscoveredBlock);
+  if (Contents.size() < TableSize)
+    return Corrupt();
+  std::vector<FileSegment> Segments(Header.NumSegments);
+  std::memcpy(Segments.data(), Contents.data() + sizeof(Header), Segments.size() * sizeof(FileSegment));
+
+  std::unique_ptr<Snapshot> Result(new Snapshot());
+  Result->Blocks.resize(Header.NumBlocks);
+  std::memcpy(Result->Blocks.data(), Contents.data() + sizeof(Header) + Segments.size() * sizeof(FileSegment),
+              Result->Blocks.size() * sizeof(DiscoveredBlock));
+
+  auto FD = llvm::sys::fs::openNativeFileForRead(Path);
+  if (!FD)
+    return FD.takeError();
+  Result->Segments.resize(Segments.size());
+  for (size_t I = 0; I < Segments.size(); ++I) {
+    FileSegment const& Segment = Segments[I];
+    if (Segment.Offset % llvm::sys::fs::mapped_file_region::alignment() != 0 ||
+        Segment.Offset + Segment.MemorySize > Contents.size()) {
+      llvm::sys::fs::closeFile(*FD);
+      return Corrupt();
+    }
+    uint8_t* Memory = nullptr;
+    if (Segment.MemorySize) {
+      std::error_code EC;
+      llvm::sys::fs::mapped_file_region Mapping(*FD, llvm::sys::fs::mapped_file_region::priv, Segment.MemorySize,
+                                                Segment.Offset, EC);
+      if (EC) {
+        llvm::sys::fs::closeFile(*FD);
+        return llvm::createFileError(Path, EC);
+      }
+      Memory = reinterpret_cast<uint8_t*>(Mapping.data());
+      Result->Mappings.push_back(std::move(Mapping));
+    }
+    Result->Segments[I] = {Memory, Segment.MemorySize, Segment.GuestAddress};
+  }
+  llvm::sys::fs::closeFile(*FD);
+
+  Result->WatchedPages.reset(new uint8_t[PageBitmapBytes]());
+  Result->CodePages.reset(new uint8_t[PageBitmapBytes]());
+  Result->WrittenCodePages.reset(new uint8_t[PageBitmapBytes]());
+  Result->Manager = {Result->Segments.data(), static_cast<uint32_t>(Result->Segments.size()), Result->WatchedPages.get(),
+                     Result->CodePages.get(), Result->WrittenCodePages.get(), 0, nullptr, nullptr, 0};
+  std::copy(std::begin(Header.Registers), std::end(Header.Registers), Result->State.Registers);
+  Result->State.PC = Header.PC;
+  Result->State.VL = Header.VL;
+  Result->State.VType = Header.VType;
+  std::memcpy(Result->State.VectorRegisters, Header.VectorRegisters, sizeof(Header.VectorRegisters));
+  std::memcpy(Result->State.FloatRegisters, Header.FloatRegisters, sizeof(Header.FloatRegisters));
+  Result->State.FCSR = Header.FCSR;
+  Result->State.Manager = &Result->Manager;
+  return std::move(Result);
+}
+
+} // end namespace riscv
@@ -0,0 +1,69 @@
+#include "Syscall.h"
+#include "Memory.h"
+#include <cerrno>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ExecutionEngine/Orc/AbsoluteSymbols.h>
+#include <mutex>
+
+namespace riscv {
+
+namespace {
+
+thread_local llvm::raw_ostream* GuestStdout = nullptr;
+thread_local llvm::raw_ostream* GuestStderr = nullptr;
+// Harts of one guest share its streams.
+std::mutex WriteMutex;
+
+constexpr uint32_t SysWrite = 64;
+constexpr uint32_t SysExit = 93;
+constexpr uint32_t SysExitGroup = 94;
+
+uint32_t guestWrite(CPUState* State, uint32_t Fd, uint32_t Buffer, uint32_t Size) {
+  llvm::raw_ostream* OS;
+  if (Fd == 1)
+    OS = GuestStdout ? GuestStdout : &llvm::outs();
+  else if (Fd == 2)
+    OS = GuestStderr ? GuestStderr : &llvm::errs();
+  else
+    return -EBADF;
+  // The buffer may span segments, so it is read through the memory helpers.
+  llvm::SmallString<256> Bytes;
+  Bytes.resize(Size);
+  for (uint32_t I = 0; I < Size; ++I)
+    Bytes[I] = read8(State->Manager, Buffer + I);
+  std::lock_guard<std::mutex> Lock(WriteMutex);
+  OS->write(Bytes.data(), Bytes.size());
+  return Size;
+}
+
+} // end anonymous namespace
+
+void handleSyscall(CPUState* State) {
+  uint32_t* Regs = State->Registers;
+  switch (Regs[17]) {
+  case SysExit:
+  case SysExitGroup:
+    State->PC = 0;
+    return;
+  case SysWrite:
+    Regs[10] = guestWrite(State, Regs[10], Regs[11], Regs[12]);
+    return;
+  default:
+    Regs[10] = -ENOSYS;
+    return;
+  }
+}
+
+void setGuestOutput(llvm::raw_ostream* Stdout, llvm::raw_ostream* Stderr) {
+  GuestStdout = Stdout;
+  GuestStderr = Stderr;
+}
+
+llvm::Error addHostSyscalls(llvm::orc::LLJIT& JIT) {
+  return JIT.getMainJITDylib().define(llvm::orc::absoluteSymbols({
+      {JIT.mangleAndIntern(SyscallSymbol),
+       llvm::orc::ExecutorSymbolDef(llvm::orc::ExecutorAddr::fromPtr(&handleSyscall), llvm::JITSymbolFlags::Exported)},
+  }));
+}
+
+} // end namespace riscv
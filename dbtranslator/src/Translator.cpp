@@ -0,0 +1,163 @@
+#include "Translator.h"
+#include "CPU.h"
+#include "Compressed.h"
+#include "FloatEnv.h"
+#include "Fusion.h"
+#include "Harts.h"
+#include "JumpTable.h"
+#include "Libc.h"
+#include "Memory.h"
+#include "Syscall.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Pass.h"
+#include "llvm/Transforms/InstCombine/InstCombine.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Scalar/GVN.h"
+
+namespace riscv {
+
+void addMemoryInterface(IRData& Data) {
+  llvm::Module& M = Data.Module;
+  llvm::LLVMContext& Ctx = Data.Builder.getContext();
+
+  auto *Read8Ty = llvm::FunctionType::get(llvm::Type::getInt8Ty(Ctx), {getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx)}, false);
+  auto *Read16Ty = llvm::FunctionType::get(llvm::Type::getInt16Ty(Ctx), {getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx)}, false);
+  auto *Read32Ty = llvm::FunctionType::get(llvm::Type::getInt32Ty(Ctx), {getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx)}, false);
+
+  auto *Write8Ty = llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), {getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx), llvm::Type::getInt8Ty(Ctx)}, false);
+  auto *Write16Ty = llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), {getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx), llvm::Type::getInt16Ty(Ctx)}, false);
+  auto *Write32Ty = llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), {getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx), llvm::Type::getInt32Ty(Ctx)}, false);
+
+  Data.MemoryFunctions[0] = M.getOrInsertFunction("read8", Read8Ty);
+  Data.MemoryFunctions[1] = M.getOrInsertFunction("read16", Read16Ty);
+  Data.MemoryFunctions[2] = M.getOrInsertFunction("read32", Read32Ty);
+
+  Data.MemoryFunctions[3] = M.getOrInsertFunction("write8", Write8Ty);
+  Data.MemoryFunctions[4] = M.getOrInsertFunction("write16", Write16Ty);
+  Data.MemoryFunctions[5] = M.getOrInsertFunction("write32", Write32Ty);
+
+  auto *I32Ty = llvm::Type::getInt32Ty(Ctx);
+  auto *VectorTy = llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), {getMemoryPointerType(Ctx), I32Ty, I32Ty, I32Ty, I32Ty, llvm::PointerType::getUnqual(Ctx)}, false);
+  Data.MemoryFunctions[6] = M.getOrInsertFunction("readVector", VectorTy);
+  Data.MemoryFunctions[7] = M.getOrInsertFunction("writeVector", VectorTy);
+  auto *AtomicTy = llvm::FunctionType::get(llvm::PointerType::getUnqual(Ctx), {getMemoryPointerType(Ctx), I32Ty}, false);
+  Data.MemoryFunctions[8] = M.getOrInsertFunction("atomicAddress", AtomicTy);
+  auto *AtomicStoredTy = llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), {getMemoryPointerType(Ctx), I32Ty}, false);
+  Data.MemoryFunctions[9] = M.getOrInsertFunction("atomicStored", AtomicStoredTy);
+
+  auto *SyscallTy = llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), {getCPUStatePointerType(Ctx)}, false);
+  Data.SyscallFunction = M.getOrInsertFunction(SyscallSymbol, SyscallTy);
+
+  auto *SetRoundingTy = llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), {I32Ty}, false);
+  Data.FloatFunctions[0] = M.getOrInsertFunction(SyncFloatFlagsSymbol, SyscallTy);
+  Data.FloatFunctions[1] = M.getOrInsertFunction(ApplyRoundingSymbol, SyscallTy);
+  Data.FloatFunctions[2] = M.getOrInsertFunction(SetRoundingSymbol, SetRoundingTy);
+
+  Data.PauseFunction = M.getOrInsertFunction(PauseSymbol, llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), false));
+  auto *LibcTy = llvm::FunctionType::get(llvm::Type::getVoidTy(Ctx), {getCPUStatePointerType(Ctx), I32Ty}, false);
+  Data.LibcFunction = M.getOrInsertFunction(LibcSymbol, LibcTy);
+}
+
+void addCoverage(IRData& Data) {
+  llvm::LLVMContext& Ctx = Data.Builder.getContext();
+  auto *MapTy = llvm::ArrayType::get(llvm::Type::getInt8Ty(Ctx), CoverageMapSize);
+  Data.CoverageMap = llvm::cast<llvm::GlobalVariable>(Data.Module.getOrInsertGlobal(CoverageMapSymbol, MapTy));
+  Data.CoveragePrev = llvm::cast<llvm::GlobalVariable>(Data.Module.getOrInsertGlobal(CoveragePrevSymbol, llvm::Type::getInt32Ty(Ctx)));
+}
+
+// Map[Prev ^ Cur]++ and Prev = Cur >> 1, as in AFL.
+static void emitEdgeCoverage(IRData& Data, uint32_t PC) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  uint32_t Cur = coverageId(PC);
+  llvm::Value* Prev = B.CreateLoad(B.getInt32Ty(), Data.CoveragePrev);
+  llvm::Value* Index = B.CreateZExt(B.CreateXor(Prev, B.getInt32(Cur)), B.getInt64Ty());
+  llvm::Value* Slot = B.CreateInBoundsGEP(Data.CoverageMap->getValueType(), Data.CoverageMap, {B.getInt64(0), Index});
+  B.CreateStore(B.CreateAdd(B.CreateLoad(B.getInt8Ty(), Slot), B.getInt8(1)), Slot);
+  B.CreateStore(B.getInt32(Cur >> 1), Data.CoveragePrev);
+}
+
+size_t emitBlock(IRData& Data, MemoryManager* Manager, uint32_t PC, size_t Threshold) {
+  if (Data.CoverageMap)
+    emitEdgeCoverage(Data, PC);
+  Data.VType.reset();
+  if (Data.Libc) {
+    auto It = Data.Libc->find(PC);
+    if (It != Data.Libc->end()) {
+      buildLibcCall(Data, It->second);
+      return 1;
+    }
+  }
+  std::optional<JumpTable> Table;
+  if (Data.CodeInfo)
+    Table = findJumpTable(Manager, *Data.CodeInfo, PC, blockLength(Manager, PC, Threshold));
+  bool Continue = true;
+  uint32_t TempPC = PC;
+  size_t NumInstrs = 0;
+  while (Continue && NumInstrs < Threshold) {
+    Data.PC = TempPC;
+    uint32_t InstructionData = fetchInstruction(Manager, TempPC, Data.Length);
+    Instr CurrentInstruction = decode(InstructionData);
+    if (Table && NumInstrs == Table->LoadIndex) {
+      buildTableLoad(Data, *Table, InstructionData);
+      TempPC = Data.nextPC();
+      ++NumInstrs;
+      continue;
+    }
+    // A pair is only fused when both halves fit the block, so the block
+    // still ends where blockLength() says, and never takes a table load.
+    if (!endsBlock(CurrentInstruction) && NumInstrs + 2 <= Threshold &&
+        !(Table && NumInstrs + 1 == Table->LoadIndex)) {
+      uint32_t NextLength;
+      uint32_t NextData = fetchInstruction(Manager, Data.nextPC(), NextLength);
+      Instr NextInstruction = decode(NextData);
+      Fusion Kind = matchFusion(CurrentInstruction, InstructionData, NextInstruction, NextData);
+      if (Kind != Fusion::None) {
+        buildFusion(Data, Kind, CurrentInstruction, InstructionData, NextInstruction, NextData, NextLength);
+        TempPC = Data.nextPC();
+        NumInstrs += 2;
+        Continue = !endsBlock(NextInstruction);
+        continue;
+      }
+    }
+    generate(CurrentInstruction, InstructionData, Data);
+    TempPC = Data.nextPC();
+    ++NumInstrs;
+    Continue = !endsBlock(CurrentInstruction);
+  }
+  // Straight-line instructions leave the PC alone; only the block's exit
+  // point is stored.
+  if (Continue)
+    Data.writePC(Data.Builder.getInt32(TempPC));
+  return NumInstrs;
+}
+
+size_t blockLength(MemoryManager* Manager, uint32_t PC, size_t Threshold) {
+  size_t NumInstrs = 0;
+  while (NumInstrs < Threshold) {
+    uint32_t Length;
+    Instr CurrentInstruction = decode(fetchInstruction(Manager, PC, Length));
+    PC += Length;
+    ++NumInstrs;
+    if (endsBlock(CurrentInstruction))
+      return NumInstrs;
+  }
+  return NumInstrs;
+}
+
+uint32_t blockEnd(MemoryManager* Manager, uint32_t PC, size_t NumInstrs) {
+  for (size_t I = 0; I < NumInstrs; ++I)
+    PC += instructionLength(read16(Manager, PC));
+  return PC;
+}
+
+void optimizeModule(llvm::Module& M) {
+  auto FPM = std::make_unique<llvm::legacy::FunctionPassManager>(&M);
+  FPM->add(llvm::createInstructionCombiningPass());
+  FPM->add(llvm::createReassociatePass());
+  FPM->add(llvm::createGVNPass());
+  FPM->add(llvm::createCFGSimplificationPass());
+  FPM->doInitialization();
+  for (auto &F : M) FPM->run(F);
+}
+
+} // end namespace riscv
@@ -0,0 +1,367 @@
+// Lowering of the supported subset of the V extension to LLVM fixed-width
+// vector IR. The vector registers live in CPUState and hold VectorBytes
+// bytes; only LMUL 1 and SEW of 8, 16 and 32 are supported, anything else
+// sets vill. An instruction computes all lanes of a register and merges the
+// result into the lanes below vl (and, when masked, with their v0 bit set),
+// which keeps the tail and inactive elements undisturbed.
+
+#include "CPU.h"
+#include "Instruction.h"
+#include <cstdint>
+#include <utility>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Intrinsics.h>
+
+namespace riscv {
+
+namespace {
+
+bool isMasked(uint32_t InstructionData) { return !((InstructionData >> 25) & 0x1); }
+
+unsigned numLanes(unsigned SEW) { return VectorBytes * 8 / SEW; }
+
+// vsew field of vtype for SEW.
+uint32_t vsew(unsigned SEW) { return SEW == 8 ? 0x00 : SEW == 16 ? 0x08 : 0x10; }
+
+llvm::FixedVectorType* vectorType(llvm::IRBuilder<>& B, unsigned SEW) {
+  return llvm::FixedVectorType::get(B.getIntNTy(SEW), numLanes(SEW));
+}
+
+llvm::Value* readVectorReg(IRData& Data, uint32_t Reg, unsigned SEW) {
+  return Data.Builder.CreateAlignedLoad(vectorType(Data.Builder, SEW), Data.vectorReg(Reg), llvm::Align(8));
+}
+
+void writeVectorReg(IRData& Data, uint32_t Reg, llvm::Value* Value) {
+  Data.Builder.CreateAlignedStore(Value, Data.vectorReg(Reg), llvm::Align(8));
+}
+
+// Lanes an instruction with elements of Width bits updates: those below vl
+// and, for a masked instruction, with their bit set in v0.
+llvm::Value* activeLanes(IRData& Data, uint32_t InstructionData, unsigned Width) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  unsigned Lanes = numLanes(Width);
+  llvm::SmallVector<llvm::Constant*, 32> Indices;
+  for (unsigned I = 0; I < Lanes; ++I)
+    Indices.push_back(B.getInt32(I));
+  llvm::Value *VL = B.CreateVectorSplat(Lanes, B.CreateLoad(B.getInt32Ty(), Data.VLPtr));
+  llvm::Value *Active = B.CreateICmpULT(llvm::ConstantVector::get(Indices), VL);
+  if (isMasked(InstructionData)) {
+    llvm::Value *Bits = B.CreateAlignedLoad(B.getIntNTy(Lanes), Data.vectorReg(0), llvm::Align(8));
+    Active = B.CreateAnd(Active, B.CreateBitCast(Bits, llvm::FixedVectorType::get(B.getInt1Ty(), Lanes)));
+  }
+  return Active;
+}
+
+// The active lanes as the i32 bit mask readVector and writeVector take.
+llvm::Value* laneMask(IRData& Data, uint32_t InstructionData, unsigned Width) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::Value *Active = activeLanes(Data, InstructionData, Width);
+  return B.CreateZExt(B.CreateBitCast(Active, B.getIntNTy(numLanes(Width))), B.getInt32Ty());
+}
+
+void writeActive(IRData& Data, uint32_t Reg, unsigned SEW, llvm::Value* Active, llvm::Value* Value) {
+  llvm::Value *Old = readVectorReg(Data, Reg, SEW);
+  writeVectorReg(Data, Reg, Data.Builder.CreateSelect(Active, Value, Old));
+}
+
+// Emits Body for the element width in effect. When the block set vtype with
+// an immediate the width is known and only that one is emitted; otherwise
+// all three are, behind a switch on CPUState::VType. Nothing is emitted for
+// vill.
+void forEachWidth(IRData& Data, llvm::function_ref<void(unsigned)> Body) {
+  if (Data.VType) {
+    for (unsigned SEW : {8, 16, 32}) {
+      if ((*Data.VType & ~0xC0U) == vsew(SEW))
+        Body(SEW);
+    }
+    return;
+  }
+  llvm::IRBuilder<>& B = Data.Builder;
+  llvm::LLVMContext& Ctx = B.getContext();
+  llvm::Value *VType = B.CreateLoad(B.getInt32Ty(), Data.VTypePtr);
+  auto *Done = llvm::BasicBlock::Create(Ctx, "vector_done", Data.CurrentFunction);
+  auto *Switch = B.CreateSwitch(B.CreateAnd(VType, B.getInt32(~0xC0U)), Done, 3);
+  for (unsigned SEW : {8, 16, 32}) {
+    auto *Case = llvm::BasicBlock::Create(Ctx, "e" + llvm::Twine(SEW), Data.CurrentFunction, Done);
+    Switch->addCase(B.getInt32(vsew(SEW)), Case);
+    B.SetInsertPoint(Case);
+    Body(SEW);
+    B.CreateBr(Done);
+  }
+  B.SetInsertPoint(Done);
+}
+
+// Sets vl and vtype for an application vector length AVL, as vsetvli,
+// vsetivli and vsetvl do, and writes the new vl to rd. Constant operands
+// fold, so Data.VType learns the configuration of the immediate forms.
+void buildVectorConfig(IRData& Data, uint32_t InstructionData, llvm::Value* AVL, llvm::Value* VType) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  // Supported: only vsew (below 3), vta and vma may be set.
+  llvm::Value *Supported = B.CreateAnd(B.CreateICmpEQ(B.CreateAnd(VType, B.getInt32(~0xD8U)), B.getInt32(0)),
+                                       B.CreateICmpNE(B.CreateAnd(VType, B.getInt32(0x38)), B.getInt32(0x18)));
+  llvm::Value *VLMax = B.CreateLShr(B.getInt32(VectorBytes), B.CreateAnd(B.CreateLShr(VType, 3), B.getInt32(0x7)));
+  llvm::Value *VL = B.CreateSelect(Supported, B.CreateBinaryIntrinsic(llvm::Intrinsic::umin, AVL, VLMax), B.getInt32(0));
+  VType = B.CreateSelect(Supported, VType, B.getInt32(VTypeIllegal));
+  B.CreateStore(VL, Data.VLPtr);
+  B.CreateStore(VType, Data.VTypePtr);
+  Data.writeReg(regDest(InstructionData), VL);
+  if (auto *Known = llvm::dyn_cast<llvm::ConstantInt>(VType))
+    Data.VType = Known->getZExtValue();
+  else
+    Data.VType.reset();
+}
+
+// rs1 is the AVL; x0 asks for VLMAX, or keeps vl when rd is x0 as well.
+llvm::Value* requestedLength(IRData& Data, uint32_t InstructionData) {
+  if (regSrc1(InstructionData) != 0)
+    return Data.readReg(regSrc1(InstructionData));
+  if (regDest(InstructionData) != 0)
+    return Data.Builder.getInt32(0xFFFFFFFF);
+  return Data.Builder.CreateLoad(Data.Builder.getInt32Ty(), Data.VLPtr);
+}
+
+enum class Operand {
+  Vector,
+  Scalar,
+  Immediate,
+};
+
+// The second source of an OPIVV/OPIVX/OPIVI instruction: vs1, or rs1 or
+// simm5 splat to every lane.
+llvm::Value* secondOperand(IRData& Data, Instr InstrType, uint32_t InstructionData, Operand Kind, unsigned SEW) {
+  llvm::IRBuilder<>& B = Data.Builder;
+  if (Kind == Operand::Vector)
+    return readVectorReg(Data, regSrc1(InstructionData), SEW);
+  llvm::Value *Scalar = Kind == Operand::Scalar ? Data.readReg(regSrc1(InstructionData))
+                                                : B.getInt32(immediate(InstrType, InstructionData));
+  return B.CreateVectorSplat(numLanes(SEW), B.CreateTrunc(Scalar, B.getIntNTy(SEW)));
+}
+
+// vd = vs2 op second operand; Reverse swaps the operands (vrsub).
+void buildVectorBinary(IRData& Data, Instr InstrType, uint32_t InstructionData, llvm::Instruction::BinaryOps Op,
+                       Operand Kind, bool Reverse = false) {
+  forEachWidth(Data, [&](unsigned SEW) {
+    llvm::Value *L = readVectorReg(Data, regSrc2(InstructionData), SEW);
+    llvm::Value *R = secondOperand(Data, InstrType, InstructionData, Kind, SEW);
+    if (Reverse)
+      std::swap(L, R);
+    llvm::Value *Result = Data.Builder.CreateBinOp(Op, L, R);
+    writeActive(Data, regDest(InstructionData), SEW, activeLanes(Data, InstructionData, SEW), Result);
+  });
+}
+
+void buildVectorMove(IRData& Data, Instr InstrType, uint32_t InstructionData, Operand Kind) {
+  forEachWidth(Data, [&](unsigned SEW) {
+    llvm::Value *Value = secondOperand(Data, InstrType, InstructionData, Kind, SEW);
+    writeActive(Data, regDest(InstructionData), SEW, activeLanes(Data, InstructionData, SEW), Value);
+  });
+}
+
+enum class Reduction {
+  Sum,
+  And,
+  Or,
+  Xor,
+  MinU,
+  Min,
+  MaxU,
+  Max,
+};
+
+// vd[0] = vs1[0] op (active elements of vs2), written unless vl is 0.
+// Inactive elements are replaced with the identity of op and the whole
+// register is reduced with llvm.vector.reduce.*.
+void buildReduction(IRData& Data, uint32_t InstructionData, Reduction Kind) {
+  forEachWidth(Data, [&](unsigned SEW) {
+    llvm::IRBuilder<>& B = Data.Builder;
+    unsigned Lanes = numLanes(SEW);
+    llvm::APInt Identity = Kind == Reduction::And || Kind == Reduction::MinU ? llvm::APInt::getAllOnes(SEW)
+                           : Kind == Reduction::Min                          ? llvm::APInt::getSignedMaxValue(SEW)
+                           : Kind == Reduction::Max                          ? llvm::APInt::getSignedMinValue(SEW)
+                                                                             : llvm::APInt::getZero(SEW);
+    llvm::Value *Elements = B.CreateSelect(activeLanes(Data, InstructionData, SEW),
+                                           readVectorReg(Data, regSrc2(InstructionData), SEW),
+                                           B.CreateVectorSplat(Lanes, B.getInt(Identity)));
+    llvm::Value *Start = B.CreateExtractElement(readVectorReg(Data, regSrc1(InstructionData), SEW), uint64_t(0));
+    llvm::Value *Result = nullptr;
+    switch (Kind) {
+      case Reduction::Sum: Result = B.CreateAdd(Start, B.CreateAddReduce(Elements)); break;
+      case Reduction::And: Result = B.CreateAnd(Start, B.CreateAndReduce(Elements)); break;
+      case Reduction::Or: Result = B.CreateOr(Start, B.CreateOrReduce(Elements)); break;
+      case Reduction::Xor: Result = B.CreateXor(Start, B.CreateXorReduce(Elements)); break;
+      case Reduction::MinU:
+        Result = B.CreateBinaryIntrinsic(llvm::Intrinsic::umin, Start, B.CreateIntMinReduce(Elements, false));
+        break;
+      case Reduction::Min:
+        Result = B.CreateBinaryIntrinsic(llvm::Intrinsic::smin, Start, B.CreateIntMinReduce(Elements, true));
+        break;
+      case Reduction::MaxU:
+        Result = B.CreateBinaryIntrinsic(llvm::Intrinsic::umax, Start, B.CreateIntMaxReduce(Elements, false));
+        break;
+      case Reduction::Max:
+        Result = B.CreateBinaryIntrinsic(llvm::Intrinsic::smax, Start, B.CreateIntMaxReduce(Elements, true));
+        break;
+    }
+    llvm::Value *Old = readVectorReg(Data, regDest(InstructionData), SEW);
+    llvm::Value *VL = B.CreateLoad(B.getInt32Ty(), Data.VLPtr);
+    llvm::Value *New = B.CreateSelect(B.CreateICmpNE(VL, B.getInt32(0)), Result,
+                                      B.CreateExtractElement(Old, uint64_t(0)));
+    writeVectorReg(Data, regDest(InstructionData), B.CreateInsertElement(Old, New, uint64_t(0)));
+  });
+}
+
+// Loads and stores transfer vl elements of the encoded width whatever SEW
+// is; vill leaves vl at 0, so they need no check of vtype. Only the
+// elements that fit in one register are transferred.
+void buildVectorLoad(IRData& Data, uint32_t InstructionData, unsigned Bytes, bool Strided) {
+  llvm::Value *Stride = Strided ? Data.readReg(regSrc2(InstructionData)) : Data.Builder.getInt32(Bytes);
+  Data.readVectorMemory(regDest(InstructionData), Data.readReg(regSrc1(InstructionData)), Stride, Bytes,
+                        laneMask(Data, InstructionData, Bytes * 8));
+}
+
+void buildVectorStore(IRData& Data, uint32_t InstructionData, unsigned Bytes, bool Strided) {
+  llvm::Value *Stride = Strided ? Data.readReg(regSrc2(InstructionData)) : Data.Builder.getInt32(Bytes);
+  Data.writeVectorMemory(regDest(InstructionData), Data.readReg(regSrc1(InstructionData)), Stride, Bytes,
+                         laneMask(Data, InstructionData, Bytes * 8));
+}
+
+} // end anonymous namespace
+
+void VSETVLIInstruction::build_ir(IRData& Data) {
+  buildVectorConfig(Data, InstructionData, requestedLength(Data, InstructionData),
+                    Data.Builder.getInt32(immediate(Instr::VSETVLI, InstructionData)));
+}
+
+void VSETIVLIInstruction::build_ir(IRData& Data) {
+  buildVectorConfig(Data, InstructionData, Data.Builder.getInt32(regSrc1(InstructionData)),
+                    Data.Builder.getInt32(immediate(Instr::VSETIVLI, InstructionData)));
+}
+
+void VSETVLInstruction::build_ir(IRData& Data) {
+  buildVectorConfig(Data, InstructionData, requestedLength(Data, InstructionData),
+                    Data.readReg(regSrc2(InstructionData)));
+}
+
+void VLE8Instruction::build_ir(IRData& Data) { buildVectorLoad(Data, InstructionData, 1, false); }
+void VLE16Instruction::build_ir(IRData& Data) { buildVectorLoad(Data, InstructionData, 2, false); }
+void VLE32Instruction::build_ir(IRData& Data) { buildVectorLoad(Data, InstructionData, 4, false); }
+void VLSE8Instruction::build_ir(IRData& Data) { buildVectorLoad(Data, InstructionData, 1, true); }
+void VLSE16Instruction::build_ir(IRData& Data) { buildVectorLoad(Data, InstructionData, 2, true); }
+void VLSE32Instruction::build_ir(IRData& Data) { buildVectorLoad(Data, InstructionData, 4, true); }
+void VSE8Instruction::build_ir(IRData& Data) { buildVectorStore(Data, InstructionData, 1, false); }
+void VSE16Instruction::build_ir(IRData& Data) { buildVectorStore(Data, InstructionData, 2, false); }
+void VSE32Instruction::build_ir(IRData& Data) { buildVectorStore(Data, InstructionData, 4, false); }
+void VSSE8Instruction::build_ir(IRData& Data) { buildVectorStore(Data, InstructionData, 1, true); }
+void VSSE16Instruction::build_ir(IRData& Data) { buildVectorStore(Data, InstructionData, 2, true); }
+void VSSE32Instruction::build_ir(IRData& Data) { buildVectorStore(Data, InstructionData, 4, true); }
+
+void VADDVVInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VADDVV, InstructionData, llvm::Instruction::Add, Operand::Vector);
+}
+
+void VADDVXInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VADDVX, InstructionData, llvm::Instruction::Add, Operand::Scalar);
+}
+
+void VADDVIInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VADDVI, InstructionData, llvm::Instruction::Add, Operand::Immediate);
+}
+
+void VSUBVVInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VSUBVV, InstructionData, llvm::Instruction::Sub, Operand::Vector);
+}
+
+void VSUBVXInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VSUBVX, InstructionData, llvm::Instruction::Sub, Operand::Scalar);
+}
+
+void VRSUBVXInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VRSUBVX, InstructionData, llvm::Instruction::Sub, Operand::Scalar, true);
+}
+
+void VRSUBVIInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VRSUBVI, InstructionData, llvm::Instruction::Sub, Operand::Immediate, true);
+}
+
+void VMULVVInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VMULVV, InstructionData, llvm::Instruction::Mul, Operand::Vector);
+}
+
+void VMULVXInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VMULVX, InstructionData, llvm::Instruction::Mul, Operand::Scalar);
+}
+
+void VANDVVInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VANDVV, InstructionData, llvm::Instruction::And, Operand::Vector);
+}
+
+void VANDVXInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VANDVX, InstructionData, llvm::Instruction::And, Operand::Scalar);
+}
+
+void VANDVIInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VANDVI, InstructionData, llvm::Instruction::And, Operand::Immediate);
+}
+
+void VORVVInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VORVV, InstructionData, llvm::Instruction::Or, Operand::Vector);
+}
+
+void VORVXInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VORVX, InstructionData, llvm::Instruction::Or, Operand::Scalar);
+}
+
+void VORVIInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VORVI, InstructionData, llvm::Instruction::Or, Operand::Immediate);
+}
+
+void VXORVVInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VXORVV, InstructionData, llvm::Instruction::Xor, Operand::Vector);
+}
+
+void VXORVXInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VXORVX, InstructionData, llvm::Instruction::Xor, Operand::Scalar);
+}
+
+void VXORVIInstruction::build_ir(IRData& Data) {
+  buildVectorBinary(Data, Instr::VXORVI, InstructionData, llvm::Instruction::Xor, Operand::Immediate);
+}
+
+void VMVVVInstruction::build_ir(IRData& Data) { buildVectorMove(Data, Instr::VMVVV, InstructionData, Operand::Vector); }
+void VMVVXInstruction::build_ir(IRData& Data) { buildVectorMove(Data, Instr::VMVVX, InstructionData, Operand::Scalar); }
+void VMVVIInstruction::build_ir(IRData& Data) {
+  buildVectorMove(Data, Instr::VMVVI, InstructionData, Operand::Immediate);
+}
+
+// x[rd] = vs2[0], sign-extended; done even when vl is 0.
+void VMVXSInstruction::build_ir(IRData& Data) {
+  forEachWidth(Data, [&](unsigned SEW) {
+    llvm::IRBuilder<>& B = Data.Builder;
+    llvm::Value *Element = B.CreateExtractElement(readVectorReg(Data, regSrc2(InstructionData), SEW), uint64_t(0));
+    Data.writeReg(regDest(InstructionData), B.CreateSExt(Element, B.getInt32Ty()));
+  });
+}
+
+// vd[0] = x[rs1] unless vl is 0.
+void VMVSXInstruction::build_ir(IRData& Data) {
+  forEachWidth(Data, [&](unsigned SEW) {
+    llvm::IRBuilder<>& B = Data.Builder;
+    llvm::Value *Old = readVectorReg(Data, regDest(InstructionData), SEW);
+    llvm::Value *VL = B.CreateLoad(B.getInt32Ty(), Data.VLPtr);
+    llvm::Value *New = B.CreateSelect(B.CreateICmpNE(VL, B.getInt32(0)),
+                                      B.CreateTrunc(Data.readReg(regSrc1(InstructionData)), B.getIntNTy(SEW)),
+                                      B.CreateExtractElement(Old, uint64_t(0)));
+    writeVectorReg(Data, regDest(InstructionData), B.CreateInsertElement(Old, New, uint64_t(0)));
+  });
+}
+
+void VREDSUMInstruction::build_ir(IRData& Data) { buildReduction(Data, InstructionData, Reduction::Sum); }
+void VREDANDInstruction::build_ir(IRData& Data) { buildReduction(Data, InstructionData, Reduction::And); }
+void VREDORInstruction::build_ir(IRData& Data) { buildReduction(Data, InstructionData, Reduction::Or); }
+void VREDXORInstruction::build_ir(IRData& Data) { buildReduction(Data, InstructionData, Reduction::Xor); }
+void VREDMINUInstruction::build_ir(IRData& Data) { buildReduction(Data, InstructionData, Reduction::MinU); }
+void VREDMINInstruction::build_ir(IRData& Data) { buildReduction(Data, InstructionData, Reduction::Min); }
+void VREDMAXUInstruction::build_ir(IRData& Data) { buildReduction(Data, InstructionData, Reduction::MaxU); }
+void VREDMAXInstruction::build_ir(IRData& Data) { buildReduction(Data, InstructionData, Reduction::Max); }
+
+} // end namespace riscv
@@ -0,0 +1,193 @@
+// Machine-code templates for the baseline tier. This file is not part of the
+// library: it is compiled by clang at build time (large code model, no PIC)
+// and stencil-gen turns every stencil_* and glue_* function into a byte
+// array plus the list of holes to patch. Every reference to a _JIT_* symbol
+// becomes a 64-bit absolute relocation that the baseline compiler fills with
+// a register index, an immediate, the guest PC or the one after it, a runtime
+// helper address or the address of the next stencil.
+
+#include "CPU.h"
+#include "Memory.h"
+#include <cstdint>
+
+using riscv::CPUState;
+using riscv::MemoryManager;
+
+extern "C" {
+extern char _JIT_RD[];
+extern char _JIT_RS1[];
+extern char _JIT_RS2[];
+extern char _JIT_IMM[];
+extern char _JIT_PC[];
+extern char _JIT_NEXT_PC[];
+
+void _JIT_CONTINUE(CPUState*);
+
+uint8_t _JIT_READ8(MemoryManager*, uint32_t);
+uint16_t _JIT_READ16(MemoryManager*, uint32_t);
+uint32_t _JIT_READ32(MemoryManager*, uint32_t);
+void _JIT_WRITE8(MemoryManager*, uint32_t, uint8_t);
+void _JIT_WRITE16(MemoryManager*, uint32_t, uint16_t);
+void _JIT_WRITE32(MemoryManager*, uint32_t, uint32_t);
+void _JIT_SYSCALL(CPUState*);
+}
+
+#define HOLE(Name) static_cast<uint32_t>(reinterpret_cast<uintptr_t>(_JIT_##Name))
+#define RD  (S->Registers[HOLE(RD)])
+#define RS1 (S->Registers[HOLE(RS1)])
+#define RS2 (S->Registers[HOLE(RS2)])
+#define SRS1 (static_cast<int32_t>(RS1))
+#define SRS2 (static_cast<int32_t>(RS2))
+#define IMM HOLE(IMM)
+#define GUEST_PC HOLE(PC)
+// Address of the following instruction: GUEST_PC + 2 after a compressed one.
+#define NEXT_PC HOLE(NEXT_PC)
+#define CONTINUE [[clang::musttail]] return _JIT_CONTINUE(S)
+
+#define STENCIL(Name) extern "C" void stencil_##Name(CPUState* S)
+#define GLUE(Name) extern "C" void glue_##Name(CPUState* S)
+
+// Straight-line stencils never touch S->PC; the dispatcher only observes the
+// PC at block exit, where a control-transfer stencil or glue_SETPC sets it.
+// Stencils that write rd are skipped by the compiler when rd is x0, except
+// JAL/JALR, which restore x0 themselves.
+
+STENCIL(LUI) { RD = IMM; CONTINUE; }
+STENCIL(AUIPC) { RD = GUEST_PC + IMM; CONTINUE; }
+
+STENCIL(JAL) {
+  RD = NEXT_PC;
+  S->Registers[0] = 0;
+  S->PC = GUEST_PC + IMM;
+  CONTINUE;
+}
+
+STENCIL(JALR) {
+  uint32_t Target = (RS1 + IMM) & ~1U;
+  RD = NEXT_PC;
+  S->Registers[0] = 0;
+  S->PC = Target;
+  CONTINUE;
+}
+
+STENCIL(BEQ)  { S->PC = RS1 == RS2 ? GUEST_PC + IMM : NEXT_PC; CONTINUE; }
+STENCIL(BNE)  { S->PC = RS1 != RS2 ? GUEST_PC + IMM : NEXT_PC; CONTINUE; }
+STENCIL(BLT)  { S->PC = SRS1 < SRS2 ? GUEST_PC + IMM : NEXT_PC; CONTINUE; }
+STENCIL(BGE)  { S->PC = SRS1 >= SRS2 ? GUEST_PC + IMM : NEXT_PC; CONTINUE; }
+STENCIL(BLTU) { S->PC = RS1 < RS2 ? GUEST_PC + IMM : NEXT_PC; CONTINUE; }
+STENCIL(BGEU) { S->PC = RS1 >= RS2 ? GUEST_PC + IMM : NEXT_PC; CONTINUE; }
+
+STENCIL(LB)  { RD = static_cast<int8_t>(_JIT_READ8(S->Manager, RS1 + IMM)); CONTINUE; }
+STENCIL(LH)  { RD = static_cast<int16_t>(_JIT_READ16(S->Manager, RS1 + IMM)); CONTINUE; }
+STENCIL(LW)  { RD = _JIT_READ32(S->Manager, RS1 + IMM); CONTINUE; }
+STENCIL(LBU) { RD = _JIT_READ8(S->Manager, RS1 + IMM); CONTINUE; }
+STENCIL(LHU) { RD = _JIT_READ16(S->Manager, RS1 + IMM); CONTINUE; }
+
+STENCIL(SB) { _JIT_WRITE8(S->Manager, RS1 + IMM, RS2); CONTINUE; }
+STENCIL(SH) { _JIT_WRITE16(S->Manager, RS1 + IMM, RS2); CONTINUE; }
+STENCIL(SW) { _JIT_WRITE32(S->Manager, RS1 + IMM, RS2); CONTINUE; }
+
+STENCIL(ADDI)  { RD = RS1 + IMM; CONTINUE; }
+STENCIL(SLTI)  { RD = SRS1 < static_cast<int32_t>(IMM); CONTINUE; }
+STENCIL(SLTIU) { RD = RS1 < IMM; CONTINUE; }
+STENCIL(XORI)  { RD = RS1 ^ IMM; CONTINUE; }
+STENCIL(ORI)   { RD = RS1 | IMM; CONTINUE; }
+STENCIL(ANDI)  { RD = RS1 & IMM; CONTINUE; }
+STENCIL(SLLI)  { RD = RS1 << (IMM & 0x1F); CONTINUE; }
+STENCIL(SRLI)  { RD = RS1 >> (IMM & 0x1F); CONTINUE; }
+STENCIL(SRAI)  { RD = SRS1 >> (IMM & 0x1F); CONTINUE; }
+
+STENCIL(ADD)  { RD = RS1 + RS2; CONTINUE; }
+STENCIL(SUB)  { RD = RS1 - RS2; CONTINUE; }
+STENCIL(SLL)  { RD = RS1 << (RS2 & 0x1F); CONTINUE; }
+STENCIL(SLT)  { RD = SRS1 < SRS2; CONTINUE; }
+STENCIL(SLTU) { RD = RS1 < RS2; CONTINUE; }
+STENCIL(XOR)  { RD = RS1 ^ RS2; CONTINUE; }
+STENCIL(SRL)  { RD = RS1 >> (RS2 & 0x1F); CONTINUE; }
+STENCIL(SRA)  { RD = SRS1 >> (RS2 & 0x1F); CONTINUE; }
+STENCIL(OR)   { RD = RS1 | RS2; CONTINUE; }
+STENCIL(AND)  { RD = RS1 & RS2; CONTINUE; }
+
+// M extension. Division by zero and INT_MIN / -1 divide by 1 and then
+// select their RISC-V results; see safeDivisor in Instruction.cpp.
+STENCIL(MUL)    { RD = RS1 * RS2; CONTINUE; }
+STENCIL(MULH)   { RD = static_cast<uint64_t>(int64_t{SRS1} * int64_t{SRS2}) >> 32; CONTINUE; }
+STENCIL(MULHSU) { RD = static_cast<uint64_t>(int64_t{SRS1} * static_cast<int64_t>(RS2)) >> 32; CONTINUE; }
+STENCIL(MULHU)  { RD = (uint64_t{RS1} * uint64_t{RS2}) >> 32; CONTINUE; }
+
+STENCIL(DIV) {
+  int32_t Dividend = SRS1, Divisor = SRS2;
+  bool Special = Divisor == 0 || (Dividend == INT32_MIN && Divisor == -1);
+  int32_t Quotient = Dividend / (Special ? 1 : Divisor);
+  RD = Divisor == 0 ? -1 : Quotient;
+  CONTINUE;
+}
+
+STENCIL(DIVU) {
+  uint32_t Dividend = RS1, Divisor = RS2;
+  uint32_t Quotient = Dividend / (Divisor == 0 ? 1 : Divisor);
+  RD = Divisor == 0 ? UINT32_MAX : Quotient;
+  CONTINUE;
+}
+
+STENCIL(REM) {
+  int32_t Dividend = SRS1, Divisor = SRS2;
+  bool Special = Divisor == 0 || (Dividend == INT32_MIN && Divisor == -1);
+  int32_t Remainder = Dividend % (Special ? 1 : Divisor);
+  RD = Divisor == 0 ? Dividend : Remainder;
+  CONTINUE;
+}
+
+STENCIL(REMU) {
+  uint32_t Dividend = RS1, Divisor = RS2;
+  uint32_t Remainder = Dividend % (Divisor == 0 ? 1 : Divisor);
+  RD = Divisor == 0 ? Dividend : Remainder;
+  CONTINUE;
+}
+
+// Zba, Zbb and Zbs; see the matching build_ir for ORC.B.
+STENCIL(SH1ADD) { RD = (RS1 << 1) + RS2; CONTINUE; }
+STENCIL(SH2ADD) { RD = (RS1 << 2) + RS2; CONTINUE; }
+STENCIL(SH3ADD) { RD = (RS1 << 3) + RS2; CONTINUE; }
+STENCIL(ANDN)   { RD = RS1 & ~RS2; CONTINUE; }
+STENCIL(ORN)    { RD = RS1 | ~RS2; CONTINUE; }
+STENCIL(XNOR)   { RD = ~(RS1 ^ RS2); CONTINUE; }
+STENCIL(CLZ)    { RD = RS1 ? __builtin_clz(RS1) : 32; CONTINUE; }
+STENCIL(CTZ)    { RD = RS1 ? __builtin_ctz(RS1) : 32; CONTINUE; }
+STENCIL(CPOP)   { RD = __builtin_popcount(RS1); CONTINUE; }
+STENCIL(MAX)    { RD = SRS1 > SRS2 ? RS1 : RS2; CONTINUE; }
+STENCIL(MAXU)   { RD = RS1 > RS2 ? RS1 : RS2; CONTINUE; }
+STENCIL(MIN)    { RD = SRS1 < SRS2 ? RS1 : RS2; CONTINUE; }
+STENCIL(MINU)   { RD = RS1 < RS2 ? RS1 : RS2; CONTINUE; }
+STENCIL(SEXTB)  { RD = static_cast<int8_t>(RS1); CONTINUE; }
+STENCIL(SEXTH)  { RD = static_cast<int16_t>(RS1); CONTINUE; }
+STENCIL(ZEXTH)  { RD = RS1 & 0xFFFF; CONTINUE; }
+STENCIL(ROL)    { RD = __builtin_rotateleft32(RS1, RS2 & 0x1F); CONTINUE; }
+STENCIL(ROR)    { RD = __builtin_rotateright32(RS1, RS2 & 0x1F); CONTINUE; }
+STENCIL(RORI)   { RD = __builtin_rotateright32(RS1, IMM & 0x1F); CONTINUE; }
+STENCIL(ORCB) {
+  uint32_t NonZero = (((RS1 & 0x7F7F7F7F) + 0x7F7F7F7F) | RS1) & 0x80808080;
+  RD = (NonZero >> 7) * 0xFF;
+  CONTINUE;
+}
+STENCIL(REV8)   { RD = __builtin_bswap32(RS1); CONTINUE; }
+STENCIL(BCLR)   { RD = RS1 & ~(1U << (RS2 & 0x1F)); CONTINUE; }
+STENCIL(BCLRI)  { RD = RS1 & ~(1U << (IMM & 0x1F)); CONTINUE; }
+STENCIL(BEXT)   { RD = (RS1 >> (RS2 & 0x1F)) & 1; CONTINUE; }
+STENCIL(BEXTI)  { RD = (RS1 >> (IMM & 0x1F)) & 1; CONTINUE; }
+STENCIL(BINV)   { RD = RS1 ^ (1U << (RS2 & 0x1F)); CONTINUE; }
+STENCIL(BINVI)  { RD = RS1 ^ (1U << (IMM & 0x1F)); CONTINUE; }
+STENCIL(BSET)   { RD = RS1 | (1U << (RS2 & 0x1F)); CONTINUE; }
+STENCIL(BSETI)  { RD = RS1 | (1U << (IMM & 0x1F)); CONTINUE; }
+
+// See ECALLInstruction::build_ir.
+STENCIL(ECALL) {
+  S->PC = NEXT_PC;
+  _JIT_SYSCALL(S);
+  CONTINUE;
+}
+
+// Block epilogues: SETPC records the fall-through PC when a block is cut by
+// the size threshold, RETURN hands control back to the dispatcher.
+GLUE(SETPC) { S->PC = GUEST_PC; CONTINUE; }
+GLUE(RETURN) {}
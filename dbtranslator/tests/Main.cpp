@@ -1,161 +1,113 @@
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <iostream>
-#include <llvm/Support/Error.h>
-#include <llvm/IR/BasicBlock.h>
-#include <llvm/IR/Function.h>
-#include <llvm/IR/Type.h>
 #include <memory>
-#include "llvm/IRReader/IRReader.h"
-#include "llvm/Support/SourceMgr.h"
-
-#include "llvm/ADT/StringRef.h"
-#include "llvm/ExecutionEngine/Orc/LLJIT.h"
-#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
-#include <llvm/ExecutionEngine/ExecutionEngine.h>
-#include <llvm/ExecutionEngine/GenericValue.h>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include "llvm/IR/IRBuilder.h"
-#include "llvm/IR/LLVMContext.h"
-#include "llvm/IR/Module.h"
+#include <thread>
+#include <vector>
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/InitLLVM.h"
-#include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/IR/LegacyPassManager.h"
-#include "llvm/Transforms/InstCombine/InstCombine.h"
-#include "llvm/Transforms/Scalar.h"
-#include "llvm/Transforms/Scalar/GVN.h"
 #include <argparse/argparse.hpp>
 
-#include "Binary.h"
-#include "CPU.h"
-#include "Instruction.h"
-#include "Memory.h"
+#include "Coverage.h"
+#include "Engine.h"
+#include "Fuzz.h"
 
 using namespace llvm;
-using namespace llvm::orc;
-
-static ThreadSafeModule optimizeModuleSimple(ThreadSafeModule TSM) {
-  TSM.withModuleDo([](Module &M) {
-    auto FPM = std::make_unique<legacy::FunctionPassManager>(&M);
-    FPM->add(createInstructionCombiningPass());
-    FPM->add(createReassociatePass());
-    FPM->add(createGVNPass());
-    FPM->add(createCFGSimplificationPass());
-    FPM->doInitialization();
-    for (auto &F : M) FPM->run(F);
-  });
-  return TSM;
+
+// Parses a BEGIN:END:SIZE override; addresses accept a 0x prefix.
+static bool parseSizeOverride(std::string const& Text, uint32_t& Begin, uint32_t& End, size_t& Size) {
+  SmallVector<StringRef, 3> Fields;
+  StringRef(Text).split(Fields, ':');
+  unsigned long long Values[3];
+  if (Fields.size() != 3)
+    return false;
+  for (int I = 0; I < 3; ++I) {
+    if (getAsUnsignedInteger(Fields[I], 0, Values[I]))
+      return false;
+  }
+  Begin = Values[0];
+  End = Values[1];
+  Size = Values[2];
+  return Begin < End && Size > 0;
 }
 
-static void addMemoryInterface(riscv::IRData& Data) {
-  Module& M = Data.Module;
-  LLVMContext& Ctx = Data.Builder.getContext();
-  auto *MemType = riscv::getMemoryType(Ctx);
-  
-  auto *Read8Ty = FunctionType::get(Type::getInt8Ty(Ctx), {riscv::getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx)}, false);
-  auto *Read16Ty = FunctionType::get(Type::getInt16Ty(Ctx), {riscv::getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx)}, false);
-  auto *Read32Ty = FunctionType::get(Type::getInt32Ty(Ctx), {riscv::getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx)}, false);
-  
-  auto *Write8Ty = FunctionType::get(Type::getVoidTy(Ctx), {riscv::getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx), llvm::Type::getInt8Ty(Ctx)}, false);
-  auto *Write16Ty = FunctionType::get(Type::getVoidTy(Ctx), {riscv::getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx), llvm::Type::getInt16Ty(Ctx)}, false);
-  auto *Write32Ty = FunctionType::get(Type::getVoidTy(Ctx), {riscv::getMemoryPointerType(Ctx), llvm::Type::getInt32Ty(Ctx), llvm::Type::getInt32Ty(Ctx)}, false);
-
-  Data.MemoryFunctions[0] = M.getOrInsertFunction("read8", Read8Ty);
-  Data.MemoryFunctions[1] = M.getOrInsertFunction("read16", Read16Ty);
-  Data.MemoryFunctions[2] = M.getOrInsertFunction("read32", Read32Ty);
-  
-  Data.MemoryFunctions[3] = M.getOrInsertFunction("write8", Write8Ty);
-  Data.MemoryFunctions[4] = M.getOrInsertFunction("write16", Write16Ty);
-  Data.MemoryFunctions[5] = M.getOrInsertFunction("write32", Write32Ty);
+// Parses a guest address; accepts a 0x prefix.
+static bool parseAddress(std::optional<std::string> const& Text, uint32_t& Address) {
+  unsigned long long Value;
+  if (!Text || getAsUnsignedInteger(*Text, 0, Value) || Value > UINT32_MAX)
+    return false;
+  Address = Value;
+  return true;
 }
 
-static Expected<std::string> generateFunc(riscv::CPUState const* State, std::unordered_map<uint32_t, std::string>& PCToFunc, LLJIT& JIT, size_t Threshold, bool DebugMode) {
-
-  auto CtxPtr = std::make_unique<LLVMContext>();
-  auto MPtr   = std::make_unique<Module>("Module " + std::to_string(State->PC), *CtxPtr);
-
-  LLVMContext& Ctx = *CtxPtr;
-  Module& M = *MPtr;
-  
-  auto *cpuStructTy = riscv::getCPUStateType(Ctx);
-  auto *regsArrTy   = ArrayType::get(Type::getInt32Ty(Ctx), 32);
-  auto *cpuPtrTy = riscv::getCPUStatePointerType(Ctx);
-
-  std::string FuncName = "block_" + std::to_string(State->PC);
-
-  auto *fnTy = FunctionType::get(Type::getVoidTy(Ctx), {cpuPtrTy}, false);
-  auto *F    = Function::Create(fnTy, Function::ExternalLinkage, FuncName, &M);
-  
-  PCToFunc.insert({State->PC, FuncName});
-
-  llvm::IRBuilder<> B{Ctx};
-  auto *BB = BasicBlock::Create(Ctx, "entry", F);
-  B.SetInsertPoint(BB);
-  riscv::IRData IRData_{M, B, F};
-  addMemoryInterface(IRData_);
-  bool Continue = true;
-  uint32_t TempPC = State->PC;
-  int NumInstrs = 0;
-  while (Continue && NumInstrs < Threshold) {
-    uint32_t InstructionData = riscv::read32(State->Manager, TempPC);
-    TempPC += 4;
-    riscv::Instr CurrentInstruction = riscv::decode(InstructionData);
-    riscv::generate(CurrentInstruction, InstructionData, IRData_);
-    ++NumInstrs;
-    switch (CurrentInstruction) {
-      case riscv::Instr::BEQ:
-      case riscv::Instr::BNE:
-      case riscv::Instr::BLT:
-      case riscv::Instr::BGE:
-      case riscv::Instr::BLTU:
-      case riscv::Instr::BGEU:
-      case riscv::Instr::JAL:
-      case riscv::Instr::JALR:
-        Continue = false;
-        break;
-      default:
-        break;
+// Runs Count guests of the ELF side by side, a slice of instructions each in
+// turn, sharing the engine's translations. Returns the first guest's a0.
+static int runInstances(riscv::Engine& Engine, int Count, unsigned Workers, uint64_t Quantum) {
+  std::vector<std::unique_ptr<riscv::Engine::Guest>> Guests;
+  for (int I = 0; I < Count; ++I) {
+    auto GuestOrErr = Engine.spawn();
+    if (!GuestOrErr) {
+      logAllUnhandledErrors(GuestOrErr.takeError(), errs());
+      return EXIT_FAILURE;
     }
+    Guests.push_back(std::move(*GuestOrErr));
   }
-  B.CreateRetVoid();
-  ThreadSafeModule TSM(std::move(MPtr), std::move(CtxPtr));
-  TSM = optimizeModuleSimple(std::move(TSM));
-
-  if (DebugMode) TSM.getModuleUnlocked()->dump();
-  if (auto Err = JIT.addIRModule(std::move(TSM))) {
-    return Err;
+  std::vector<riscv::Engine::Guest*> Pointers;
+  for (auto& Guest : Guests)
+    Pointers.push_back(Guest.get());
+  auto Stops = Engine.runAll(Pointers, Workers, Quantum);
+  if (!Stops) {
+    logAllUnhandledErrors(Stops.takeError(), errs());
+    return EXIT_FAILURE;
   }
-  return FuncName;
+  int Result = Guests.front()->registers()[10];
+  for (int I = 0; I < Count; ++I)
+    errs() << "instance " << I << ": a0 = " << Guests[I]->registers()[10] << "\n";
+  Guests.clear();
+  Engine.printStats(errs());
+  return Result;
 }
 
-static Expected<std::unique_ptr<LLJIT>> initializeLLJIT(StringRef ELFFile) {
-  auto JITOrErr = LLJITBuilder().create();
-  if (!JITOrErr) {
-    return std::move(JITOrErr);
-  }
-  auto JIT = std::move(*JITOrErr);
-  
-  auto CtxPtr = std::make_unique<LLVMContext>();
-  SMDiagnostic Err;
-  auto M = parseIRFile(ELFFile, Err, *CtxPtr);
-
-  ThreadSafeModule TSM(std::move(M), std::move(CtxPtr));
-  TSM = optimizeModuleSimple(std::move(TSM));
-
-  if (auto Err = JIT->addIRModule(std::move(TSM))) {
-    return std::move(Err);
-  }
-  return JIT;
-} 
-
 int main(int argc, char** argv) {
   argparse::ArgumentParser program("dbtranslator");
   program.add_argument("--debug").help("show debug output").flag();
   program.add_argument("--threshold").default_value(64).help("specify threshold value").metavar("value");
   program.add_argument("--input-elf").required().help("specify the input elf file").metavar("file_name");
-  program.add_argument("--memory-impl").required().help("specify memory implementation").metavar("file_name");
+  program.add_argument("--memory-impl").help("alternative memory implementation (LLVM IR) instead of the built-in one").metavar("file_name");
+  program.add_argument("--inline-memory").help("inline the built-in memory runtime into translated code").flag();
+  program.add_argument("--baseline").help("translate blocks with the copy-and-patch baseline tier first").flag();
+  program.add_argument("--tier-up-threshold").default_value(1000).help("executions of a baseline block before it is recompiled with LLVM").metavar("value").scan<'i', int>();
+  program.add_argument("--warmup").help("translate all statically reachable blocks before execution").flag();
+  program.add_argument("--adaptive-block-size").help("size blocks by hotness and measured compile cost instead of --threshold").flag();
+  program.add_argument("--block-size-override").default_value(std::vector<std::string>{}).append().help("fixed block size for a guest address range, as BEGIN:END:SIZE").metavar("range");
+  program.add_argument("--block-size-report").help("print the chosen block sizes and compile costs at exit").flag();
+  program.add_argument("--region-threshold").default_value(10000).help("executions of a block before its hot region is recompiled with profile data (0 disables)").metavar("value").scan<'i', int>();
+  program.add_argument("--region-max-blocks").default_value(64).help("maximum number of guest blocks in one region").metavar("value").scan<'i', int>();
+  program.add_argument("--code-cache").help("directory of the persistent code cache shared between runs").metavar("dir");
+  program.add_argument("--aot-object").help("object produced by dbtranslator-aot for the input elf; needs --inline-memory and its --memory-impl, and no --coverage or --hle-libc").metavar("file_name");
+  program.add_argument("--code-budget").default_value(0).help("KiB of JIT code and data kept resident; cold translations are evicted beyond it (0 is unlimited)").metavar("kib").scan<'i', int>();
+  program.add_argument("--checkpoint").help("write a snapshot of the guest to this file when it reaches --checkpoint-pc").metavar("file_name");
+  program.add_argument("--checkpoint-pc").help("guest address at which --checkpoint is taken").metavar("address");
+  program.add_argument("--restore").help("resume the guest from a snapshot written by --checkpoint").metavar("file_name");
+  program.add_argument("--coverage").help("instrument translated code with AFL-style edge coverage").flag();
+  program.add_argument("--fuzz-pc").help("guest address of the fuzz harness; from there every --fuzz-input runs from a snapshot").metavar("address");
+  program.add_argument("--fuzz-input-addr").help("guest address the fuzz input is copied to (passed in a0, its size in a1)").metavar("address");
+  program.add_argument("--fuzz-input-max").default_value(4096).help("maximum fuzz input size in bytes").metavar("bytes").scan<'i', int>();
+  program.add_argument("--fuzz-input").default_value(std::vector<std::string>{}).append().help("fuzz input file or directory of inputs").metavar("path");
+  program.add_argument("--instances").default_value(1).help("run this many guests of the elf at once, sharing translated code").metavar("value").scan<'i', int>();
+  program.add_argument("--workers").default_value(static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))).help("threads --instances guests are scheduled on").metavar("value").scan<'i', int>();
+  program.add_argument("--quantum").default_value(1 << 16).help("guest instructions a scheduled guest runs before it yields its thread").metavar("value").scan<'i', int>();
+  program.add_argument("--harts").default_value(1).help("harts of each guest, run on parallel threads; hart N starts with mhartid N").metavar("value").scan<'i', int>();
+  program.add_argument("--hle-libc").help("run the guest's memcpy, memmove, memset, memcmp and strlen, found by symbol name, as host code").flag();
+  program.add_argument("--hle-libc-hash").default_value(std::vector<std::string>{}).append().help("only replace libc routines whose code has this hash (see --debug); implies --hle-libc").metavar("hash");
+  program.add_argument("--warmup-threads").default_value(static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))).help("number of warm-up translation threads").metavar("value").scan<'i', int>();
 
 
   try {
@@ -166,44 +118,147 @@ int main(int argc, char** argv) {
     return EXIT_FAILURE;
   }
 
-  bool DebugMode = program["--debug"] == true;
-
   InitLLVM X(argc, argv);
-  InitializeNativeTarget();
-  InitializeNativeTargetAsmPrinter();
-  InitializeNativeTargetAsmParser();
 
-  using BlockFunc = void(*)(riscv::CPUState*);
+  riscv::Engine::Options Opts;
+  Opts.Threshold = program.get<int>("--threshold");
+  Opts.DebugMode = program["--debug"] == true;
+  if (auto MemoryImpl = program.present("--memory-impl"))
+    Opts.MemoryImpl = *MemoryImpl;
+  Opts.InlineMemory = program["--inline-memory"] == true;
+  Opts.Baseline = program["--baseline"] == true;
+  Opts.TierUpThreshold = program.get<int>("--tier-up-threshold");
+  Opts.WarmUp = program["--warmup"] == true;
+  Opts.WarmUpThreads = program.get<int>("--warmup-threads");
+  Opts.AdaptiveBlockSize = program["--adaptive-block-size"] == true;
+  Opts.BlockSizeReport = program["--block-size-report"] == true;
+  for (auto const& Override : program.get<std::vector<std::string>>("--block-size-override")) {
+    riscv::Engine::BlockSizeOverride Parsed;
+    if (!parseSizeOverride(Override, Parsed.Begin, Parsed.End, Parsed.Limit)) {
+      std::cerr << "invalid --block-size-override '" << Override << "', expected BEGIN:END:SIZE" << std::endl;
+      return EXIT_FAILURE;
+    }
+    Opts.BlockSizeOverrides.push_back(Parsed);
+  }
+  Opts.RegionThreshold = program.get<int>("--region-threshold");
+  Opts.RegionMaxBlocks = program.get<int>("--region-max-blocks");
+  if (auto CacheDir = program.present("--code-cache"))
+    Opts.CodeCacheDir = *CacheDir;
+  Opts.CodeBudget = static_cast<size_t>(std::max(0, program.get<int>("--code-budget"))) * 1024;
+  Opts.Coverage = program["--coverage"] == true;
+  Opts.Harts = static_cast<unsigned>(std::max(1, program.get<int>("--harts")));
+  Opts.Libc = program["--hle-libc"] == true;
+  for (auto const& Hash : program.get<std::vector<std::string>>("--hle-libc-hash")) {
+    unsigned long long Value;
+    if (getAsUnsignedInteger(Hash, 0, Value)) {
+      std::cerr << "invalid --hle-libc-hash '" << Hash << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    Opts.Libc = true;
+    Opts.LibcHashes.push_back(Value);
+  }
+
+  uint32_t CheckpointPC = 0;
+  auto CheckpointFile = program.present("--checkpoint");
+  if (CheckpointFile && !parseAddress(program.present("--checkpoint-pc"), CheckpointPC)) {
+    std::cerr << "--checkpoint needs a guest address in --checkpoint-pc" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::unique_ptr<riscv::FuzzSession> Fuzz;
+  if (program.present("--fuzz-pc")) {
+    riscv::FuzzSession::Options FuzzOpts;
+    if (!parseAddress(program.present("--fuzz-pc"), FuzzOpts.PC) ||
+        !parseAddress(program.present("--fuzz-input-addr"), FuzzOpts.InputAddr)) {
+      std::cerr << "--fuzz-pc and --fuzz-input-addr need guest addresses" << std::endl;
+      return EXIT_FAILURE;
+    }
+    FuzzOpts.MaxInputSize = program.get<int>("--fuzz-input-max");
+    auto FuzzOrErr = riscv::FuzzSession::create(FuzzOpts, program.get<std::vector<std::string>>("--fuzz-input"));
+    if (!FuzzOrErr) {
+      logAllUnhandledErrors(FuzzOrErr.takeError(), errs());
+      return EXIT_FAILURE;
+    }
+    Fuzz = std::move(*FuzzOrErr);
+  }
+
+  // Snapshots and fuzz resets only cover the state of hart 0.
+  if (program.get<int>("--harts") > 1 && (CheckpointFile || Fuzz || program.present("--restore"))) {
+    std::cerr << "--harts cannot be combined with --checkpoint, --fuzz-pc or --restore" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  int Instances = program.get<int>("--instances");
+  if (Instances > 1 && (CheckpointFile || Fuzz || program.present("--restore"))) {
+    std::cerr << "--instances cannot be combined with --checkpoint, --fuzz-pc or --restore" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  auto EngineOrErr = riscv::Engine::create(std::move(Opts), program.get<std::string>("--input-elf"));
+  if (!EngineOrErr) {
+    logAllUnhandledErrors(EngineOrErr.takeError(), errs());
+    return EXIT_FAILURE;
+  }
+  riscv::Engine& Engine = **EngineOrErr;
 
-  auto JITOrErr = initializeLLJIT(program.get<std::string>("--memory-impl"));
-  if (!JITOrErr) {
-    logAllUnhandledErrors(JITOrErr.takeError(), errs());
+  if (auto AotObject = program.present("--aot-object")) {
+    if (auto Err = Engine.loadAotObject(*AotObject)) {
+      logAllUnhandledErrors(std::move(Err), errs());
+      return EXIT_FAILURE;
+    }
+  }
+  if (Instances > 1)
+    return runInstances(Engine, Instances, std::max(1, program.get<int>("--workers")),
+                        std::max(1, program.get<int>("--quantum")));
+  auto RestoreFile = program.present("--restore");
+  if (auto Err = RestoreFile ? Engine.restore(*RestoreFile) : Engine.load()) {
+    logAllUnhandledErrors(std::move(Err), errs());
     return EXIT_FAILURE;
   }
-  auto JIT = std::move(*JITOrErr);
-
-  riscv::MemoryManager* Manager;
-  uint32_t EntryPoint;
-
-  std::string ElfFile = program.get<std::string>("--input-elf");
-  std::tie(Manager, EntryPoint) = riscv::parseElf(ElfFile.c_str(), DebugMode);
-  riscv::CPUState State{{}, EntryPoint, Manager};
-  State.Registers[2] = -16;
-
-  std::unordered_map<uint32_t, std::string> PCToFunc;
-  while (true) {
-    auto FuncIt = PCToFunc.find(State.PC);
-    if (FuncIt == PCToFunc.end()) {
-      auto GeneratedFuncName = generateFunc(&State, PCToFunc, *JIT.get(), program.get<int>("--threshold"), DebugMode);
-      if (!GeneratedFuncName) {
-        logAllUnhandledErrors(GeneratedFuncName.takeError(), errs());
-        return EXIT_FAILURE;
+  if (CheckpointFile)
+    Engine.stopAt(CheckpointPC);
+  if (Fuzz)
+    Engine.stopAt(Fuzz->pc());
+
+  for (;;) {
+    auto Stop = Engine.run();
+    if (!Stop) {
+      logAllUnhandledErrors(Stop.takeError(), errs());
+      return EXIT_FAILURE;
+    }
+    if (*Stop == riscv::Engine::StopReason::Breakpoint) {
+      if (CheckpointFile && Engine.pc() == CheckpointPC) {
+        if (auto Err = Engine.checkpoint(*CheckpointFile)) {
+          logAllUnhandledErrors(std::move(Err), errs());
+          return EXIT_FAILURE;
+        }
+        CheckpointFile.reset();
+      }
+      if (Fuzz && !Fuzz->started() && Engine.pc() == Fuzz->pc()) {
+        if (auto Err = Fuzz->start(Engine.state())) {
+          logAllUnhandledErrors(std::move(Err), errs());
+          return EXIT_FAILURE;
+        }
+        riscv::resetCoveragePath();
       }
-      PCToFunc.insert({State.PC, GeneratedFuncName.get()});
+      continue;
     }
-    BlockFunc Fn = JIT->lookup(PCToFunc[State.PC])->toPtr<BlockFunc>();
-    Fn(&State);
-    if (DebugMode) riscv::dump(&State);
+    // A finished fuzz run starts over from the snapshot with the next input.
+    if (!Fuzz)
+      break;
+    if (!Fuzz->started()) {
+      std::cerr << "the guest exited before reaching --fuzz-pc" << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (!Fuzz->next(Engine.state()))
+      break;
+    riscv::resetCoveragePath();
   }
-  return 0;
+
+  Engine.printStats(errs());
+  if (Fuzz)
+    Fuzz->printStats(errs());
+  if (program["--coverage"] == true)
+    errs() << "coverage: " << riscv::countCoveredEdges() << " edges hit\n";
+  return Engine.registers()[10];
 }
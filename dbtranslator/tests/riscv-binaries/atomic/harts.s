@@ -0,0 +1,130 @@
+# RV32IMA on four harts (run with --harts 4): every hart adds to shared
+# counters with amoadd, with an LR/SC loop and under an amoswap spin lock,
+# then hart 0 checks the totals and the result of each AMO. Exits with 0
+# when every check passes, otherwise with the number of the failing one.
+	.option	norelax
+
+	.equ	HARTS, 4
+	.equ	ROUNDS, 2000
+
+	.macro	check reg, value, code
+	li	t6, \value
+	li	t5, \code
+	bne	\reg, t6, fail
+	.endm
+
+	.text
+	.globl	_start
+_start:
+	csrr	s1, mhartid
+	la	s0, shared
+	li	s2, ROUNDS
+	li	s3, 1
+1:
+	addi	t0, s0, 0
+	amoadd.w	zero, s3, (t0)
+	addi	t0, s0, 4
+2:
+	lr.w	t1, (t0)
+	addi	t1, t1, 1
+	sc.w	t2, t1, (t0)
+	bnez	t2, 2b
+	# Plain load and store of the third counter under the lock.
+	addi	t0, s0, 12
+3:
+	amoswap.w.aq	t1, s3, (t0)
+	bnez	t1, 3b
+	lw	t1, 8(s0)
+	addi	t1, t1, 1
+	sw	t1, 8(s0)
+	amoswap.w.rl	zero, zero, (t0)
+	addi	s2, s2, -1
+	bnez	s2, 1b
+
+	sll	t1, s3, s1
+	addi	t0, s0, 16
+	amoor.w	zero, t1, (t0)
+	addi	t0, s0, 20
+	amoadd.w.aqrl	zero, s3, (t0)
+	beqz	s1, 4f
+	li	a0, 0
+	li	a7, 93
+	ecall
+
+	# Hart 0 waits for the others.
+4:
+	lw	t1, 20(s0)
+	li	t2, HARTS
+	bne	t1, t2, 4b
+	lw	a4, 0(s0)
+	check	a4, HARTS * ROUNDS, 1
+	lw	a4, 4(s0)
+	check	a4, HARTS * ROUNDS, 2
+	lw	a4, 8(s0)
+	check	a4, HARTS * ROUNDS, 3
+	lw	a4, 16(s0)
+	check	a4, (1 << HARTS) - 1, 4
+
+	# Each AMO returns the old value and stores its result.
+	addi	t0, s0, 24
+	li	t1, -5
+	sw	t1, 0(t0)
+	li	t2, 3
+	amoswap.w	a4, t2, (t0)
+	check	a4, -5, 5
+	amoxor.w	a4, t2, (t0)
+	check	a4, 3, 6
+	lw	a4, 0(t0)
+	check	a4, 0, 7
+	li	t2, 0x0ff0
+	sw	t2, 0(t0)
+	li	t2, 0x00ff
+	amoand.w	zero, t2, (t0)
+	lw	a4, 0(t0)
+	check	a4, 0xf0, 8
+	amoor.w	zero, t2, (t0)
+	lw	a4, 0(t0)
+	check	a4, 0xff, 9
+	li	t1, -5
+	amomin.w	a4, t1, (t0)
+	lw	a4, 0(t0)
+	check	a4, -5, 10
+	li	t1, 7
+	amomax.w	zero, t1, (t0)
+	lw	a4, 0(t0)
+	check	a4, 7, 11
+	li	t1, -1
+	amominu.w	zero, t1, (t0)
+	lw	a4, 0(t0)
+	check	a4, 7, 12
+	amomaxu.w	zero, t1, (t0)
+	lw	a4, 0(t0)
+	check	a4, -1, 13
+
+	# sc without a reservation fails and stores nothing; after lr it
+	# succeeds once.
+	li	t1, 42
+	sc.w	a4, t1, (t0)
+	check	a4, 1, 14
+	lw	a4, 0(t0)
+	check	a4, -1, 15
+	lr.w	a4, (t0)
+	sc.w	a4, t1, (t0)
+	check	a4, 0, 16
+	lw	a4, 0(t0)
+	check	a4, 42, 17
+	sc.w	a4, zero, (t0)
+	check	a4, 1, 18
+
+	li	t5, 0
+fail:
+	mv	a0, t5
+	li	a7, 93
+	ecall
+
+	.data
+	.p2align	2
+	# amoadd counter, LR/SC counter, locked counter, lock, hart bits,
+	# harts done, scratch.
+shared:
+	.space	28
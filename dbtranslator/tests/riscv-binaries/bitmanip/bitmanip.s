@@ -0,0 +1,368 @@
+# RV32I with Zba, Zbb and Zbs: every register form over a table of
+# operands loaded at run time, then the immediate forms. Exits with 0 when
+# every check passes, otherwise with the number of the failing one:
+# 10 + 10 * instruction + row for the two-operand table, 170 + 10 *
+# instruction + row for the one-operand table.
+	.option	norelax
+
+	.equ	ROWS, 10
+
+	.macro	check reg, value, code
+	li	t6, \value
+	li	t5, \code
+	bne	\reg, t6, fail
+	.endm
+
+	# Runs \insn on each row (a, b, expected) of \table.
+	.macro	rows2 insn, table, code
+	la	s0, \table
+	li	s1, 0
+1:
+	lw	t0, 0(s0)
+	lw	t1, 4(s0)
+	lw	t2, 8(s0)
+	\insn	a4, t0, t1
+	addi	t5, s1, \code
+	bne	a4, t2, fail
+	addi	s0, s0, 12
+	addi	s1, s1, 1
+	li	t3, ROWS
+	blt	s1, t3, 1b
+	.endm
+
+	# Runs \insn on each row (a, expected) of \table.
+	.macro	rows1 insn, table, code
+	la	s0, \table
+	li	s1, 0
+1:
+	lw	t0, 0(s0)
+	lw	t2, 4(s0)
+	\insn	a4, t0
+	addi	t5, s1, \code
+	bne	a4, t2, fail
+	addi	s0, s0, 8
+	addi	s1, s1, 1
+	li	t3, ROWS
+	blt	s1, t3, 1b
+	.endm
+
+	.text
+	.globl	_start
+_start:
+	rows2	sh1add, sh1add_rows, 10
+	rows2	sh2add, sh2add_rows, 20
+	rows2	sh3add, sh3add_rows, 30
+	rows2	andn, andn_rows, 40
+	rows2	orn, orn_rows, 50
+	rows2	xnor, xnor_rows, 60
+	rows2	min, min_rows, 70
+	rows2	minu, minu_rows, 80
+	rows2	max, max_rows, 90
+	rows2	maxu, maxu_rows, 100
+	rows2	rol, rol_rows, 110
+	rows2	ror, ror_rows, 120
+	rows2	bset, bset_rows, 130
+	rows2	bclr, bclr_rows, 140
+	rows2	binv, binv_rows, 150
+	rows2	bext, bext_rows, 160
+	rows1	clz, clz_rows, 170
+	rows1	ctz, ctz_rows, 180
+	rows1	cpop, cpop_rows, 190
+	rows1	rev8, rev8_rows, 200
+	rows1	orc.b, orc_b_rows, 210
+	rows1	sext.b, sext_b_rows, 220
+	rows1	sext.h, sext_h_rows, 230
+	rows1	zext.h, zext_h_rows, 240
+
+	# Immediate forms.
+	li	t0, 0x12345678
+	rori	a4, t0, 4
+	check	a4, 0x81234567, 1
+	rori	a4, t0, 0
+	check	a4, 0x12345678, 2
+	bseti	a4, zero, 31
+	check	a4, 0x80000000, 3
+	li	t0, -1
+	bclri	a4, t0, 0
+	check	a4, -2, 4
+	binvi	a4, t0, 16
+	check	a4, 0xfffeffff, 5
+	li	t0, 8
+	bexti	a4, t0, 3
+	check	a4, 1, 6
+	bexti	a4, t0, 2
+	check	a4, 0, 7
+
+	li	t5, 0
+fail:
+	mv	a0, t5
+	li	a7, 93
+	ecall
+
+	.data
+	.p2align	2
+sh1add_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000021
+	.word	0x80000001, 0x00000001, 0x00000003
+	.word	0x80000000, 0x00000021, 0x00000021
+	.word	0x12345678, 0x00000004, 0x2468acf4
+	.word	0xffffffff, 0x00000000, 0xfffffffe
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xcc6a8ced
+	.word	0x00000007, 0xfffffff9, 0x00000007
+	.word	0x00120300, 0x00000014, 0x00240614
+	.word	0x7fffffff, 0x80000000, 0x7ffffffe
+sh2add_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000023
+	.word	0x80000001, 0x00000001, 0x00000005
+	.word	0x80000000, 0x00000021, 0x00000021
+	.word	0x12345678, 0x00000004, 0x48d159e4
+	.word	0xffffffff, 0x00000000, 0xfffffffc
+	.word	0xdeadbeef, 0x0f0f0f0f, 0x89c60acb
+	.word	0x00000007, 0xfffffff9, 0x00000015
+	.word	0x00120300, 0x00000014, 0x00480c14
+	.word	0x7fffffff, 0x80000000, 0x7ffffffc
+sh3add_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000027
+	.word	0x80000001, 0x00000001, 0x00000009
+	.word	0x80000000, 0x00000021, 0x00000021
+	.word	0x12345678, 0x00000004, 0x91a2b3c4
+	.word	0xffffffff, 0x00000000, 0xfffffff8
+	.word	0xdeadbeef, 0x0f0f0f0f, 0x047d0687
+	.word	0x00000007, 0xfffffff9, 0x00000031
+	.word	0x00120300, 0x00000014, 0x00901814
+	.word	0x7fffffff, 0x80000000, 0x7ffffff8
+andn_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000000
+	.word	0x80000001, 0x00000001, 0x80000000
+	.word	0x80000000, 0x00000021, 0x80000000
+	.word	0x12345678, 0x00000004, 0x12345678
+	.word	0xffffffff, 0x00000000, 0xffffffff
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xd0a0b0e0
+	.word	0x00000007, 0xfffffff9, 0x00000006
+	.word	0x00120300, 0x00000014, 0x00120300
+	.word	0x7fffffff, 0x80000000, 0x7fffffff
+orn_rows:
+	.word	0x00000000, 0x00000000, 0xffffffff
+	.word	0x00000001, 0x0000001f, 0xffffffe1
+	.word	0x80000001, 0x00000001, 0xffffffff
+	.word	0x80000000, 0x00000021, 0xffffffde
+	.word	0x12345678, 0x00000004, 0xfffffffb
+	.word	0xffffffff, 0x00000000, 0xffffffff
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xfefdfeff
+	.word	0x00000007, 0xfffffff9, 0x00000007
+	.word	0x00120300, 0x00000014, 0xffffffeb
+	.word	0x7fffffff, 0x80000000, 0x7fffffff
+xnor_rows:
+	.word	0x00000000, 0x00000000, 0xffffffff
+	.word	0x00000001, 0x0000001f, 0xffffffe1
+	.word	0x80000001, 0x00000001, 0x7fffffff
+	.word	0x80000000, 0x00000021, 0x7fffffde
+	.word	0x12345678, 0x00000004, 0xedcba983
+	.word	0xffffffff, 0x00000000, 0x00000000
+	.word	0xdeadbeef, 0x0f0f0f0f, 0x2e5d4e1f
+	.word	0x00000007, 0xfffffff9, 0x00000001
+	.word	0x00120300, 0x00000014, 0xffedfceb
+	.word	0x7fffffff, 0x80000000, 0x00000000
+min_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000001
+	.word	0x80000001, 0x00000001, 0x80000001
+	.word	0x80000000, 0x00000021, 0x80000000
+	.word	0x12345678, 0x00000004, 0x00000004
+	.word	0xffffffff, 0x00000000, 0xffffffff
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xdeadbeef
+	.word	0x00000007, 0xfffffff9, 0xfffffff9
+	.word	0x00120300, 0x00000014, 0x00000014
+	.word	0x7fffffff, 0x80000000, 0x80000000
+minu_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000001
+	.word	0x80000001, 0x00000001, 0x00000001
+	.word	0x80000000, 0x00000021, 0x00000021
+	.word	0x12345678, 0x00000004, 0x00000004
+	.word	0xffffffff, 0x00000000, 0x00000000
+	.word	0xdeadbeef, 0x0f0f0f0f, 0x0f0f0f0f
+	.word	0x00000007, 0xfffffff9, 0x00000007
+	.word	0x00120300, 0x00000014, 0x00000014
+	.word	0x7fffffff, 0x80000000, 0x7fffffff
+max_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x0000001f
+	.word	0x80000001, 0x00000001, 0x00000001
+	.word	0x80000000, 0x00000021, 0x00000021
+	.word	0x12345678, 0x00000004, 0x12345678
+	.word	0xffffffff, 0x00000000, 0x00000000
+	.word	0xdeadbeef, 0x0f0f0f0f, 0x0f0f0f0f
+	.word	0x00000007, 0xfffffff9, 0x00000007
+	.word	0x00120300, 0x00000014, 0x00120300
+	.word	0x7fffffff, 0x80000000, 0x7fffffff
+maxu_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x0000001f
+	.word	0x80000001, 0x00000001, 0x80000001
+	.word	0x80000000, 0x00000021, 0x80000000
+	.word	0x12345678, 0x00000004, 0x12345678
+	.word	0xffffffff, 0x00000000, 0xffffffff
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xdeadbeef
+	.word	0x00000007, 0xfffffff9, 0xfffffff9
+	.word	0x00120300, 0x00000014, 0x00120300
+	.word	0x7fffffff, 0x80000000, 0x80000000
+rol_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x80000000
+	.word	0x80000001, 0x00000001, 0x00000003
+	.word	0x80000000, 0x00000021, 0x00000001
+	.word	0x12345678, 0x00000004, 0x23456781
+	.word	0xffffffff, 0x00000000, 0xffffffff
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xdf77ef56
+	.word	0x00000007, 0xfffffff9, 0x0e000000
+	.word	0x00120300, 0x00000014, 0x30000120
+	.word	0x7fffffff, 0x80000000, 0x7fffffff
+ror_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000002
+	.word	0x80000001, 0x00000001, 0xc0000000
+	.word	0x80000000, 0x00000021, 0x40000000
+	.word	0x12345678, 0x00000004, 0x81234567
+	.word	0xffffffff, 0x00000000, 0xffffffff
+	.word	0xdeadbeef, 0x0f0f0f0f, 0x7ddfbd5b
+	.word	0x00000007, 0xfffffff9, 0x00000380
+	.word	0x00120300, 0x00000014, 0x20300001
+	.word	0x7fffffff, 0x80000000, 0x7fffffff
+bset_rows:
+	.word	0x00000000, 0x00000000, 0x00000001
+	.word	0x00000001, 0x0000001f, 0x80000001
+	.word	0x80000001, 0x00000001, 0x80000003
+	.word	0x80000000, 0x00000021, 0x80000002
+	.word	0x12345678, 0x00000004, 0x12345678
+	.word	0xffffffff, 0x00000000, 0xffffffff
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xdeadbeef
+	.word	0x00000007, 0xfffffff9, 0x02000007
+	.word	0x00120300, 0x00000014, 0x00120300
+	.word	0x7fffffff, 0x80000000, 0x7fffffff
+bclr_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000001
+	.word	0x80000001, 0x00000001, 0x80000001
+	.word	0x80000000, 0x00000021, 0x80000000
+	.word	0x12345678, 0x00000004, 0x12345668
+	.word	0xffffffff, 0x00000000, 0xfffffffe
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xdead3eef
+	.word	0x00000007, 0xfffffff9, 0x00000007
+	.word	0x00120300, 0x00000014, 0x00020300
+	.word	0x7fffffff, 0x80000000, 0x7ffffffe
+binv_rows:
+	.word	0x00000000, 0x00000000, 0x00000001
+	.word	0x00000001, 0x0000001f, 0x80000001
+	.word	0x80000001, 0x00000001, 0x80000003
+	.word	0x80000000, 0x00000021, 0x80000002
+	.word	0x12345678, 0x00000004, 0x12345668
+	.word	0xffffffff, 0x00000000, 0xfffffffe
+	.word	0xdeadbeef, 0x0f0f0f0f, 0xdead3eef
+	.word	0x00000007, 0xfffffff9, 0x02000007
+	.word	0x00120300, 0x00000014, 0x00020300
+	.word	0x7fffffff, 0x80000000, 0x7ffffffe
+bext_rows:
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x00000001, 0x0000001f, 0x00000000
+	.word	0x80000001, 0x00000001, 0x00000000
+	.word	0x80000000, 0x00000021, 0x00000000
+	.word	0x12345678, 0x00000004, 0x00000001
+	.word	0xffffffff, 0x00000000, 0x00000001
+	.word	0xdeadbeef, 0x0f0f0f0f, 0x00000001
+	.word	0x00000007, 0xfffffff9, 0x00000000
+	.word	0x00120300, 0x00000014, 0x00000001
+	.word	0x7fffffff, 0x80000000, 0x00000001
+clz_rows:
+	.word	0x00000000, 0x00000020
+	.word	0x00000001, 0x0000001f
+	.word	0x80000000, 0x00000000
+	.word	0x00010000, 0x0000000f
+	.word	0xf0f0f0f1, 0x00000000
+	.word	0x11223344, 0x00000003
+	.word	0x00120300, 0x0000000b
+	.word	0xffffffff, 0x00000000
+	.word	0x00008000, 0x00000010
+	.word	0xfff12345, 0x00000000
+ctz_rows:
+	.word	0x00000000, 0x00000020
+	.word	0x00000001, 0x00000000
+	.word	0x80000000, 0x0000001f
+	.word	0x00010000, 0x00000010
+	.word	0xf0f0f0f1, 0x00000000
+	.word	0x11223344, 0x00000002
+	.word	0x00120300, 0x00000008
+	.word	0xffffffff, 0x00000000
+	.word	0x00008000, 0x0000000f
+	.word	0xfff12345, 0x00000000
+cpop_rows:
+	.word	0x00000000, 0x00000000
+	.word	0x00000001, 0x00000001
+	.word	0x80000000, 0x00000001
+	.word	0x00010000, 0x00000001
+	.word	0xf0f0f0f1, 0x00000011
+	.word	0x11223344, 0x0000000a
+	.word	0x00120300, 0x00000004
+	.word	0xffffffff, 0x00000020
+	.word	0x00008000, 0x00000001
+	.word	0xfff12345, 0x00000013
+rev8_rows:
+	.word	0x00000000, 0x00000000
+	.word	0x00000001, 0x01000000
+	.word	0x80000000, 0x00000080
+	.word	0x00010000, 0x00000100
+	.word	0xf0f0f0f1, 0xf1f0f0f0
+	.word	0x11223344, 0x44332211
+	.word	0x00120300, 0x00031200
+	.word	0xffffffff, 0xffffffff
+	.word	0x00008000, 0x00800000
+	.word	0xfff12345, 0x4523f1ff
+orc_b_rows:
+	.word	0x00000000, 0x00000000
+	.word	0x00000001, 0x000000ff
+	.word	0x80000000, 0xff000000
+	.word	0x00010000, 0x00ff0000
+	.word	0xf0f0f0f1, 0xffffffff
+	.word	0x11223344, 0xffffffff
+	.word	0x00120300, 0x00ffff00
+	.word	0xffffffff, 0xffffffff
+	.word	0x00008000, 0x0000ff00
+	.word	0xfff12345, 0xffffffff
+sext_b_rows:
+	.word	0x00000000, 0x00000000
+	.word	0x00000001, 0x00000001
+	.word	0x80000000, 0x00000000
+	.word	0x00010000, 0x00000000
+	.word	0xf0f0f0f1, 0xfffffff1
+	.word	0x11223344, 0x00000044
+	.word	0x00120300, 0x00000000
+	.word	0xffffffff, 0xffffffff
+	.word	0x00008000, 0x00000000
+	.word	0xfff12345, 0x00000045
+sext_h_rows:
+	.word	0x00000000, 0x00000000
+	.word	0x00000001, 0x00000001
+	.word	0x80000000, 0x00000000
+	.word	0x00010000, 0x00000000
+	.word	0xf0f0f0f1, 0xfffff0f1
+	.word	0x11223344, 0x00003344
+	.word	0x00120300, 0x00000300
+	.word	0xffffffff, 0xffffffff
+	.word	0x00008000, 0xffff8000
+	.word	0xfff12345, 0x00002345
+zext_h_rows:
+	.word	0x00000000, 0x00000000
+	.word	0x00000001, 0x00000001
+	.word	0x80000000, 0x00000000
+	.word	0x00010000, 0x00000000
+	.word	0xf0f0f0f1, 0x0000f0f1
+	.word	0x11223344, 0x00003344
+	.word	0x00120300, 0x00000300
+	.word	0xffffffff, 0x0000ffff
+	.word	0x00008000, 0x00008000
+	.word	0xfff12345, 0x00002345
+
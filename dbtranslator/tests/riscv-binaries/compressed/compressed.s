@@ -0,0 +1,94 @@
+# RV32IMC: the assembler compresses every instruction it can, and the
+# explicit c.* forms below cover the rest of the quadrants. Exits with 0
+# when every check passes, otherwise with the number of the failing one.
+	.option	norelax
+	.option	rvc
+
+	.macro	check reg, value, code
+	li	t6, \value
+	li	t5, \code
+	bne	\reg, t6, fail
+	.endm
+
+	.text
+	.globl	_start
+_start:
+	# Quadrant 1: c.li, c.lui, c.addi, c.srli, c.srai, c.andi and the
+	# register-register ALU forms.
+	c.li	s0, 21
+	c.lui	s1, 0x12
+	c.addi	s1, -1
+	check	s1, 0x11fff, 1
+	c.mv	a2, s1
+	c.srli	a2, 4
+	check	a2, 0x11ff, 2
+	c.li	a3, -32
+	c.srai	a3, 2
+	check	a3, -8, 3
+	c.andi	s1, 0x1f
+	check	s1, 0x1f, 4
+	c.sub	s1, s0
+	check	s1, 10, 5
+	c.xor	s1, s0
+	check	s1, 31, 6
+	c.or	s1, a3
+	check	s1, -1, 7
+	c.and	s1, s0
+	check	s1, 21, 8
+
+	# Quadrant 0 and 2: c.addi4spn, c.sw, c.lw, c.swsp, c.lwsp, c.slli,
+	# c.add.
+	c.addi16sp	sp, -32
+	c.addi4spn	a4, sp, 8
+	c.sw	s0, 0(a4)
+	c.swsp	a3, 4(sp)
+	c.lw	a5, 0(a4)
+	c.lwsp	a1, 4(sp)
+	c.add	a5, a1
+	check	a5, 13, 9
+	c.slli	a5, 3
+	check	a5, 104, 10
+	c.addi16sp	sp, 32
+
+	# Loops with c.beqz, c.bnez and c.j: sum of the table.
+	la	a1, table
+	c.li	a2, 6
+	c.li	a3, 0
+1:
+	c.lw	a4, 0(a1)
+	c.add	a3, a4
+	c.addi	a1, 4
+	c.addi	a2, -1
+	c.bnez	a2, 1b
+	check	a3, 1111, 11
+	c.li	a2, 0
+	c.beqz	a2, 2f
+	c.li	t5, 12
+	c.j	fail
+2:
+	# Calls with c.jal, c.jalr and c.jr, and a 4-byte instruction at a
+	# 2-byte aligned address.
+	c.li	a0, 5
+	c.jal	triple
+	check	a0, 15, 13
+	la	a5, triple
+	c.jalr	a5
+	check	a0, 45, 14
+	c.nop
+	addi	a0, a0, 1000
+	check	a0, 1045, 15
+	c.li	t5, 0
+fail:
+	mv	a0, t5
+	li	a7, 93
+	ecall
+
+triple:
+	c.mv	a1, a0
+	c.slli	a0, 1
+	c.add	a0, a1
+	c.jr	ra
+
+	.data
+table:
+	.word	1, 10, 100, 1000, -2, 2
@@ -0,0 +1,179 @@
+# RV32IMFD: results under every rounding mode, static and through frm, and
+# the fflags each operation raises. Exits with 0 when every check passes,
+# otherwise with the number of the failing one.
+	.option	norelax
+
+	.macro	check reg, value, code
+	li	t6, \value
+	li	t5, \code
+	bne	\reg, t6, fail
+	.endm
+
+	# Single from its bits.
+	.macro	fli reg, bits
+	li	t0, \bits
+	fmv.w.x	\reg, t0
+	.endm
+
+	.text
+	.globl	_start
+_start:
+	fli	f1, 0x3f800000		# 1.0
+	fli	f2, 0x40400000		# 3.0
+	fli	f3, 0xbf800000		# -1.0
+
+	# 1/3 with the static modes.
+	fsflags	zero
+	fdiv.s	f4, f1, f2, rne
+	fmv.x.w	a4, f4
+	check	a4, 0x3eaaaaab, 1
+	frflags	a4
+	check	a4, 1, 2
+	fdiv.s	f4, f1, f2, rtz
+	fmv.x.w	a4, f4
+	check	a4, 0x3eaaaaaa, 3
+	fdiv.s	f4, f3, f2, rup
+	fmv.x.w	a4, f4
+	check	a4, 0xbeaaaaaa, 4
+	fdiv.s	f4, f3, f2, rdn
+	fmv.x.w	a4, f4
+	check	a4, 0xbeaaaaab, 5
+
+	# The same through frm; fcsr holds frm above fflags.
+	li	t0, 3
+	fsrm	t0
+	fdiv.s	f4, f1, f2
+	fmv.x.w	a4, f4
+	check	a4, 0x3eaaaaab, 6
+	li	t0, 1
+	fsrm	t0
+	fdiv.s	f4, f1, f2
+	fmv.x.w	a4, f4
+	check	a4, 0x3eaaaaaa, 7
+	csrr	a4, fcsr
+	check	a4, 0x21, 8
+	fsrm	zero
+
+	# Division by zero raises DZ alone.
+	fsflags	zero
+	fmv.w.x	f5, zero
+	fdiv.s	f4, f1, f5
+	fmv.x.w	a4, f4
+	check	a4, 0x7f800000, 9
+	frflags	a4
+	check	a4, 8, 10
+
+	# Invalid operations give the canonical NaN and raise NV.
+	fsflags	zero
+	fsqrt.s	f4, f3
+	fmv.x.w	a4, f4
+	check	a4, 0x7fc00000, 11
+	frflags	a4
+	check	a4, 0x10, 12
+	fsflags	zero
+	fcvt.w.s	a4, f4
+	check	a4, 0x7fffffff, 13
+	fcvt.wu.s	a4, f3
+	check	a4, 0, 14
+	frflags	a4
+	check	a4, 0x10, 15
+
+	# Quiet comparisons of a NaN raise nothing, signaling ones raise NV.
+	fsflags	zero
+	feq.s	a4, f4, f4
+	check	a4, 0, 16
+	fmin.s	f6, f4, f1
+	fmv.x.w	a4, f6
+	check	a4, 0x3f800000, 17
+	frflags	a4
+	check	a4, 0, 18
+	flt.s	a4, f4, f1
+	frflags	a4
+	check	a4, 0x10, 19
+
+	# Conversion of 2.5 and -2.5 to integers.
+	fsflags	zero
+	fli	f7, 0x40200000
+	fcvt.w.s	a4, f7, rne
+	check	a4, 2, 20
+	fcvt.w.s	a4, f7, rmm
+	check	a4, 3, 21
+	fneg.s	f7, f7
+	fcvt.w.s	a4, f7, rdn
+	check	a4, -3, 22
+	fcvt.w.s	a4, f7, rtz
+	check	a4, -2, 23
+	frflags	a4
+	check	a4, 1, 24
+
+	# Overflow to infinity, or to the largest finite value toward zero.
+	fsflags	zero
+	fli	f8, 0x7f7fffff
+	fli	f9, 0x40000000
+	fmul.s	f4, f8, f9, rne
+	fmv.x.w	a4, f4
+	check	a4, 0x7f800000, 25
+	fmul.s	f4, f8, f9, rtz
+	fmv.x.w	a4, f4
+	check	a4, 0x7f7fffff, 26
+	frflags	a4
+	check	a4, 5, 27
+
+	# Underflow of 2^-100 squared.
+	fsflags	zero
+	fli	f8, 0x0d800000
+	fmul.s	f4, f8, f8
+	fmv.x.w	a4, f4
+	check	a4, 0, 28
+	frflags	a4
+	check	a4, 3, 29
+
+	# fmadd rounds once: (1 + 2^-12)^2 - 1 keeps the 2^-24 term that the
+	# separate multiply rounds away.
+	fli	f10, 0x3f800800
+	fmadd.s	f4, f10, f10, f3
+	fmv.x.w	a4, f4
+	check	a4, 0x3a000400, 30
+	fmul.s	f4, f10, f10
+	fadd.s	f4, f4, f3
+	fmv.x.w	a4, f4
+	check	a4, 0x3a000000, 31
+
+	# fclass of -0.0.
+	fneg.s	f4, f5
+	fclass.s	a4, f4
+	check	a4, 8, 32
+
+	# Doubles: 1/3 rounded down and up, and to single.
+	la	s0, doubles
+	fld	f11, 0(s0)
+	fld	f12, 8(s0)
+	fdiv.d	f13, f11, f12, rdn
+	fsd	f13, 16(s0)
+	lw	a4, 16(s0)
+	check	a4, 0x55555555, 33
+	lw	a4, 20(s0)
+	check	a4, 0x3fd55555, 34
+	fdiv.d	f13, f11, f12, rup
+	fsd	f13, 16(s0)
+	lw	a4, 16(s0)
+	check	a4, 0x55555556, 35
+	fcvt.s.d	f4, f13
+	fmv.x.w	a4, f4
+	check	a4, 0x3eaaaaab, 36
+	fcvt.d.s	f14, f4
+	feq.d	a4, f14, f13
+	check	a4, 0, 37
+
+	li	t5, 0
+fail:
+	mv	a0, t5
+	li	a7, 93
+	ecall
+
+	.data
+	.p2align	3
+doubles:
+	.word	0, 0x3ff00000		# 1.0
+	.word	0, 0x40080000		# 3.0
+	.space	8
@@ -0,0 +1,195 @@
+# RV32IM: every multiply and divide over a table of operand pairs loaded at
+# run time, including division by zero, INT_MIN / -1 and the signedness of
+# the high multiplies, then the same corner cases with constant operands.
+# Exits with 0 when every check passes, otherwise with the number of the
+# failing one: 10 * (instruction + 1) + row for the tables.
+	.option	norelax
+
+	.equ	ROWS, 14
+
+	.macro	check reg, value, code
+	li	t6, \value
+	li	t5, \code
+	bne	\reg, t6, fail
+	.endm
+
+	# Runs \insn on each row (a, b, expected) of \table.
+	.macro	rows insn, table, code
+	la	s0, \table
+	li	s1, 0
+1:
+	lw	t0, 0(s0)
+	lw	t1, 4(s0)
+	lw	t2, 8(s0)
+	\insn	a4, t0, t1
+	addi	t5, s1, \code
+	bne	a4, t2, fail
+	addi	s0, s0, 12
+	addi	s1, s1, 1
+	li	t3, ROWS
+	blt	s1, t3, 1b
+	.endm
+
+	.text
+	.globl	_start
+_start:
+	rows	mul, mul_rows, 10
+	rows	mulh, mulh_rows, 30
+	rows	mulhsu, mulhsu_rows, 50
+	rows	mulhu, mulhu_rows, 70
+	rows	div, div_rows, 90
+	rows	divu, divu_rows, 110
+	rows	rem, rem_rows, 130
+	rows	remu, remu_rows, 150
+
+	# Constant operands, which LLVM may fold.
+	li	t0, 7
+	div	a4, t0, zero
+	check	a4, -1, 1
+	divu	a4, t0, zero
+	check	a4, -1, 2
+	rem	a4, t0, zero
+	check	a4, 7, 3
+	remu	a4, t0, zero
+	check	a4, 7, 4
+	li	t0, 0x80000000
+	li	t1, -1
+	div	a4, t0, t1
+	check	a4, 0x80000000, 5
+	rem	a4, t0, t1
+	check	a4, 0, 6
+	mulh	a4, t0, t0
+	check	a4, 0x40000000, 7
+	mulhsu	a4, t1, t1
+	check	a4, -1, 8
+	mulhu	a4, t1, t1
+	check	a4, -2, 9
+
+	li	t5, 0
+fail:
+	mv	a0, t5
+	li	a7, 93
+	ecall
+
+	.data
+	.p2align	2
+mul_rows:
+	.word	0x00000007, 0xfffffffd, 0xffffffeb
+	.word	0xfffffff9, 0x00000002, 0xfffffff2
+	.word	0x80000000, 0xffffffff, 0x80000000
+	.word	0x80000000, 0x80000000, 0x00000000
+	.word	0xffffffff, 0xffffffff, 0x00000001
+	.word	0xffffffff, 0xffffffff, 0x00000001
+	.word	0x00000007, 0x00000000, 0x00000000
+	.word	0xfffffff9, 0x00000000, 0x00000000
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x7fffffff, 0x7fffffff, 0x00000001
+	.word	0x80000000, 0x80000000, 0x00000000
+	.word	0x12345678, 0xdeadbeef, 0x5621ca08
+	.word	0xdeadbeef, 0x00000003, 0x9c093ccd
+	.word	0x00000001, 0xffffffff, 0xffffffff
+mulh_rows:
+	.word	0x00000007, 0xfffffffd, 0xffffffff
+	.word	0xfffffff9, 0x00000002, 0xffffffff
+	.word	0x80000000, 0xffffffff, 0x00000000
+	.word	0x80000000, 0x80000000, 0x40000000
+	.word	0xffffffff, 0xffffffff, 0x00000000
+	.word	0xffffffff, 0xffffffff, 0x00000000
+	.word	0x00000007, 0x00000000, 0x00000000
+	.word	0xfffffff9, 0x00000000, 0x00000000
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x7fffffff, 0x7fffffff, 0x3fffffff
+	.word	0x80000000, 0x80000000, 0x40000000
+	.word	0x12345678, 0xdeadbeef, 0xfda16776
+	.word	0xdeadbeef, 0x00000003, 0xffffffff
+	.word	0x00000001, 0xffffffff, 0xffffffff
+mulhsu_rows:
+	.word	0x00000007, 0xfffffffd, 0x00000006
+	.word	0xfffffff9, 0x00000002, 0xffffffff
+	.word	0x80000000, 0xffffffff, 0x80000000
+	.word	0x80000000, 0x80000000, 0xc0000000
+	.word	0xffffffff, 0xffffffff, 0xffffffff
+	.word	0xffffffff, 0xffffffff, 0xffffffff
+	.word	0x00000007, 0x00000000, 0x00000000
+	.word	0xfffffff9, 0x00000000, 0x00000000
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x7fffffff, 0x7fffffff, 0x3fffffff
+	.word	0x80000000, 0x80000000, 0xc0000000
+	.word	0x12345678, 0xdeadbeef, 0x0fd5bdee
+	.word	0xdeadbeef, 0x00000003, 0xffffffff
+	.word	0x00000001, 0xffffffff, 0x00000000
+mulhu_rows:
+	.word	0x00000007, 0xfffffffd, 0x00000006
+	.word	0xfffffff9, 0x00000002, 0x00000001
+	.word	0x80000000, 0xffffffff, 0x7fffffff
+	.word	0x80000000, 0x80000000, 0x40000000
+	.word	0xffffffff, 0xffffffff, 0xfffffffe
+	.word	0xffffffff, 0xffffffff, 0xfffffffe
+	.word	0x00000007, 0x00000000, 0x00000000
+	.word	0xfffffff9, 0x00000000, 0x00000000
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x7fffffff, 0x7fffffff, 0x3fffffff
+	.word	0x80000000, 0x80000000, 0x40000000
+	.word	0x12345678, 0xdeadbeef, 0x0fd5bdee
+	.word	0xdeadbeef, 0x00000003, 0x00000002
+	.word	0x00000001, 0xffffffff, 0x00000000
+div_rows:
+	.word	0x00000007, 0xfffffffd, 0xfffffffe
+	.word	0xfffffff9, 0x00000002, 0xfffffffd
+	.word	0x80000000, 0xffffffff, 0x80000000
+	.word	0x80000000, 0x80000000, 0x00000001
+	.word	0xffffffff, 0xffffffff, 0x00000001
+	.word	0xffffffff, 0xffffffff, 0x00000001
+	.word	0x00000007, 0x00000000, 0xffffffff
+	.word	0xfffffff9, 0x00000000, 0xffffffff
+	.word	0x00000000, 0x00000000, 0xffffffff
+	.word	0x7fffffff, 0x7fffffff, 0x00000001
+	.word	0x80000000, 0x80000000, 0x00000001
+	.word	0x12345678, 0xdeadbeef, 0x00000000
+	.word	0xdeadbeef, 0x00000003, 0xf4e494fb
+	.word	0x00000001, 0xffffffff, 0xffffffff
+divu_rows:
+	.word	0x00000007, 0xfffffffd, 0x00000000
+	.word	0xfffffff9, 0x00000002, 0x7ffffffc
+	.word	0x80000000, 0xffffffff, 0x00000000
+	.word	0x80000000, 0x80000000, 0x00000001
+	.word	0xffffffff, 0xffffffff, 0x00000001
+	.word	0xffffffff, 0xffffffff, 0x00000001
+	.word	0x00000007, 0x00000000, 0xffffffff
+	.word	0xfffffff9, 0x00000000, 0xffffffff
+	.word	0x00000000, 0x00000000, 0xffffffff
+	.word	0x7fffffff, 0x7fffffff, 0x00000001
+	.word	0x80000000, 0x80000000, 0x00000001
+	.word	0x12345678, 0xdeadbeef, 0x00000000
+	.word	0xdeadbeef, 0x00000003, 0x4a39ea4f
+	.word	0x00000001, 0xffffffff, 0x00000000
+rem_rows:
+	.word	0x00000007, 0xfffffffd, 0x00000001
+	.word	0xfffffff9, 0x00000002, 0xffffffff
+	.word	0x80000000, 0xffffffff, 0x00000000
+	.word	0x80000000, 0x80000000, 0x00000000
+	.word	0xffffffff, 0xffffffff, 0x00000000
+	.word	0xffffffff, 0xffffffff, 0x00000000
+	.word	0x00000007, 0x00000000, 0x00000007
+	.word	0xfffffff9, 0x00000000, 0xfffffff9
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x7fffffff, 0x7fffffff, 0x00000000
+	.word	0x80000000, 0x80000000, 0x00000000
+	.word	0x12345678, 0xdeadbeef, 0x12345678
+	.word	0xdeadbeef, 0x00000003, 0xfffffffe
+	.word	0x00000001, 0xffffffff, 0x00000000
+remu_rows:
+	.word	0x00000007, 0xfffffffd, 0x00000007
+	.word	0xfffffff9, 0x00000002, 0x00000001
+	.word	0x80000000, 0xffffffff, 0x80000000
+	.word	0x80000000, 0x80000000, 0x00000000
+	.word	0xffffffff, 0xffffffff, 0x00000000
+	.word	0xffffffff, 0xffffffff, 0x00000000
+	.word	0x00000007, 0x00000000, 0x00000007
+	.word	0xfffffff9, 0x00000000, 0xfffffff9
+	.word	0x00000000, 0x00000000, 0x00000000
+	.word	0x7fffffff, 0x7fffffff, 0x00000000
+	.word	0x80000000, 0x80000000, 0x00000000
+	.word	0x12345678, 0xdeadbeef, 0x12345678
+	.word	0xdeadbeef, 0x00000003, 0x00000002
+	.word	0x00000001, 0xffffffff, 0x00000001
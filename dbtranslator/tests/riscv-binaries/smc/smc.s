@@ -0,0 +1,56 @@
+# Self-modifying code: a function runs until it is hot, its first
+# instruction is overwritten and the new code must run on the next call.
+# Then the original instruction is written back. Exits with 0 when every
+# check passes, otherwise with the number of the failing one.
+	.option	norelax
+
+	.equ	CALLS, 200
+
+	.macro	check reg, value, code
+	li	t6, \value
+	li	t5, \code
+	bne	\reg, t6, fail
+	.endm
+
+	# Calls patched CALLS times; every call must return \value.
+	.macro	calls value, code
+	li	s1, CALLS
+1:
+	call	patched
+	check	a0, \value, \code
+	addi	s1, s1, -1
+	bnez	s1, 1b
+	.endm
+
+	.text
+	.globl	_start
+_start:
+	la	s0, patched
+	calls	1, 1
+
+	lw	t0, li_a0_2
+	sw	t0, 0(s0)
+	fence.i
+	calls	2, 2
+
+	lw	t0, li_a0_1
+	sw	t0, 0(s0)
+	fence.i
+	calls	1, 3
+
+	li	t5, 0
+fail:
+	mv	a0, t5
+	li	a7, 93
+	ecall
+
+patched:
+	li	a0, 1
+	ret
+
+	.data
+	.p2align	2
+li_a0_1:
+	.word	0x00100513
+li_a0_2:
+	.word	0x00200513
@@ -0,0 +1,82 @@
+# Checkpoint and restore: the guest fills registers and memory, is
+# checkpointed at `checkpoint` and checks everything it wrote once it runs
+# on, whether straight through or restored from the snapshot. Exits with 0
+# when every check passes, otherwise with the number of the failing one:
+# 10 + i for word i of the buffer.
+	.option	norelax
+
+	.equ	WORDS, 64
+
+	.macro	check reg, value, code
+	li	t6, \value
+	li	t5, \code
+	bne	\reg, t6, fail
+	.endm
+
+	.text
+	.globl	_start
+_start:
+	# A restore that ran the guest from its entry again counts a second
+	# start here.
+	la	t0, starts
+	lw	t1, 0(t0)
+	addi	t1, t1, 1
+	sw	t1, 0(t0)
+
+	# buffer[i] = i * 0x01010101 and s2 = the sum of all of them.
+	la	s0, buffer
+	li	s1, 0
+	li	s2, 0
+	li	t2, 0x01010101
+1:
+	mul	t3, s1, t2
+	sw	t3, 0(s0)
+	add	s2, s2, t3
+	addi	s0, s0, 4
+	addi	s1, s1, 1
+	li	t4, WORDS
+	blt	s1, t4, 1b
+	li	s3, 0x12345678
+	li	sp, 0x7fff0
+	j	checkpoint
+
+	# Must stay at 0x10080, the address the tests pass as --checkpoint-pc.
+	.org	0x80
+checkpoint:
+	lw	t1, starts
+	check	t1, 1, 1
+	check	s1, WORDS, 2
+	check	s3, 0x12345678, 3
+	check	sp, 0x7fff0, 4
+
+	la	s0, buffer
+	li	s1, 0
+	li	s4, 0
+	li	t2, 0x01010101
+2:
+	lw	t3, 0(s0)
+	mul	t4, s1, t2
+	addi	t5, s1, 10
+	bne	t3, t4, fail
+	add	s4, s4, t3
+	addi	s0, s0, 4
+	addi	s1, s1, 1
+	li	t4, WORDS
+	blt	s1, t4, 2b
+	bne	s4, s2, sum_fail
+
+	li	t5, 0
+fail:
+	mv	a0, t5
+	li	a7, 93
+	ecall
+sum_fail:
+	li	t5, 5
+	j	fail
+
+	.data
+	.p2align	2
+starts:
+	.word	0
+buffer:
+	.zero	WORDS * 4
@@ -0,0 +1,163 @@
+# RV32IMV at LMUL 1: strip-mined loads and stores with vsetvli, reductions
+# at every supported element width, strided and masked accesses. Exits with
+# 0 when every check passes, otherwise with the number of the failing one.
+	.option	norelax
+
+	.macro	check reg, value, code
+	li	t6, \value
+	li	t5, \code
+	bne	\reg, t6, fail
+	.endm
+
+	.text
+	.globl	_start
+_start:
+	la	s0, words
+	la	s1, bytes
+	la	s2, out
+
+	# words[i] = 3i + 1 and bytes[i] = 7i for i < 37.
+	li	t0, 0
+	li	t1, 37
+1:
+	slli	t2, t0, 2
+	add	t3, s0, t2
+	li	t4, 3
+	mul	t4, t0, t4
+	addi	t4, t4, 1
+	sw	t4, 0(t3)
+	add	t3, s1, t0
+	li	t4, 7
+	mul	t4, t0, t4
+	sb	t4, 0(t3)
+	addi	t0, t0, 1
+	blt	t0, t1, 1b
+
+	# Sum of words[i] * 2 + 5 in chunks of vl, also stored to out.
+	vsetivli	zero, 1, e32, m1, ta, ma
+	vmv.s.x	v8, zero
+	li	a1, 37
+	mv	a2, s0
+	mv	a3, s2
+2:
+	vsetvli	t0, a1, e32, m1, tu, mu
+	vle32.v	v1, (a2)
+	vadd.vv	v2, v1, v1
+	vadd.vi	v2, v2, 5
+	vse32.v	v2, (a3)
+	vredsum.vs	v8, v2, v8
+	sub	a1, a1, t0
+	slli	t1, t0, 2
+	add	a2, a2, t1
+	add	a3, a3, t1
+	bnez	a1, 2b
+	vmv.x.s	a4, v8
+	check	a4, 4255, 1
+	lw	a4, 144(s2)
+	check	a4, 223, 2
+
+	# Byte maximum of bytes[i] ^ 0x5a, unsigned.
+	li	a1, 37
+	mv	a2, s1
+	vsetivli	zero, 1, e8, m1, ta, ma
+	vmv.v.i	v10, 0
+	li	t6, 0x5a
+3:
+	vsetvli	t0, a1, e8, m1, tu, mu
+	vle8.v	v1, (a2)
+	vxor.vx	v1, v1, t6
+	vredmaxu.vs	v10, v1, v10
+	sub	a1, a1, t0
+	add	a2, a2, t0
+	bnez	a1, 3b
+	vsetivli	zero, 1, e8, m1, ta, ma
+	vmv.x.s	a4, v10
+	andi	a4, a4, 0xff
+	check	a4, 251, 3
+
+	# Every other word, 5 - x: signed minimum and maximum.
+	vsetivli	zero, 8, e32, m1, tu, mu
+	li	t1, 8
+	vlse32.v	v4, (s0), t1
+	vrsub.vi	v4, v4, 5
+	vmv.v.i	v11, 0
+	vredmin.vs	v11, v4, v11
+	vmv.x.s	a4, v11
+	check	a4, -38, 4
+	vmv.v.i	v12, -7
+	vredmax.vs	v12, v4, v12
+	vmv.x.s	a4, v12
+	check	a4, 4, 5
+
+	# Masked add under v0 = 0b01010101: only even lanes are doubled.
+	li	t0, 0x55
+	vsetivli	zero, 8, e8, m1, tu, mu
+	vmv.v.x	v0, t0
+	vsetivli	zero, 8, e32, m1, tu, mu
+	vle32.v	v5, (s0)
+	vadd.vv	v5, v5, v5, v0.t
+	vmv.s.x	v13, zero
+	vredsum.vs	v13, v5, v13
+	vmv.x.s	a4, v13
+	check	a4, 132, 6
+
+	# 16-bit elements with vtype from a register: xor, and, or and unsigned
+	# minimum of the low halves of words[0..9] & 12.
+	li	t0, 0x08
+	li	t1, 10
+	vsetvl	t2, t1, t0
+	check	t2, 10, 7
+	li	t1, 4
+	vlse16.v	v6, (s0), t1
+	vand.vi	v6, v6, 12
+	vmv.v.i	v14, 0
+	vredxor.vs	v14, v6, v14
+	vmv.x.s	a4, v14
+	slli	a4, a4, 16
+	srli	a4, a4, 16
+	check	a4, 4, 8
+	vmv.v.i	v15, -1
+	vredand.vs	v15, v6, v15
+	vmv.x.s	a4, v15
+	slli	a4, a4, 16
+	srli	a4, a4, 16
+	check	a4, 0, 9
+	vmv.v.i	v15, 0
+	vredor.vs	v15, v6, v15
+	vmv.x.s	a4, v15
+	check	a4, 12, 10
+	vmv.v.i	v15, -1
+	vredminu.vs	v15, v6, v15
+	vmv.x.s	a4, v15
+	check	a4, 0, 11
+
+	# Tail undisturbed: lanes at and above vl keep their values.
+	vsetivli	zero, 8, e32, m1, tu, mu
+	vmv.v.i	v9, 1
+	vsetivli	zero, 3, e32, m1, tu, mu
+	vadd.vi	v9, v9, 9
+	vsetivli	zero, 8, e32, m1, tu, mu
+	vmv.s.x	v7, zero
+	vredsum.vs	v7, v9, v7
+	vmv.x.s	a4, v7
+	check	a4, 35, 12
+
+	# An unsupported vtype sets vill and vl to 0.
+	li	t1, 4
+	vsetvli	t2, t1, e64, m1, ta, ma
+	check	t2, 0, 13
+
+	li	t5, 0
+fail:
+	mv	a0, t5
+	li	a7, 93
+	ecall
+
+	.data
+	.p2align	2
+words:
+	.space	160
+bytes:
+	.space	40
+out:
+	.space	160
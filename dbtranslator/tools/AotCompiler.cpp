@@ -0,0 +1,195 @@
+// dbtranslator-aot: translates every statically discoverable block of a
+// guest ELF into a single host object. The memory runtime is linked into
+// the module and internalized, so the full optimization pipeline inlines it
+// into the blocks. The object is loaded by dbtranslator-tests --aot-object.
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/IRReader/IRReader.h"
+#include "llvm/Linker/Linker.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/IPO/Internalize.h"
+#include <argparse/argparse.hpp>
+
+#include "Aot.h"
+#include "Binary.h"
+#include "CPU.h"
+#include "Discovery.h"
+#include "Instruction.h"
+#include "Memory.h"
+#include "MemoryRuntime.h"
+#include "Translator.h"
+
+using namespace llvm;
+
+namespace {
+
+// One function per block plus the table the runtime reads.
+void buildBlocks(Module& M, riscv::MemoryManager* Manager, std::vector<riscv::DiscoveredBlock> const& Blocks, riscv::FileHash const& ElfHash,
+                 StringRef KindPrefix) {
+  LLVMContext& Ctx = M.getContext();
+  auto *FnTy = FunctionType::get(Type::getVoidTy(Ctx), {riscv::getCPUStatePointerType(Ctx)}, false);
+  auto *EntryTy = StructType::get(Type::getInt32Ty(Ctx), Type::getInt32Ty(Ctx), PointerType::getUnqual(Ctx));
+
+  std::vector<Constant*> Entries;
+  for (auto const& Block : Blocks) {
+    auto *F = Function::Create(FnTy, Function::InternalLinkage, "aot_" + utohexstr(Block.PC), &M);
+    IRBuilder<> B{Ctx};
+    B.SetInsertPoint(BasicBlock::Create(Ctx, "entry", F));
+    riscv::IRData IRData_{M, B, F};
+    riscv::addMemoryInterface(IRData_);
+    riscv::emitBlock(IRData_, Manager, Block.PC, Block.NumInstrs);
+    B.CreateRetVoid();
+    Entries.push_back(ConstantStruct::get(EntryTy, {B.getInt32(Block.PC), B.getInt32(Block.NumInstrs), F}));
+  }
+
+  auto *TableTy = ArrayType::get(EntryTy, Entries.size());
+  new GlobalVariable(M, TableTy, true, GlobalValue::ExternalLinkage, ConstantArray::get(TableTy, Entries), riscv::AotBlocksSymbol);
+  new GlobalVariable(M, Type::getInt32Ty(Ctx), true, GlobalValue::ExternalLinkage,
+                     ConstantInt::get(Type::getInt32Ty(Ctx), Entries.size()), riscv::AotNumBlocksSymbol);
+  new GlobalVariable(M, ArrayType::get(Type::getInt8Ty(Ctx), ElfHash.size()), true, GlobalValue::ExternalLinkage,
+                     ConstantDataArray::get(Ctx, ArrayRef<uint8_t>(ElfHash)), riscv::AotElfHashSymbol);
+  auto *Prefix = ConstantDataArray::getString(Ctx, KindPrefix);
+  new GlobalVariable(M, Prefix->getType(), true, GlobalValue::ExternalLinkage, Prefix, riscv::AotKindPrefixSymbol);
+}
+
+// The built-in runtime unless an alternative implementation is given.
+Expected<std::unique_ptr<Module>> loadRuntime(LLVMContext& Ctx, std::optional<std::string> const& Path) {
+  if (!Path)
+    return riscv::loadMemoryRuntime(Ctx);
+  SMDiagnostic Diag;
+  auto Runtime = parseIRFile(*Path, Diag, Ctx);
+  if (!Runtime)
+    return createStringError(inconvertibleErrorCode(), "%s: %s", Path->c_str(), Diag.getMessage().str().c_str());
+  return std::move(Runtime);
+}
+
+Error linkRuntime(Module& M, std::unique_ptr<Module> Runtime) {
+  Runtime->setDataLayout(M.getDataLayout());
+  Runtime->setTargetTriple(M.getTargetTriple());
+  if (Linker::linkModules(M, std::move(Runtime)))
+    return createStringError(inconvertibleErrorCode(), "cannot link the memory runtime");
+  // Only the table is visible outside the object; everything else, the
+  // memory helpers included, may be inlined and dropped.
+  internalizeModule(M, [](GlobalValue const& GV) { return GV.getName().starts_with("dbt_aot_"); });
+  return Error::success();
+}
+
+void optimize(Module& M, TargetMachine& TM) {
+  LoopAnalysisManager LAM;
+  FunctionAnalysisManager FAM;
+  CGSCCAnalysisManager CGAM;
+  ModuleAnalysisManager MAM;
+  PassBuilder PB(&TM);
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+  PB.buildPerModuleDefaultPipeline(OptimizationLevel::O2).run(M, MAM);
+}
+
+Error emitObject(Module& M, TargetMachine& TM, StringRef Path) {
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::OF_None);
+  if (EC)
+    return createFileError(Path, EC);
+  legacy::PassManager PM;
+  if (TM.addPassesToEmitFile(PM, OS, nullptr, CodeGenFileType::ObjectFile))
+    return createStringError(inconvertibleErrorCode(), "target cannot emit object files");
+  PM.run(M);
+  return Error::success();
+}
+
+Error run(std::string const& ElfFile, std::optional<std::string> const& MemoryImpl, std::string const& Output, size_t Threshold) {
+  auto ElfHash = riscv::hashFile(ElfFile);
+  if (!ElfHash)
+    return ElfHash.takeError();
+  // Blocks are built without coverage or host C library calls, with the
+  // memory runtime linked in.
+  auto KindPrefix = riscv::optionsPrefix(/*Coverage=*/false, /*InlineMemory=*/true, MemoryImpl);
+  if (!KindPrefix)
+    return KindPrefix.takeError();
+  auto [Manager, EntryPoint] = riscv::parseElf(ElfFile.c_str(), false);
+  riscv::ElfCodeInfo CodeInfo = riscv::parseElfCode(ElfFile.c_str());
+  std::vector<riscv::DiscoveredBlock> Blocks = riscv::discoverBlocks(Manager, CodeInfo, Threshold);
+
+  auto JTMB = orc::JITTargetMachineBuilder::detectHost();
+  if (!JTMB)
+    return JTMB.takeError();
+  JTMB->setRelocationModel(Reloc::PIC_);
+  JTMB->setCodeGenOptLevel(CodeGenOptLevel::Default);
+  auto TM = JTMB->createTargetMachine();
+  if (!TM)
+    return TM.takeError();
+
+  LLVMContext Ctx;
+  Module M("aot " + ElfFile, Ctx);
+  M.setDataLayout((*TM)->createDataLayout());
+  M.setTargetTriple((*TM)->getTargetTriple().str());
+  buildBlocks(M, Manager, Blocks, *ElfHash, *KindPrefix);
+  auto Runtime = loadRuntime(Ctx, MemoryImpl);
+  if (!Runtime)
+    return Runtime.takeError();
+  if (auto Err = linkRuntime(M, std::move(*Runtime)))
+    return Err;
+  if (verifyModule(M, &errs()))
+    return createStringError(inconvertibleErrorCode(), "generated module is invalid");
+  optimize(M, **TM);
+  if (auto Err = emitObject(M, **TM, Output))
+    return Err;
+
+  uint64_t NumInstrs = 0;
+  for (auto const& Block : Blocks)
+    NumInstrs += Block.NumInstrs;
+  errs() << "aot: " << Blocks.size() << " blocks (" << NumInstrs << " instructions) written to " << Output << "\n";
+  return Error::success();
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  argparse::ArgumentParser program("dbtranslator-aot");
+  program.add_argument("--input-elf").required().help("specify the input elf file").metavar("file_name");
+  program.add_argument("--memory-impl").help("alternative memory implementation (LLVM IR) to link into the object").metavar("file_name");
+  program.add_argument("--output").required().help("host object to write").metavar("file_name");
+  program.add_argument("--threshold").default_value(64).help("maximum instructions per block").metavar("value").scan<'i', int>();
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return EXIT_FAILURE;
+  }
+
+  InitLLVM X(argc, argv);
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+
+  if (auto Err = run(program.get<std::string>("--input-elf"), program.present("--memory-impl"),
+                     program.get<std::string>("--output"), program.get<int>("--threshold"))) {
+    logAllUnhandledErrors(std::move(Err), errs(), "dbtranslator-aot: ");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
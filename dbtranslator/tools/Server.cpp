@@ -0,0 +1,324 @@
+// Long-lived translator service: keeps warm JITs with their translations and
+// runs guest jobs sent over a Unix stream socket. Every line a client sends
+// is one job as a JSON object and is answered by one line of JSON:
+//
+//   {"elf": "/path/guest.out", "args": ["guest", "x"], "max_instructions": 100000000}
+//   {"exit_code": 0, "stop": "exited", "stdout": "...", "stderr": "...",
+//    "load_us": 180, "run_us": 920, "reused": true}
+//
+// A failed job gets {"error": "..."}. Connections are served concurrently
+// by --workers threads; jobs on one connection run in order. Engines are
+// pooled per ELF, so a job for an ELF that ran before starts with its JIT
+// and translations warm.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
+#include <argparse/argparse.hpp>
+
+#include "Engine.h"
+
+using namespace llvm;
+
+namespace {
+
+// Idle engines per ELF path. An engine is bound to its ELF by the code
+// cache key and by the translations it holds, so it is only reused for the
+// same path, and only while the file keeps the modification time and size
+// it had when the engine loaded it: a rebuilt ELF gets new engines.
+class EnginePool {
+public:
+  EnginePool(riscv::Engine::Options Opts, size_t MaxIdle) : Opts(std::move(Opts)), MaxIdle(MaxIdle) {}
+
+  // Stamp identifies the version of the ELF the engine was created for and
+  // must be passed back to release().
+  Expected<std::unique_ptr<riscv::Engine>> acquire(std::string const& ElfPath, std::string& Stamp, bool& Reused) {
+    sys::fs::file_status Status;
+    if (std::error_code EC = sys::fs::status(ElfPath, Status))
+      return createFileError(ElfPath, EC);
+    Stamp = std::to_string(Status.getLastModificationTime().time_since_epoch().count()) + ":" +
+            std::to_string(Status.getSize());
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      auto& Entry = Idle[ElfPath];
+      if (Entry.Stamp != Stamp) {
+        Entry.Stamp = Stamp;
+        Entry.Engines.clear();
+      }
+      if (!Entry.Engines.empty()) {
+        auto Result = std::move(Entry.Engines.back());
+        Entry.Engines.pop_back();
+        Reused = true;
+        return std::move(Result);
+      }
+    }
+    Reused = false;
+    return riscv::Engine::create(Opts, ElfPath);
+  }
+
+  void release(std::string const& ElfPath, std::string const& Stamp, std::unique_ptr<riscv::Engine> Engine) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto& Entry = Idle[ElfPath];
+    if (Entry.Stamp == Stamp && Entry.Engines.size() < MaxIdle)
+      Entry.Engines.push_back(std::move(Engine));
+  }
+
+private:
+  struct IdleEngines {
+    std::string Stamp;
+    std::vector<std::unique_ptr<riscv::Engine>> Engines;
+  };
+
+  riscv::Engine::Options Opts;
+  size_t MaxIdle;
+  std::mutex Mutex;
+  std::unordered_map<std::string, IdleEngines> Idle;
+};
+
+char const* stopName(riscv::Engine::StopReason Reason) {
+  switch (Reason) {
+  case riscv::Engine::StopReason::Exited: return "exited";
+  case riscv::Engine::StopReason::Halted: return "halted";
+  case riscv::Engine::StopReason::Breakpoint: return "breakpoint";
+  case riscv::Engine::StopReason::InstructionLimit: return "instruction-limit";
+  }
+  return "unknown";
+}
+
+int64_t microsecondsSince(std::chrono::steady_clock::time_point Start) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - Start).count();
+}
+
+Expected<json::Object> runJob(EnginePool& Pool, StringRef Request, size_t MaxOutput) {
+  auto Parsed = json::parse(Request);
+  if (!Parsed)
+    return Parsed.takeError();
+  json::Object const* Job = Parsed->getAsObject();
+  if (!Job)
+    return createStringError(inconvertibleErrorCode(), "a job must be a JSON object");
+  auto ElfPath = Job->getString("elf");
+  if (!ElfPath)
+    return createStringError(inconvertibleErrorCode(), "a job needs an \"elf\" path");
+  std::vector<std::string> Args;
+  if (json::Array const* ArgsArray = Job->getArray("args")) {
+    for (json::Value const& Arg : *ArgsArray) {
+      auto Text = Arg.getAsString();
+      if (!Text)
+        return createStringError(inconvertibleErrorCode(), "\"args\" must be strings");
+      Args.push_back(Text->str());
+    }
+  }
+  uint64_t MaxInstructions = std::numeric_limits<uint64_t>::max();
+  if (auto Limit = Job->getInteger("max_instructions"); Limit && *Limit > 0)
+    MaxInstructions = *Limit;
+
+  auto Start = std::chrono::steady_clock::now();
+  std::string Stamp;
+  bool Reused;
+  auto EngineOrErr = Pool.acquire(ElfPath->str(), Stamp, Reused);
+  if (!EngineOrErr)
+    return EngineOrErr.takeError();
+  std::unique_ptr<riscv::Engine> Engine = std::move(*EngineOrErr);
+  if (auto Err = Engine->load(Args))
+    return std::move(Err);
+  int64_t LoadTime = microsecondsSince(Start);
+
+  std::string Stdout, Stderr;
+  raw_string_ostream StdoutStream(Stdout), StderrStream(Stderr);
+  Engine->setOutput(&StdoutStream, &StderrStream);
+  Start = std::chrono::steady_clock::now();
+  auto Stop = Engine->run(MaxInstructions);
+  int64_t RunTime = microsecondsSince(Start);
+  Engine->setOutput(nullptr, nullptr);
+  if (!Stop)
+    return Stop.takeError();
+  StdoutStream.flush();
+  StderrStream.flush();
+
+  json::Object Reply;
+  Reply["exit_code"] = static_cast<int64_t>(static_cast<int32_t>(Engine->registers()[10]));
+  Reply["stop"] = stopName(*Stop);
+  Reply["stdout"] = json::fixUTF8(StringRef(Stdout).take_front(MaxOutput));
+  Reply["stderr"] = json::fixUTF8(StringRef(Stderr).take_front(MaxOutput));
+  Reply["load_us"] = LoadTime;
+  Reply["run_us"] = RunTime;
+  Reply["reused"] = Reused;
+  Pool.release(ElfPath->str(), Stamp, std::move(Engine));
+  return std::move(Reply);
+}
+
+bool sendAll(int Fd, StringRef Data) {
+  while (!Data.empty()) {
+    ssize_t Sent = ::send(Fd, Data.data(), Data.size(), MSG_NOSIGNAL);
+    if (Sent <= 0)
+      return false;
+    Data = Data.drop_front(Sent);
+  }
+  return true;
+}
+
+void serveConnection(int Fd, EnginePool& Pool, size_t MaxOutput) {
+  std::string Buffer;
+  char Chunk[4096];
+  for (;;) {
+    size_t NewLine;
+    while ((NewLine = Buffer.find('\n')) == std::string::npos) {
+      ssize_t Received = ::recv(Fd, Chunk, sizeof(Chunk), 0);
+      if (Received <= 0)
+        return;
+      Buffer.append(Chunk, Received);
+    }
+    std::string Request = Buffer.substr(0, NewLine);
+    Buffer.erase(0, NewLine + 1);
+    if (StringRef(Request).trim().empty())
+      continue;
+
+    json::Object Reply;
+    if (auto Result = runJob(Pool, Request, MaxOutput))
+      Reply = std::move(*Result);
+    else
+      Reply["error"] = toString(Result.takeError());
+    std::string Line;
+    raw_string_ostream(Line) << json::Value(std::move(Reply)) << '\n';
+    if (!sendAll(Fd, Line))
+      return;
+  }
+}
+
+// Accepted connections waiting for a worker.
+class ConnectionQueue {
+public:
+  void push(int Fd) {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      Pending.push_back(Fd);
+    }
+    Ready.notify_one();
+  }
+
+  int pop() {
+    std::unique_lock<std::mutex> Lock(Mutex);
+    Ready.wait(Lock, [this] { return !Pending.empty(); });
+    int Fd = Pending.front();
+    Pending.pop_front();
+    return Fd;
+  }
+
+private:
+  std::mutex Mutex;
+  std::condition_variable Ready;
+  std::deque<int> Pending;
+};
+
+Expected<int> listenOn(std::string const& Path) {
+  sockaddr_un Address = {};
+  Address.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Address.sun_path))
+    return createStringError(inconvertibleErrorCode(), "socket path too long: %s", Path.c_str());
+  std::copy(Path.begin(), Path.end(), Address.sun_path);
+
+  int Fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (Fd < 0)
+    return errorCodeToError(std::error_code(errno, std::generic_category()));
+  // A stale socket file from an earlier server would make bind fail.
+  ::unlink(Path.c_str());
+  if (::bind(Fd, reinterpret_cast<sockaddr*>(&Address), sizeof(Address)) < 0 || ::listen(Fd, SOMAXCONN) < 0) {
+    std::error_code EC(errno, std::generic_category());
+    ::close(Fd);
+    return createFileError(Path, EC);
+  }
+  return Fd;
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  argparse::ArgumentParser program("dbtranslator-server");
+  program.add_argument("--socket").required().help("path of the Unix socket to listen on").metavar("path");
+  program.add_argument("--workers").default_value(static_cast<int>(std::max(1U, std::thread::hardware_concurrency()))).help("number of jobs run concurrently").metavar("value").scan<'i', int>();
+  program.add_argument("--max-idle-engines").default_value(4).help("warm engines kept per ELF between jobs").metavar("value").scan<'i', int>();
+  program.add_argument("--max-output").default_value(1 << 20).help("bytes of guest stdout and stderr returned per job").metavar("bytes").scan<'i', int>();
+  program.add_argument("--threshold").default_value(64).help("specify threshold value").metavar("value").scan<'i', int>();
+  program.add_argument("--inline-memory").help("inline the built-in memory runtime into translated code").flag();
+  program.add_argument("--baseline").help("translate blocks with the copy-and-patch baseline tier first").flag();
+  program.add_argument("--tier-up-threshold").default_value(1000).help("executions of a baseline block before it is recompiled with LLVM").metavar("value").scan<'i', int>();
+  program.add_argument("--region-threshold").default_value(10000).help("executions of a block before its hot region is recompiled with profile data (0 disables)").metavar("value").scan<'i', int>();
+  program.add_argument("--code-cache").help("directory of the persistent code cache shared between runs").metavar("dir");
+  program.add_argument("--code-budget").default_value(0).help("KiB of JIT code and data kept resident per engine (0 is unlimited)").metavar("kib").scan<'i', int>();
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return EXIT_FAILURE;
+  }
+
+  InitLLVM X(argc, argv);
+  // Engines are created on the worker threads; target registration is not
+  // safe to race, so it happens once up front.
+  InitializeNativeTarget();
+  InitializeNativeTargetAsmPrinter();
+  InitializeNativeTargetAsmParser();
+
+  riscv::Engine::Options Opts;
+  Opts.Threshold = program.get<int>("--threshold");
+  Opts.InlineMemory = program["--inline-memory"] == true;
+  Opts.Baseline = program["--baseline"] == true;
+  Opts.TierUpThreshold = program.get<int>("--tier-up-threshold");
+  Opts.RegionThreshold = program.get<int>("--region-threshold");
+  if (auto CacheDir = program.present("--code-cache"))
+    Opts.CodeCacheDir = *CacheDir;
+  Opts.CodeBudget = static_cast<size_t>(std::max(0, program.get<int>("--code-budget"))) * 1024;
+
+  auto Listener = listenOn(program.get<std::string>("--socket"));
+  if (!Listener) {
+    logAllUnhandledErrors(Listener.takeError(), errs(), "dbtranslator-server: ");
+    return EXIT_FAILURE;
+  }
+
+  EnginePool Pool(Opts, program.get<int>("--max-idle-engines"));
+  size_t MaxOutput = program.get<int>("--max-output");
+  ConnectionQueue Connections;
+  std::vector<std::thread> Workers;
+  for (int I = 0, E = std::max(1, program.get<int>("--workers")); I < E; ++I) {
+    Workers.emplace_back([&] {
+      for (;;) {
+        int Fd = Connections.pop();
+        serveConnection(Fd, Pool, MaxOutput);
+        ::close(Fd);
+      }
+    });
+  }
+
+  errs() << "dbtranslator-server: listening on " << program.get<std::string>("--socket") << " with "
+         << Workers.size() << " workers\n";
+  for (;;) {
+    int Fd = ::accept(*Listener, nullptr, nullptr);
+    if (Fd < 0) {
+      if (errno == EINTR)
+        continue;
+      errs() << "dbtranslator-server: accept: " << std::error_code(errno, std::generic_category()).message() << "\n";
+      return EXIT_FAILURE;
+    }
+    Connections.push(Fd);
+  }
+}
@@ -0,0 +1,161 @@
+// Build-time tool: reads the object file produced from stencils/Stencils.cpp
+// and writes a C++ include with the machine code and hole list of every
+// stencil_* (one per riscv::Instr) and glue_* function.
+
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringRef.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+struct Hole {
+  uint64_t Offset;
+  std::string Kind;
+  int64_t Addend;
+};
+
+struct StencilCode {
+  std::vector<uint8_t> Code;
+  std::vector<Hole> Holes;
+  uint64_t FallThroughSize;
+};
+
+// If the stencil ends with its single indirect tail jump (jmp *%reg, loaded
+// from _JIT_CONTINUE), the jump can be dropped when the next stencil is
+// placed right after it.
+uint64_t fallThroughSize(StencilCode const& Stencil) {
+  auto const& Code = Stencil.Code;
+  bool HasContinue = false;
+  for (auto const& H : Stencil.Holes)
+    HasContinue |= H.Kind == "CONTINUE";
+  if (!HasContinue || Code.size() < 2)
+    return Code.size();
+  size_t Size = Code.size();
+  if (Code[Size - 2] != 0xFF || (Code[Size - 1] & 0xF8) != 0xE0)
+    return Size;
+  size_t JumpSize = Size >= 3 && Code[Size - 3] == 0x41 ? 3 : 2;
+  for (auto const& H : Stencil.Holes) {
+    if (H.Offset + 8 > Size - JumpSize)
+      return Size;
+  }
+  return Size - JumpSize;
+}
+
+Error run(StringRef InputPath, StringRef OutputPath) {
+  auto BinaryOrErr = ObjectFile::createObjectFile(InputPath);
+  if (!BinaryOrErr)
+    return BinaryOrErr.takeError();
+  ObjectFile& Obj = *BinaryOrErr->getBinary();
+
+  struct Range {
+    SectionRef Section;
+    uint64_t Begin;
+    uint64_t Size;
+  };
+  std::map<std::string, Range> Functions;
+  for (ELFSymbolRef Sym : cast<ELFObjectFileBase>(&Obj)->symbols()) {
+    auto Name = Sym.getName();
+    if (!Name)
+      return Name.takeError();
+    if (!Name->starts_with("stencil_") && !Name->starts_with("glue_"))
+      continue;
+    auto Section = Sym.getSection();
+    if (!Section)
+      return Section.takeError();
+    auto Address = Sym.getValue();
+    if (!Address)
+      return Address.takeError();
+    Functions[Name->str()] = {**Section, *Address, Sym.getSize()};
+  }
+
+  std::map<std::string, StencilCode> Stencils;
+  for (auto const& [Name, R] : Functions) {
+    auto Contents = R.Section.getContents();
+    if (!Contents)
+      return Contents.takeError();
+    StencilCode& Stencil = Stencils[Name];
+    Stencil.Code.assign(Contents->bytes_begin() + R.Begin, Contents->bytes_begin() + R.Begin + R.Size);
+  }
+
+  for (SectionRef RelocSection : Obj.sections()) {
+    auto Target = RelocSection.getRelocatedSection();
+    if (!Target)
+      return Target.takeError();
+    if (*Target == Obj.section_end())
+      continue;
+    for (ELFRelocationRef Reloc : RelocSection.relocations()) {
+      for (auto const& [Name, R] : Functions) {
+        if (R.Section != **Target || Reloc.getOffset() < R.Begin || Reloc.getOffset() >= R.Begin + R.Size)
+          continue;
+        auto SymName = Reloc.getSymbol()->getName();
+        if (!SymName)
+          return SymName.takeError();
+        if (!SymName->starts_with("_JIT_") || Reloc.getType() != ELF::R_X86_64_64)
+          return createStringError(inconvertibleErrorCode(), "%s: unsupported relocation against %s",
+                                   Name.c_str(), SymName->str().c_str());
+        auto Addend = Reloc.getAddend();
+        if (!Addend)
+          return Addend.takeError();
+        Stencils[Name].Holes.push_back({Reloc.getOffset() - R.Begin, SymName->drop_front(5).str(), *Addend});
+      }
+    }
+  }
+
+  std::error_code EC;
+  raw_fd_ostream OS(OutputPath, EC, sys::fs::OF_Text);
+  if (EC)
+    return errorCodeToError(EC);
+
+  OS << "// Generated by stencil-gen from " << InputPath << ". Do not edit.\n\n";
+  for (auto& [Name, Stencil] : Stencils) {
+    Stencil.FallThroughSize = fallThroughSize(Stencil);
+    OS << "static constexpr uint8_t Code_" << Name << "[] = {";
+    for (size_t I = 0; I < Stencil.Code.size(); ++I)
+      OS << (I % 16 ? " " : "\n  ") << format("0x%02x,", Stencil.Code[I]);
+    OS << "\n};\n";
+    std::string HolesName = "nullptr";
+    if (!Stencil.Holes.empty()) {
+      HolesName = "Holes_" + Name;
+      OS << "static constexpr StencilHole " << HolesName << "[] = {\n";
+      for (auto const& H : Stencil.Holes)
+        OS << "  {" << H.Offset << ", HoleKind::" << H.Kind << ", " << H.Addend << "},\n";
+      OS << "};\n";
+    }
+    OS << "static constexpr Stencil " << Name << " = {Code_" << Name << ", " << Stencil.Code.size() << ", "
+       << Stencil.FallThroughSize << ", " << HolesName << ", " << Stencil.Holes.size() << "};\n\n";
+  }
+
+  OS << "static Stencil const* getStencil(Instr I) {\n  switch (I) {\n";
+  for (auto const& [Name, Stencil] : Stencils) {
+    if (StringRef(Name).starts_with("stencil_"))
+      OS << "    case Instr::" << StringRef(Name).drop_front(8) << ": return &" << Name << ";\n";
+  }
+  OS << "    default: return nullptr;\n  }\n}\n";
+  return Error::success();
+}
+
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    errs() << "usage: " << argv[0] << " <stencils.o> <output.inc>\n";
+    return EXIT_FAILURE;
+  }
+  if (auto Err = run(argv[1], argv[2])) {
+    logAllUnhandledErrors(std::move(Err), errs(), "stencil-gen: ");
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}